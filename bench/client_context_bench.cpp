@@ -0,0 +1,106 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include "libuv_net/client_context.hpp"
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace libuv_net;
+
+namespace
+{
+    constexpr int PORT = 19095;
+    constexpr int CLIENTS = 200;
+
+    struct Result
+    {
+        double setup_ms;   // 创建客户端并全部完成一次往返的耗时
+        long threads;      // 此时进程的线程数
+        long rss_kb;       // 此时进程的常驻内存
+        int replies;       // 收到回送的客户端数
+    };
+
+    // 读取 /proc/self/status 中的一项
+    long read_status(const std::string &key)
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, key.size(), key) == 0)
+            {
+                return std::stol(line.substr(key.size()));
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * 创建 CLIENTS 个客户端连接到同一服务器，每个客户端发出一个消息并等待回送；
+     * 独立模式下每个客户端各有一个事件循环线程和线程池，共享模式下全部附加到一个运行时。
+     */
+    Result run(bool shared)
+    {
+        Server server;
+        server.set_packet_handler(PacketType::BINARY, [](std::shared_ptr<Session> session, std::shared_ptr<Packet> packet)
+                                  { session->send(packet); });
+        server.listen("127.0.0.1", PORT);
+        server.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        auto context = std::make_shared<ClientContext>();
+        if (shared)
+        {
+            context->start();
+        }
+
+        std::atomic<int> replies{0};
+        auto packet = std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(32));
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<std::unique_ptr<Client>> clients;
+        for (int i = 0; i < CLIENTS; ++i)
+        {
+            auto client = shared ? std::make_unique<Client>(context) : std::make_unique<Client>();
+            Client *raw = client.get();
+            client->set_connect_handler([raw, packet]()
+                                        { raw->send(packet); });
+            client->set_packet_handler(PacketType::BINARY, [&replies](std::shared_ptr<Packet>)
+                                       { ++replies; });
+            client->start();
+            client->connect("127.0.0.1", PORT);
+            clients.push_back(std::move(client));
+        }
+
+        auto deadline = begin + std::chrono::seconds(30);
+        while (replies < CLIENTS && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        Result result{std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count(),
+                      read_status("Threads:"), read_status("VmRSS:"), replies};
+
+        clients.clear();
+        context->stop();
+        server.stop();
+        return result;
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    for (bool shared : {false, true})
+    {
+        auto result = run(shared);
+        spdlog::set_level(spdlog::level::info);
+        spdlog::info("{:<6} {} 个客户端  耗时 {:>7.1f} ms  线程 {:>5}  RSS {:>7} KB  回送 {}",
+                     shared ? "共享" : "独立", CLIENTS, result.setup_ms, result.threads, result.rss_kb, result.replies);
+        spdlog::set_level(spdlog::level::warn);
+    }
+    return 0;
+}
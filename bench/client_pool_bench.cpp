@@ -0,0 +1,172 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include "libuv_net/client_pool.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace libuv_net;
+
+namespace
+{
+    constexpr int PORTS[] = {19096, 19097};
+    constexpr int REQUESTS = 20000;
+    constexpr int CONCURRENCY = 32;                          // 同时未答复的请求数
+    constexpr std::chrono::microseconds SERVICE_TIME{50};    // 服务器处理一个请求的耗时
+
+    struct Result
+    {
+        double throughput; // 每秒完成的请求数
+        double p50_us;
+        double p99_us;
+    };
+
+    int64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * 两个相同的服务器，每个请求阻塞事件循环 SERVICE_TIME 模拟后端处理后原样回送；
+     * 客户端保持 CONCURRENCY 个未答复的请求，收到答复后立即发出下一个。
+     * 请求的消息体是发送时间，延迟从回送的消息体计算。
+     */
+    Result run(const char *mode, BalancePolicy policy)
+    {
+        std::vector<std::unique_ptr<Server>> servers;
+        for (int port : PORTS)
+        {
+            auto server = std::make_unique<Server>();
+            server->set_packet_handler(PacketType::BINARY, [](std::shared_ptr<Session> session, std::shared_ptr<Packet> packet)
+                                       {
+                                           std::this_thread::sleep_for(SERVICE_TIME);
+                                           session->send(packet); });
+            server->listen("127.0.0.1", port);
+            server->start();
+            servers.push_back(std::move(server));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        bool single = std::strcmp(mode, "single") == 0;
+        std::vector<double> latencies;
+        latencies.reserve(REQUESTS);
+        std::atomic<int> issued{0};
+        std::atomic<bool> done{false};
+        std::mutex mutex;
+
+        Client client;
+        ClientPoolOptions options;
+        options.policy = policy;
+        ClientPool pool(options);
+
+        auto send = [&]()
+        {
+            int64_t sent_at = now_ns();
+            std::vector<uint8_t> body(sizeof(sent_at));
+            std::memcpy(body.data(), &sent_at, sizeof(sent_at));
+            auto packet = std::make_shared<Packet>(PacketType::BINARY, std::move(body));
+            if (single)
+            {
+                client.send(packet);
+            }
+            else
+            {
+                pool.send(packet);
+            }
+        };
+        auto on_reply = [&](std::shared_ptr<Packet> packet)
+        {
+            int64_t sent_at;
+            std::memcpy(&sent_at, packet->data().data(), sizeof(sent_at));
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                latencies.push_back(static_cast<double>(now_ns() - sent_at) / 1000.0);
+                if (latencies.size() == REQUESTS)
+                {
+                    done = true;
+                }
+            }
+            if (++issued <= REQUESTS)
+            {
+                send();
+            }
+        };
+
+        if (single)
+        {
+            client.set_packet_handler(PacketType::BINARY, on_reply);
+            client.start();
+            client.connect("127.0.0.1", PORTS[0]);
+            for (int i = 0; i < 200 && !client.is_connected(); ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+        else
+        {
+            pool.set_packet_handler(PacketType::BINARY, on_reply);
+            pool.start({{"127.0.0.1", static_cast<uint16_t>(PORTS[0])}, {"127.0.0.1", static_cast<uint16_t>(PORTS[1])}});
+            for (int i = 0; i < 200 && pool.active_count() < 2 * options.connections_per_endpoint; ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        issued = CONCURRENCY;
+        for (int i = 0; i < CONCURRENCY; ++i)
+        {
+            send();
+        }
+        auto deadline = begin + std::chrono::seconds(60);
+        while (!done && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        pool.stop();
+        client.stop();
+        for (auto &server : servers)
+        {
+            server->stop();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (latencies.size() < REQUESTS)
+        {
+            spdlog::error("超时，只完成了 {} 个请求", latencies.size());
+            return {0, 0, 0};
+        }
+        std::sort(latencies.begin(), latencies.end());
+        return {REQUESTS / seconds, latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100]};
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    struct Case
+    {
+        const char *name;
+        const char *mode;
+        BalancePolicy policy;
+    };
+    for (const Case &c : {Case{"单连接", "single", BalancePolicy::LEAST_OUTSTANDING},
+                          Case{"最少未答复", "pool", BalancePolicy::LEAST_OUTSTANDING},
+                          Case{"两选一", "pool", BalancePolicy::POWER_OF_TWO_CHOICES}})
+    {
+        auto result = run(c.mode, c.policy);
+        spdlog::set_level(spdlog::level::info);
+        spdlog::info("{:<8} 吞吐 {:>8.0f} req/s  p50 {:>8.1f} us  p99 {:>8.1f} us",
+                     c.name, result.throughput, result.p50_us, result.p99_us);
+        spdlog::set_level(spdlog::level::warn);
+    }
+    return 0;
+}
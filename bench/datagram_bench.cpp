@@ -0,0 +1,138 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace libuv_net;
+
+namespace
+{
+    constexpr int PORT = 19094;
+    constexpr int REQUESTS = 20000;
+    constexpr int BURST = 50000;
+    constexpr size_t PAYLOAD_SIZE = 32;
+
+    struct Result
+    {
+        double p50_us;
+        double p99_us;
+        double burst_delivered; // 突发发送中送达的比例
+        uint32_t burst_last;    // 突发发送中收到的最后一个序列号
+    };
+
+    /**
+     * 先测往返延迟：客户端发出一个更新后等待服务器原样回送，再发下一个；
+     * 再测突发：客户端在一次回调中连续发出 BURST 个更新，统计服务器收到的数量。
+     * 两部分都在客户端事件循环中发送。
+     */
+    Result run(bool unreliable)
+    {
+        Server server;
+        std::atomic<int> burst_received{0};
+        std::atomic<uint32_t> burst_last{0};
+        server.set_packet_handler(PacketType::BINARY, [&](std::shared_ptr<Session> session, std::shared_ptr<Packet> packet)
+                                  {
+                                      if (unreliable)
+                                      {
+                                          session->send_unreliable(packet);
+                                      }
+                                      else
+                                      {
+                                          session->send(packet);
+                                      } });
+        server.set_packet_handler(PacketType::TEXT, [&](std::shared_ptr<Session>, std::shared_ptr<Packet> packet)
+                                  {
+                                      ++burst_received;
+                                      burst_last = packet->sequence(); });
+        server.listen("127.0.0.1", PORT);
+        server.listen_udp("127.0.0.1", PORT);
+        server.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        Client client;
+        client.enable_datagrams(unreliable);
+        std::vector<double> latencies;
+        latencies.reserve(REQUESTS);
+        std::atomic<bool> done{false};
+        auto update = std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(PAYLOAD_SIZE));
+        auto burst = std::make_shared<Packet>(PacketType::TEXT, std::vector<uint8_t>(PAYLOAD_SIZE));
+        std::chrono::steady_clock::time_point sent_at;
+
+        auto send = [&](const std::shared_ptr<Packet> &packet)
+        {
+            if (unreliable)
+            {
+                client.send_unreliable(packet);
+            }
+            else
+            {
+                client.send(packet);
+            }
+        };
+        client.set_packet_handler(PacketType::BINARY, [&](std::shared_ptr<Packet>)
+                                  {
+                                      latencies.push_back(std::chrono::duration<double, std::micro>(
+                                                              std::chrono::steady_clock::now() - sent_at)
+                                                              .count());
+                                      if (latencies.size() == REQUESTS)
+                                      {
+                                          for (int i = 0; i < BURST; ++i)
+                                          {
+                                              send(burst);
+                                          }
+                                          done = true;
+                                          return;
+                                      }
+                                      sent_at = std::chrono::steady_clock::now();
+                                      send(update); });
+        client.start();
+        client.connect("127.0.0.1", PORT);
+
+        // 等待数据报通道建立后开始
+        for (int i = 0; i < 200 && unreliable && !client.has_datagram(); ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        sent_at = std::chrono::steady_clock::now();
+        send(update);
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        while (!done && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        client.stop();
+        server.stop();
+
+        if (latencies.size() < REQUESTS)
+        {
+            spdlog::error("超时，只完成了 {} 次往返", latencies.size());
+            return {0, 0, 0, 0};
+        }
+        std::sort(latencies.begin(), latencies.end());
+        return {latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100],
+                static_cast<double>(burst_received) / BURST, burst_last};
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    for (bool unreliable : {false, true})
+    {
+        auto result = run(unreliable);
+        spdlog::set_level(spdlog::level::info);
+        spdlog::info("{:<8} 往返延迟 p50 {:>6.1f} us  p99 {:>6.1f} us  突发送达 {:>5.1f}%  最后序列号 {}",
+                     unreliable ? "UDP" : "TCP", result.p50_us, result.p99_us,
+                     result.burst_delivered * 100, result.burst_last);
+        spdlog::set_level(spdlog::level::warn);
+    }
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "libuv_net/message.hpp"
+#include "libuv_net/dispatch_table.hpp"
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <map>
+#include <random>
+
+using namespace libuv_net;
+
+namespace
+{
+    // 仅用于测量查找开销的空拦截器
+    class NullInterceptor : public Interceptor
+    {
+    public:
+        explicit NullInterceptor(PacketType type) : type_(type) {}
+        std::vector<uint8_t> serialize(const std::any &) override { return {}; }
+        std::any deserialize(const std::vector<uint8_t> &) override { return {}; }
+        PacketType get_type() const override { return type_; }
+
+    private:
+        PacketType type_;
+    };
+
+    constexpr size_t PACKET_COUNT = 20000000;
+
+    template <typename F>
+    double measure_ns_per_packet(F &&f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / PACKET_COUNT;
+    }
+}
+
+int main()
+{
+    // 模拟收到的消息类型序列，包含少量未注册的类型
+    std::vector<PacketType> types(4096);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, 8);
+    for (auto &type : types)
+    {
+        type = static_cast<PacketType>(dist(rng));
+    }
+
+    uint64_t counter = 0;
+    PacketHandler handler = [&counter](std::shared_ptr<Packet>)
+    { ++counter; };
+    auto packet = std::make_shared<Packet>();
+
+    // 旧实现：std::map 查找处理器和拦截器，拦截器按 shared_ptr 拷贝返回
+    std::map<PacketType, PacketHandler> handler_map;
+    std::map<PacketType, std::shared_ptr<Interceptor>> interceptor_map;
+    // 新实现：稠密分发表
+    DispatchTable<PacketHandler> handler_table;
+    InterceptorManager interceptor_manager;
+
+    for (int i = 0; i <= 6; ++i)
+    {
+        auto type = static_cast<PacketType>(i);
+        handler_map[type] = handler;
+        handler_table.set(type, handler);
+    }
+    for (auto type : {PacketType::JSON, PacketType::PROTOBUF})
+    {
+        auto interceptor = std::make_shared<NullInterceptor>(type);
+        interceptor_map[type] = interceptor;
+        interceptor_manager.add_interceptor(interceptor);
+    }
+
+    double map_ns = measure_ns_per_packet([&]()
+                                          {
+        for (size_t i = 0; i < PACKET_COUNT; ++i)
+        {
+            auto type = types[i & (types.size() - 1)];
+            std::shared_ptr<Interceptor> interceptor;
+            auto interceptor_it = interceptor_map.find(type);
+            if (interceptor_it != interceptor_map.end())
+            {
+                interceptor = interceptor_it->second;
+            }
+            auto it = handler_map.find(type);
+            if (it != handler_map.end())
+            {
+                it->second(packet);
+            }
+        } });
+
+    double table_ns = measure_ns_per_packet([&]()
+                                            {
+        for (size_t i = 0; i < PACKET_COUNT; ++i)
+        {
+            auto type = types[i & (types.size() - 1)];
+            auto interceptor = interceptor_manager.get_interceptor(type);
+            (void)interceptor;
+            if (auto table_handler = handler_table.find(type))
+            {
+                (*table_handler)(packet);
+            }
+        } });
+
+    spdlog::info("分发 {} 个消息（计数 {}）", PACKET_COUNT, counter);
+    spdlog::info("std::map + shared_ptr 拷贝: {:.2f} ns/消息", map_ns);
+    spdlog::info("DispatchTable:              {:.2f} ns/消息", table_ns);
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include "libuv_net/server.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace libuv_net;
+
+#ifdef _WIN32
+int main()
+{
+    spdlog::warn("该基准测试依赖 POSIX 套接字，当前平台不支持");
+    return 0;
+}
+#else
+namespace
+{
+    constexpr int PORT = 19091;
+    constexpr int LIGHT_CLIENTS = 4;
+    constexpr int PINGS_PER_CLIENT = 200;
+    constexpr size_t FLOOD_WRITE_SIZE = 64 * 1024;
+    constexpr size_t FLOOD_PAYLOAD_SIZE = 4;
+
+    int connect_to_server()
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(PORT);
+        addr.sin_addr.s_addr = htonl(0x7f000001);
+        if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return fd;
+    }
+
+    bool read_exact(int fd, uint8_t *out, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t n = recv(fd, out, size, 0);
+            if (n <= 0)
+            {
+                return false;
+            }
+            out += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // 模拟每条消息约 1 微秒的处理
+    void spin_one_microsecond()
+    {
+        auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(1);
+        while (std::chrono::steady_clock::now() < until)
+        {
+        }
+    }
+
+    struct Result
+    {
+        double p50_us;
+        double p99_us;
+        uint64_t flood_packets;
+    };
+
+    Result run(size_t budget)
+    {
+        std::atomic<uint64_t> flood_packets{0};
+
+        Server server;
+        server.set_read_budget(budget);
+        server.set_packet_handler(PacketType::TEXT, [&flood_packets](std::shared_ptr<Session>, std::shared_ptr<Packet>)
+                                  {
+                                      spin_one_microsecond();
+                                      flood_packets.fetch_add(1, std::memory_order_relaxed); });
+        server.set_packet_handler(PacketType::BINARY, [](std::shared_ptr<Session> session, std::shared_ptr<Packet> packet)
+                                  { session->send(packet); });
+        server.listen("127.0.0.1", PORT);
+        server.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        // 持续写入大量小消息的连接
+        int flood_fd = connect_to_server();
+        std::thread flooder([fd = flood_fd]()
+                            {
+                                std::vector<uint8_t> chunk;
+                                uint8_t frame[sizeof(PacketHeader) + FLOOD_PAYLOAD_SIZE] = {};
+                                write_packet_header(frame, PacketType::TEXT, FLOOD_PAYLOAD_SIZE, 0);
+                                while (chunk.size() + sizeof(frame) <= FLOOD_WRITE_SIZE)
+                                {
+                                    chunk.insert(chunk.end(), frame, frame + sizeof(frame));
+                                }
+                                while (fd >= 0)
+                                {
+                                    if (send(fd, chunk.data(), chunk.size(), MSG_NOSIGNAL) <= 0)
+                                    {
+                                        break;
+                                    }
+                                } });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        // 少量请求-响应的连接，测量往返延迟
+        std::vector<double> latencies;
+        std::mutex latencies_mutex;
+        std::vector<std::thread> clients;
+        for (int i = 0; i < LIGHT_CLIENTS; ++i)
+        {
+            clients.emplace_back([&]()
+                                 {
+                                     int fd = connect_to_server();
+                                     if (fd < 0)
+                                     {
+                                         return;
+                                     }
+                                     uint8_t request[sizeof(PacketHeader) + 8] = {};
+                                     uint8_t response[sizeof(request)];
+                                     std::vector<double> local;
+                                     for (int n = 0; n < PINGS_PER_CLIENT; ++n)
+                                     {
+                                         write_packet_header(request, PacketType::BINARY, 8, static_cast<uint32_t>(n));
+                                         auto start = std::chrono::steady_clock::now();
+                                         if (send(fd, request, sizeof(request), MSG_NOSIGNAL) <= 0 ||
+                                             !read_exact(fd, response, sizeof(response)))
+                                         {
+                                             break;
+                                         }
+                                         local.push_back(std::chrono::duration<double, std::micro>(
+                                                             std::chrono::steady_clock::now() - start)
+                                                             .count());
+                                     }
+                                     close(fd);
+                                     std::lock_guard<std::mutex> lock(latencies_mutex);
+                                     latencies.insert(latencies.end(), local.begin(), local.end()); });
+        }
+        for (auto &client : clients)
+        {
+            client.join();
+        }
+        uint64_t flooded = flood_packets.load();
+        // 关闭洪泛连接，解除阻塞的写入
+        if (flood_fd >= 0)
+        {
+            shutdown(flood_fd, SHUT_RDWR);
+        }
+        flooder.join();
+        if (flood_fd >= 0)
+        {
+            close(flood_fd);
+        }
+        server.stop();
+
+        if (latencies.empty())
+        {
+            return {0, 0, flooded};
+        }
+        std::sort(latencies.begin(), latencies.end());
+        return {latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], flooded};
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    for (size_t budget : {size_t(0), size_t(32)})
+    {
+        Result result = run(budget);
+        spdlog::set_level(spdlog::level::info);
+        spdlog::info("每轮预算 {:>2} 条: 往返延迟 p50 {:>9.0f} us  p99 {:>9.0f} us  同期处理洪泛消息 {} 条",
+                     budget, result.p50_us, result.p99_us, result.flood_packets);
+        spdlog::set_level(spdlog::level::warn);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,144 @@
+#include "libuv_net/server.hpp"
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace libuv_net;
+
+#if defined(_WIN32) || !defined(__GLIBC__)
+int main()
+{
+    spdlog::warn("该基准测试依赖 POSIX 套接字和 glibc 的 mallinfo，当前平台不支持");
+    return 0;
+}
+#else
+namespace
+{
+    constexpr int PORT = 19090;
+    constexpr size_t DEFAULT_CONNECTIONS = 100000;
+    constexpr size_t CONNECTIONS_PER_SOURCE_ADDRESS = 20000; // 每个源地址可用的临时端口有限
+
+    // 当前已分配的堆内存
+    size_t heap_in_use()
+    {
+#if __GLIBC_PREREQ(2, 33)
+        return mallinfo2().uordblks;
+#else
+        return static_cast<size_t>(mallinfo().uordblks);
+#endif
+    }
+
+    // 将文件描述符上限提高到硬上限，返回可用的连接数（每个连接在本进程中占两个描述符）
+    size_t max_connections()
+    {
+        struct rlimit limit;
+        getrlimit(RLIMIT_NOFILE, &limit);
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        return limit.rlim_cur > 256 ? (limit.rlim_cur - 256) / 2 : 0;
+    }
+
+    bool wait_for_sessions(const Server &server, size_t count)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (server.session_count() < count)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    size_t connections = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_CONNECTIONS;
+    size_t limit = max_connections();
+    if (connections > limit)
+    {
+        spdlog::warn("文件描述符上限只允许 {} 个连接（请求 {} 个）", limit, connections);
+        connections = limit;
+    }
+
+    Server server;
+    server.listen("127.0.0.1", PORT);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    size_t heap_before = heap_in_use();
+
+    // 分批建立空闲连接，避免超出监听队列
+    std::vector<int> sockets;
+    sockets.reserve(connections);
+    while (sockets.size() < connections)
+    {
+        size_t batch_end = std::min(connections, sockets.size() + 1000);
+        while (sockets.size() < batch_end)
+        {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            if (fd < 0)
+            {
+                spdlog::error("创建套接字失败，已建立 {} 个连接", sockets.size());
+                return 1;
+            }
+
+            sockaddr_in local{};
+            local.sin_family = AF_INET;
+            local.sin_addr.s_addr = htonl(0x7f000001 + static_cast<uint32_t>(sockets.size() / CONNECTIONS_PER_SOURCE_ADDRESS));
+            bind(fd, reinterpret_cast<sockaddr *>(&local), sizeof(local));
+
+            sockaddr_in remote{};
+            remote.sin_family = AF_INET;
+            remote.sin_port = htons(PORT);
+            remote.sin_addr.s_addr = htonl(0x7f000001);
+            if (connect(fd, reinterpret_cast<sockaddr *>(&remote), sizeof(remote)) != 0)
+            {
+                spdlog::error("连接失败，已建立 {} 个连接", sockets.size());
+                close(fd);
+                return 1;
+            }
+            sockets.push_back(fd);
+        }
+
+        if (!wait_for_sessions(server, sockets.size()))
+        {
+            spdlog::error("等待服务器接受连接超时");
+            return 1;
+        }
+    }
+
+    // 等待会话创建过程中的临时分配释放
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    size_t heap_after = heap_in_use();
+    size_t client_side = sockets.capacity() * sizeof(int);
+    double per_session = static_cast<double>(heap_after - heap_before - client_side) / connections;
+
+    spdlog::set_level(spdlog::level::info);
+    spdlog::info("空闲连接数: {}", connections);
+    spdlog::info("sizeof(Session): {} 字节", sizeof(Session));
+    spdlog::info("每个空闲会话占用的堆内存: {:.0f} 字节", per_session);
+
+    for (int fd : sockets)
+    {
+        close(fd);
+    }
+    server.stop();
+    return 0;
+}
+#endif
@@ -0,0 +1,179 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include "libuv_net/journal.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace libuv_net;
+
+namespace
+{
+    constexpr int PORT = 19098;
+    constexpr size_t MESSAGE_SIZE = 256;
+    constexpr int GROUP_COMMIT_MESSAGES = 50000;
+    constexpr int SYNC_EACH_MESSAGES = 2000; // 每个消息一次 msync 太慢，只测少量消息
+
+    std::string bench_directory(const char *name)
+    {
+        return (std::filesystem::temp_directory_path() /
+                ("libuv_net-journal-" + std::to_string(getpid()) + "-" + name))
+            .string();
+    }
+
+    struct Result
+    {
+        double append_p50_us;
+        double append_p99_us;
+        double durable_seconds; // 追加第一个消息到全部写入磁盘的时间
+        uint64_t commits;       // 执行的 msync 批次数
+    };
+
+    /**
+     * 在本线程的事件循环上追加消息，每追加 64 个消息运行一次事件循环处理提交完成的回调，
+     * 模拟事件循环线程在 I/O 之间追加消息。sync_each 为 true 时每个消息之后同步 msync。
+     */
+    Result run_journal(const char *name, int messages, bool sync_each)
+    {
+        std::string directory = bench_directory(name);
+        uv_loop_t loop;
+        uv_loop_init(&loop);
+
+        Result result{0, 0, 0, 0};
+        {
+            auto journal = Journal::open(&loop, JournalOptions{directory, 16 * 1024 * 1024});
+            if (!journal)
+            {
+                return result;
+            }
+            if (!sync_each)
+            {
+                journal->set_durable_handler([&result](uint32_t)
+                                             { ++result.commits; });
+            }
+
+            std::vector<uint8_t> body(MESSAGE_SIZE, 0x5a);
+            std::vector<double> latencies;
+            latencies.reserve(messages);
+            auto begin = std::chrono::steady_clock::now();
+            for (int i = 0; i < messages; ++i)
+            {
+                auto start = std::chrono::steady_clock::now();
+                journal->append(PacketType::BINARY, body.data(), body.size());
+                if (sync_each)
+                {
+                    journal->sync();
+                    ++result.commits;
+                }
+                latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+                if (i % 64 == 63)
+                {
+                    uv_run(&loop, UV_RUN_NOWAIT);
+                }
+            }
+            while (journal->durable_sequence() != journal->last_sequence() || !journal->idle())
+            {
+                uv_run(&loop, UV_RUN_ONCE);
+            }
+            result.durable_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+            std::sort(latencies.begin(), latencies.end());
+            result.append_p50_us = latencies[latencies.size() / 2];
+            result.append_p99_us = latencies[latencies.size() * 99 / 100];
+        }
+        uv_loop_close(&loop);
+        std::filesystem::remove_all(directory);
+        return result;
+    }
+
+    /**
+     * 客户端经 send() 或 send_durable() 发出消息，服务器确认带序列号的消息；
+     * 持久化发送等到全部消息被确认、日志截断后才算完成。
+     */
+    double run_client(bool durable)
+    {
+        std::atomic<int> received{0};
+        Server server;
+        server.enable_acknowledgements();
+        server.set_packet_handler(PacketType::BINARY, [&received](std::shared_ptr<Session>, std::shared_ptr<Packet>)
+                                  { ++received; });
+        server.listen("127.0.0.1", PORT);
+        server.start();
+
+        std::string directory = bench_directory("client");
+        double seconds = 0;
+        {
+            Client client;
+            client.start();
+            if (durable && !client.enable_journal(JournalOptions{directory, 16 * 1024 * 1024}))
+            {
+                return 0;
+            }
+            client.connect("127.0.0.1", PORT);
+            for (int i = 0; i < 200 && !client.is_connected(); ++i)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+
+            std::vector<uint8_t> body(MESSAGE_SIZE, 0x5a);
+            auto begin = std::chrono::steady_clock::now();
+            for (int i = 0; i < GROUP_COMMIT_MESSAGES; ++i)
+            {
+                auto packet = std::make_shared<Packet>(PacketType::BINARY, body);
+                if (durable)
+                {
+                    client.send_durable(std::move(packet));
+                }
+                else
+                {
+                    client.send(std::move(packet));
+                }
+            }
+            auto deadline = begin + std::chrono::seconds(60);
+            while ((received < GROUP_COMMIT_MESSAGES || (durable && client.unacknowledged_count() > 0)) &&
+                   std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            client.stop();
+        }
+        server.stop();
+        std::filesystem::remove_all(directory);
+        if (received < GROUP_COMMIT_MESSAGES)
+        {
+            spdlog::error("超时，服务器只收到 {} 个消息", received.load());
+            return 0;
+        }
+        return GROUP_COMMIT_MESSAGES / seconds;
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    auto group = run_journal("group", GROUP_COMMIT_MESSAGES, false);
+    auto each = run_journal("each", SYNC_EACH_MESSAGES, true);
+    double plain = run_client(false);
+    double durable = run_client(true);
+
+    spdlog::set_level(spdlog::level::info);
+    spdlog::info("消息 {} 字节", MESSAGE_SIZE);
+    spdlog::info("组提交      追加 p50 {:>8.2f} us  p99 {:>8.2f} us  {:>9.0f} msg/s 写入磁盘  {} 次 msync / {} 个消息",
+                 group.append_p50_us, group.append_p99_us, GROUP_COMMIT_MESSAGES / group.durable_seconds,
+                 group.commits, GROUP_COMMIT_MESSAGES);
+    spdlog::info("逐个 msync  追加 p50 {:>8.2f} us  p99 {:>8.2f} us  {:>9.0f} msg/s 写入磁盘  {} 次 msync / {} 个消息",
+                 each.append_p50_us, each.append_p99_us, SYNC_EACH_MESSAGES / each.durable_seconds,
+                 each.commits, SYNC_EACH_MESSAGES);
+    spdlog::info("客户端 send()          {:>9.0f} msg/s", plain);
+    spdlog::info("客户端 send_durable()  {:>9.0f} msg/s（含服务器确认和日志截断）", durable);
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "libuv_net/json_interceptor.hpp"
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <ostream>
+#include <streambuf>
+
+using namespace libuv_net;
+
+namespace
+{
+    constexpr int ITERATIONS = 20000;
+
+    // 模拟行情快照的样例文档
+    nlohmann::json make_document()
+    {
+        nlohmann::json doc;
+        doc["symbol"] = "600000.SH";
+        doc["timestamp"] = 1718000000123456ULL;
+        doc["status"] = "TRADING";
+        for (int i = 0; i < 10; ++i)
+        {
+            doc["bids"].push_back({{"price", 10.01 - i * 0.01}, {"volume", 1000 + i * 100}, {"orders", i + 1}});
+            doc["asks"].push_back({{"price", 10.02 + i * 0.01}, {"volume", 900 + i * 50}, {"orders", i + 2}});
+        }
+        for (int i = 0; i < 20; ++i)
+        {
+            doc["trades"].push_back({{"id", 100000 + i}, {"price", 10.015}, {"qty", 200}, {"side", i % 2 ? "B" : "S"}});
+        }
+        return doc;
+    }
+
+    // 追加写入 vector 的流缓冲区
+    class VectorStreambuf : public std::streambuf
+    {
+    public:
+        explicit VectorStreambuf(std::vector<uint8_t> &out) : out_(out) {}
+
+    protected:
+        int_type overflow(int_type c) override
+        {
+            out_.push_back(static_cast<uint8_t>(c));
+            return c;
+        }
+
+        std::streamsize xsputn(const char *data, std::streamsize size) override
+        {
+            out_.insert(out_.end(), data, data + size);
+            return size;
+        }
+
+    private:
+        std::vector<uint8_t> &out_;
+    };
+
+    template <typename F>
+    double measure_us(F &&f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; ++i)
+        {
+            f();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::micro>(elapsed).count() / ITERATIONS;
+    }
+
+    void report(const char *name, size_t wire_size, double dump_us, double parse_us)
+    {
+        spdlog::info("{:<22} 线路大小 {:>6} 字节  序列化 {:>7.2f} us ({:>7.1f} MB/s)  解析 {:>7.2f} us ({:>7.1f} MB/s)",
+                     name, wire_size,
+                     dump_us, wire_size / dump_us,
+                     parse_us, wire_size / parse_us);
+    }
+}
+
+int main()
+{
+    auto doc = make_document();
+    std::any doc_any = doc;
+
+    // 旧实现：dump 到字符串再拷贝到 vector，解析前再拷贝回字符串
+    {
+        std::vector<uint8_t> wire;
+        double dump_us = measure_us([&]()
+                                    {
+            const auto &json = std::any_cast<nlohmann::json>(doc_any);
+            std::string json_str = json.dump();
+            wire = std::vector<uint8_t>(json_str.begin(), json_str.end()); });
+        double parse_us = measure_us([&]()
+                                     {
+            std::string json_str(wire.begin(), wire.end());
+            auto json = nlohmann::json::parse(json_str);
+            (void)json; });
+        report("旧实现（文本）", wire.size(), dump_us, parse_us);
+    }
+
+    // 不经过中间字符串、经 std::ostream 直接写入 vector 的文本编码，与下面 dump() 后拷贝的文本编码对比
+    {
+        std::vector<uint8_t> wire;
+        double dump_us = measure_us([&]()
+                                    {
+            std::vector<uint8_t> result;
+            VectorStreambuf buffer(result);
+            std::ostream stream(&buffer);
+            stream << *std::any_cast<nlohmann::json>(&doc_any);
+            wire = std::move(result); });
+        nlohmann::json parsed;
+        double parse_us = measure_us([&]()
+                                     { json_codec::decode(wire.data(), wire.size(), parsed); });
+        report("ostream 写入（文本）", wire.size(), dump_us, parse_us);
+    }
+
+    const std::pair<JsonEncoding, const char *> encodings[] = {
+        {JsonEncoding::TEXT, "文本"},
+        {JsonEncoding::CBOR, "CBOR"},
+        {JsonEncoding::MSGPACK, "MessagePack"},
+        {JsonEncoding::UBJSON, "UBJSON"},
+    };
+
+    for (const auto &entry : encodings)
+    {
+        JsonInterceptor interceptor(entry.first);
+        std::vector<uint8_t> wire = interceptor.serialize(doc_any);
+        double dump_us = measure_us([&]()
+                                    { wire = interceptor.serialize(doc_any); });
+
+        nlohmann::json parsed;
+        double parse_us = measure_us([&]()
+                                     { json_codec::decode(wire.data(), wire.size(), parsed); });
+        if (parsed != doc)
+        {
+            spdlog::error("{} 编解码结果不一致", entry.second);
+            return 1;
+        }
+        report(entry.second, wire.size(), dump_us, parse_us);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "libuv_net/protobuf_interceptor.hpp"
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+#include <spdlog/spdlog.h>
+#include <chrono>
+
+using namespace libuv_net;
+
+namespace
+{
+    constexpr int ITERATIONS = 200000;
+
+    // 使用 libprotobuf 自带的生成类型作为样例消息，无需 protoc
+    google::protobuf::FileDescriptorProto make_message()
+    {
+        google::protobuf::FileDescriptorProto file;
+        file.set_name("market/quote.proto");
+        file.set_package("market");
+        for (int i = 0; i < 4; ++i)
+        {
+            auto *type = file.add_message_type();
+            type->set_name("Quote" + std::to_string(i));
+            for (int j = 0; j < 6; ++j)
+            {
+                auto *field = type->add_field();
+                field->set_name("field_" + std::to_string(j));
+                field->set_number(j + 1);
+                field->set_type(google::protobuf::FieldDescriptorProto::TYPE_DOUBLE);
+            }
+        }
+        return file;
+    }
+
+    template <typename F>
+    double measure_per_second(F &&f)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; ++i)
+        {
+            f();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return ITERATIONS / std::chrono::duration<double>(elapsed).count();
+    }
+}
+
+int main()
+{
+    auto prototype = make_message();
+    std::string payload = prototype.SerializeAsString();
+
+    // 旧实现：每个消息拷贝成字符串、新建 DynamicMessageFactory、按名称查找类型、堆上创建消息
+    // （原代码查找的 "google.protobuf.Message" 并不存在，这里换成实际类型以测出其开销）
+    std::vector<uint8_t> old_data(payload.begin(), payload.end());
+    size_t parsed = 0;
+    double old_rate = measure_per_second([&]()
+                                         {
+        std::string serialized(old_data.begin(), old_data.end());
+        google::protobuf::DynamicMessageFactory factory;
+        const google::protobuf::Descriptor *descriptor =
+            google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName("google.protobuf.FileDescriptorProto");
+        std::unique_ptr<google::protobuf::Message> message(factory.GetPrototype(descriptor)->New());
+        if (message->ParseFromString(serialized))
+        {
+            auto result = std::shared_ptr<google::protobuf::Message>(message.release());
+            parsed += result != nullptr;
+        } });
+
+    // 新实现：类型 ID 查找缓存的原型，在复用的 Arena 上直接从消息体解析
+    ProtobufInterceptor interceptor;
+    interceptor.register_type<google::protobuf::FileDescriptorProto>();
+    std::vector<uint8_t> new_data = interceptor.serialize(
+        std::shared_ptr<google::protobuf::Message>(std::make_shared<google::protobuf::FileDescriptorProto>(prototype)));
+    double new_rate = measure_per_second([&]()
+                                         {
+        auto result = interceptor.deserialize(new_data);
+        parsed += result.has_value(); });
+
+    // 新实现，且处理器持有消息较长时间（Arena 无法立即复用）
+    std::vector<std::any> held;
+    held.reserve(64);
+    double held_rate = measure_per_second([&]()
+                                          {
+        if (held.size() == 64)
+        {
+            held.clear();
+        }
+        held.push_back(interceptor.deserialize(new_data));
+        parsed += held.back().has_value(); });
+
+    spdlog::info("消息大小 {} 字节，成功解析 {} 个", payload.size(), parsed);
+    spdlog::info("旧实现（DynamicMessageFactory）: {:>10.0f} 消息/秒", old_rate);
+    spdlog::info("注册表 + Arena:                 {:>10.0f} 消息/秒", new_rate);
+    spdlog::info("注册表 + Arena（持有 64 个）:   {:>10.0f} 消息/秒", held_rate);
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "libuv_net/server.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace libuv_net;
+
+#ifdef _WIN32
+int main()
+{
+    spdlog::warn("该基准测试依赖 POSIX 套接字，当前平台不支持");
+    return 0;
+}
+#else
+namespace
+{
+    constexpr int PORT = 19092;
+    constexpr int REQUESTS = 200;
+    constexpr size_t PAYLOAD_SIZE = 64;
+
+    int connect_to_server()
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(PORT);
+        addr.sin_addr.s_addr = htonl(0x7f000001);
+        if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return fd;
+    }
+
+    bool read_exact(int fd, uint8_t *out, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t n = recv(fd, out, size, 0);
+            if (n <= 0)
+            {
+                return false;
+            }
+            out += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * 每个请求的响应分两次写出（先确认、后结果），第二次写出正是 Nagle 算法
+     * 等待上一段确认的场景；测量客户端收到两个响应的往返延迟。
+     */
+    std::pair<double, double> run(const SocketOptions &options)
+    {
+        Server server;
+        server.set_socket_options(options);
+        server.set_packet_handler(PacketType::BINARY, [](std::shared_ptr<Session> session, std::shared_ptr<Packet> packet)
+                                  {
+                                      session->send(std::make_shared<Packet>(PacketType::TEXT, std::vector<uint8_t>(8), packet->sequence()));
+                                      session->send(packet); });
+        server.listen("127.0.0.1", PORT);
+        server.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        std::vector<double> latencies;
+        int fd = connect_to_server();
+        if (fd >= 0)
+        {
+            std::vector<uint8_t> request(sizeof(PacketHeader) + PAYLOAD_SIZE);
+            std::vector<uint8_t> response(2 * sizeof(PacketHeader) + 8 + PAYLOAD_SIZE);
+            for (int n = 0; n < REQUESTS; ++n)
+            {
+                write_packet_header(request.data(), PacketType::BINARY, PAYLOAD_SIZE, static_cast<uint32_t>(n));
+                auto start = std::chrono::steady_clock::now();
+                if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) <= 0 ||
+                    !read_exact(fd, response.data(), response.size()))
+                {
+                    break;
+                }
+                latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            }
+            close(fd);
+        }
+        server.stop();
+
+        if (latencies.empty())
+        {
+            return {0, 0};
+        }
+        std::sort(latencies.begin(), latencies.end());
+        return {latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100]};
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    SocketOptions nodelay;
+    nodelay.nodelay = true;
+    SocketOptions busy_poll = SocketOptions::low_latency();
+    busy_poll.busy_poll_us = 50;
+
+    std::vector<std::pair<const char *, SocketOptions>> profiles = {
+        {"默认", SocketOptions()},
+        {"nodelay", nodelay},
+        {"low_latency", SocketOptions::low_latency()},
+        {"low_latency + busy_poll", busy_poll},
+        {"high_throughput", SocketOptions::high_throughput()},
+    };
+
+    for (const auto &profile : profiles)
+    {
+        auto [p50, p99] = run(profile.second);
+        spdlog::set_level(spdlog::level::info);
+        spdlog::info("{:<24} 往返延迟 p50 {:>8.0f} us  p99 {:>8.0f} us", profile.first, p50, p99);
+        spdlog::set_level(spdlog::level::warn);
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,90 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace libuv_net;
+
+namespace
+{
+    constexpr int OBJECTS = 20;
+
+    struct Result
+    {
+        double startup_ms; // 创建并启动所有服务器和客户端的耗时
+        long threads;      // 此时进程的线程数
+        long rss_kb;       // 此时进程的常驻内存
+    };
+
+    // 读取 /proc/self/status 中的一项
+    long read_status(const std::string &key)
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, key.size(), key) == 0)
+            {
+                return std::stol(line.substr(key.size()));
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * 创建并启动 OBJECTS 个服务器和 OBJECTS 个客户端，不建立连接；
+     * eager 为 true 时构造后立即取线程池，等同于构造函数中创建线程池的旧行为。
+     */
+    Result run(bool eager, size_t pool_threads)
+    {
+        std::vector<std::unique_ptr<Server>> servers;
+        std::vector<std::unique_ptr<Client>> clients;
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < OBJECTS; ++i)
+        {
+            auto server = std::make_unique<Server>();
+            auto client = std::make_unique<Client>();
+            server->set_thread_pool_size(pool_threads);
+            client->context().set_thread_pool_size(pool_threads);
+            if (eager)
+            {
+                server->thread_pool();
+                client->thread_pool();
+            }
+            server->start();
+            client->start();
+            servers.push_back(std::move(server));
+            clients.push_back(std::move(client));
+        }
+        Result result{std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count(),
+                      read_status("Threads:"), read_status("VmRSS:")};
+
+        clients.clear();
+        servers.clear();
+        return result;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    // 线程池大小默认为硬件线程数，可以传入更大的值模拟多核主机
+    size_t pool_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    for (bool eager : {true, false})
+    {
+        auto result = run(eager, pool_threads);
+        spdlog::set_level(spdlog::level::info);
+        spdlog::info("{:<4} 线程池 {} 线程  {} 个服务器 + {} 个客户端  启动 {:>7.1f} ms  线程 {:>5}  RSS {:>7} KB",
+                     eager ? "立即" : "延迟", pool_threads, OBJECTS, OBJECTS, result.startup_ms, result.threads,
+                     result.rss_kb);
+        spdlog::set_level(spdlog::level::warn);
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace libuv_net;
+
+#ifdef _WIN32
+int main()
+{
+    spdlog::warn("该基准测试依赖 Unix 域套接字，当前平台不支持");
+    return 0;
+}
+#else
+namespace
+{
+    constexpr int PORT = 19093;
+    constexpr int REQUESTS = 20000;
+    constexpr size_t PAYLOAD_SIZE = 64;
+
+    struct Result
+    {
+        double p50_us;
+        double p99_us;
+        double requests_per_second;
+    };
+
+    /**
+     * 客户端发出一个请求后等待服务器回显，再发下一个；
+     * 请求在客户端事件循环中发出，测量的是两个事件循环之间的完整往返。
+     */
+    template <typename Connect>
+    Result run(Server &server, Connect &&connect)
+    {
+        server.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        Client client;
+        std::vector<double> latencies;
+        latencies.reserve(REQUESTS);
+        std::atomic<bool> done{false};
+        auto request = std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(PAYLOAD_SIZE));
+        std::chrono::steady_clock::time_point sent_at;
+
+        client.set_packet_handler(PacketType::BINARY, [&](std::shared_ptr<Packet>)
+                                  {
+                                      latencies.push_back(std::chrono::duration<double, std::micro>(
+                                                              std::chrono::steady_clock::now() - sent_at)
+                                                              .count());
+                                      if (latencies.size() == REQUESTS)
+                                      {
+                                          done = true;
+                                          return;
+                                      }
+                                      sent_at = std::chrono::steady_clock::now();
+                                      client.send(request); });
+        client.set_connect_handler([&]()
+                                   {
+                                       sent_at = std::chrono::steady_clock::now();
+                                       client.send(request); });
+        client.start();
+        connect(client);
+
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = start + std::chrono::seconds(60);
+        while (!done && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        client.stop();
+        server.stop();
+
+        if (!done)
+        {
+            spdlog::error("超时，只完成了 {} 次往返", latencies.size());
+            return {0, 0, 0};
+        }
+        std::sort(latencies.begin(), latencies.end());
+        return {latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], REQUESTS / elapsed};
+    }
+
+    void report(const char *name, const Result &result)
+    {
+        spdlog::set_level(spdlog::level::info);
+        spdlog::info("{:<12} 往返延迟 p50 {:>6.1f} us  p99 {:>6.1f} us  {:>8.0f} 次/秒",
+                     name, result.p50_us, result.p99_us, result.requests_per_second);
+        spdlog::set_level(spdlog::level::warn);
+    }
+
+    void echo(Server &server)
+    {
+        server.set_packet_handler(PacketType::BINARY, [](std::shared_ptr<Session> session, std::shared_ptr<Packet> packet)
+                                  { session->send(packet); });
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    {
+        Server server;
+        echo(server);
+        server.set_socket_options(SocketOptions::low_latency());
+        server.listen("127.0.0.1", PORT);
+        report("TCP", run(server, [](Client &client)
+                          {
+                              client.set_socket_options(SocketOptions::low_latency());
+                              client.connect("127.0.0.1", PORT); }));
+    }
+
+    {
+        std::string path = "/tmp/libuv_net_bench_" + std::to_string(getpid()) + ".sock";
+        Server server;
+        echo(server);
+        server.listen_unix(path);
+        report("UDS", run(server, [&path](Client &client)
+                          { client.connect_unix(path); }));
+        server.stop_listening();
+    }
+
+#ifdef __linux__
+    {
+        std::string name = "@libuv_net_bench_" + std::to_string(getpid());
+        Server server;
+        echo(server);
+        server.listen_unix(name);
+        report("UDS (抽象)", run(server, [&name](Client &client)
+                                 { client.connect_unix(name); }));
+    }
+#endif
+
+    for (bool polling : {false, true})
+    {
+        // 轮询模式下两个事件循环线程都不休眠，各需独占一个核心
+        if (polling && std::thread::hardware_concurrency() < 3)
+        {
+            spdlog::set_level(spdlog::level::info);
+            spdlog::info("核心数不足，跳过共享内存轮询模式");
+            continue;
+        }
+
+        std::string path = "/tmp/libuv_net_bench_shm_" + std::to_string(getpid()) + ".sock";
+        ShmOptions options;
+        options.enabled = true;
+        options.polling = polling;
+        Server server;
+        echo(server);
+        server.enable_shared_memory(options);
+        server.listen_unix(path);
+        report(polling ? "共享内存 (轮询)" : "共享内存", run(server, [&path, &options](Client &client)
+                                                              {
+                                                                  client.set_shared_memory(options);
+                                                                  client.connect_unix(path); }));
+        server.stop_listening();
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "libuv_net/dispatch_table.hpp"
+
+namespace libuv_net
+{
+    enum class PacketType : uint8_t;
+
+    // 过载时对新连接的处理方式
+    enum class OverloadAction
+    {
+        DEFER, // 暂停接受，连接留在内核的监听队列中，恢复后再接受
+        REJECT // 接受后立即关闭
+    };
+
+    /**
+     * @brief 准入控制的阈值
+     *
+     * 阈值为 0 表示不检查该项。事件循环延迟或缓冲字节数超过阈值时进入过载状态，
+     * 两者都回落到阈值的 resume_ratio 以下才退出，避免在阈值附近反复切换。
+     */
+    struct AdmissionLimits
+    {
+        std::chrono::milliseconds max_loop_lag{0};       // 事件循环延迟上限
+        size_t max_buffered_bytes = 0;                   // 所有会话待写出和待处理字节数之和的上限
+        size_t max_sessions = 0;                         // 会话数上限，达到后不再接受新连接
+        double resume_ratio = 0.8;                       // 退出过载的阈值比例
+        OverloadAction action = OverloadAction::DEFER;   // 过载时对新连接的处理方式
+        std::vector<PacketType> shed_types;              // 过载时丢弃的低优先级消息类型
+        std::chrono::milliseconds sample_interval{100};  // 采样间隔
+
+        bool enabled() const
+        {
+            return max_loop_lag.count() > 0 || max_buffered_bytes > 0 || max_sessions > 0;
+        }
+    };
+
+    // 准入控制的状态和计数
+    struct AdmissionMetrics
+    {
+        std::chrono::microseconds loop_lag{0}; // 最近一次采样的事件循环延迟
+        size_t buffered_bytes = 0;             // 最近一次采样的缓冲字节数
+        bool overloaded = false;               // 是否处于过载状态
+        bool accept_paused = false;            // 是否暂停了接受新连接
+        uint64_t overload_count = 0;           // 进入过载状态的次数
+        uint64_t deferred_connections = 0;     // 因过载暂停接受的次数
+        uint64_t rejected_connections = 0;     // 因过载拒绝的连接数
+        uint64_t shed_packets = 0;             // 因过载丢弃的消息数
+    };
+
+    /**
+     * @brief 准入控制
+     *
+     * 由服务器定时采样事件循环延迟和缓冲字节数后更新状态，过载时暂停或拒绝新连接，
+     * 并由会话在分发前丢弃低优先级类型的消息。状态只在事件循环线程中更新，
+     * 计数使用原子变量，metrics() 可以在任意线程调用。
+     */
+    class AdmissionControl
+    {
+    public:
+        // 设置阈值，应在事件循环启动之前调用
+        void configure(const AdmissionLimits &limits)
+        {
+            limits_ = limits;
+            shed_types_ = DispatchTable<bool>();
+            for (PacketType type : limits_.shed_types)
+            {
+                shed_types_.set(type, true);
+            }
+        }
+
+        const AdmissionLimits &limits() const { return limits_; }
+
+        /**
+         * @brief 用一次采样更新过载状态
+         * @param loop_lag 事件循环延迟
+         * @param buffered_bytes 缓冲字节数
+         * @return 是否处于过载状态
+         */
+        bool update(std::chrono::microseconds loop_lag, size_t buffered_bytes)
+        {
+            loop_lag_.store(loop_lag.count(), std::memory_order_relaxed);
+            buffered_bytes_.store(buffered_bytes, std::memory_order_relaxed);
+
+            bool overloaded = overloaded_.load(std::memory_order_relaxed);
+            double ratio = overloaded ? limits_.resume_ratio : 1.0;
+            bool over = exceeds(static_cast<double>(loop_lag.count()),
+                                std::chrono::duration<double, std::micro>(limits_.max_loop_lag).count(), ratio) ||
+                        exceeds(static_cast<double>(buffered_bytes), static_cast<double>(limits_.max_buffered_bytes), ratio);
+            if (over && !overloaded)
+            {
+                overload_count_.fetch_add(1, std::memory_order_relaxed);
+            }
+            overloaded_.store(over, std::memory_order_relaxed);
+            return over;
+        }
+
+        // 是否处于过载状态
+        bool overloaded() const { return overloaded_.load(std::memory_order_relaxed); }
+
+        // 当前是否可以接受新连接
+        bool accepts(size_t sessions) const
+        {
+            return !overloaded() && (limits_.max_sessions == 0 || sessions < limits_.max_sessions);
+        }
+
+        // 过载时是否丢弃该类型的消息，丢弃时计数
+        bool shed(PacketType type)
+        {
+            if (!overloaded() || !shed_types_.contains(type))
+            {
+                return false;
+            }
+            shed_packets_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        void set_accept_paused(bool paused)
+        {
+            if (paused && !accept_paused_.load(std::memory_order_relaxed))
+            {
+                deferred_connections_.fetch_add(1, std::memory_order_relaxed);
+            }
+            accept_paused_.store(paused, std::memory_order_relaxed);
+        }
+
+        void record_rejected() { rejected_connections_.fetch_add(1, std::memory_order_relaxed); }
+
+        AdmissionMetrics metrics() const
+        {
+            AdmissionMetrics metrics;
+            metrics.loop_lag = std::chrono::microseconds(loop_lag_.load(std::memory_order_relaxed));
+            metrics.buffered_bytes = buffered_bytes_.load(std::memory_order_relaxed);
+            metrics.overloaded = overloaded_.load(std::memory_order_relaxed);
+            metrics.accept_paused = accept_paused_.load(std::memory_order_relaxed);
+            metrics.overload_count = overload_count_.load(std::memory_order_relaxed);
+            metrics.deferred_connections = deferred_connections_.load(std::memory_order_relaxed);
+            metrics.rejected_connections = rejected_connections_.load(std::memory_order_relaxed);
+            metrics.shed_packets = shed_packets_.load(std::memory_order_relaxed);
+            return metrics;
+        }
+
+    private:
+        // 阈值为 0 表示不检查
+        static bool exceeds(double value, double limit, double ratio)
+        {
+            return limit > 0 && value > limit * ratio;
+        }
+
+        AdmissionLimits limits_;
+        DispatchTable<bool> shed_types_; // 过载时丢弃的消息类型
+
+        std::atomic<int64_t> loop_lag_{0};
+        std::atomic<size_t> buffered_bytes_{0};
+        std::atomic<bool> overloaded_{false};
+        std::atomic<bool> accept_paused_{false};
+        std::atomic<uint64_t> overload_count_{0};
+        std::atomic<uint64_t> deferred_connections_{0};
+        std::atomic<uint64_t> rejected_connections_{0};
+        std::atomic<uint64_t> shed_packets_{0};
+    };
+
+} // namespace libuv_net
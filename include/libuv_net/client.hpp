@@ -1,13 +1,17 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <functional>
 #include <uv.h>
 #include "libuv_net/message.hpp"
-#include "libuv_net/thread_pool.hpp"
+#include "libuv_net/session.hpp"
+#include "libuv_net/client_context.hpp"
+#include "libuv_net/resolver.hpp"
+#include "libuv_net/reconnect.hpp"
+#include "libuv_net/journal.hpp"
 #include <spdlog/spdlog.h>
-#include <map>
 
 namespace libuv_net
 {
@@ -21,6 +25,12 @@ namespace libuv_net
      * - 自动重连
      * - 心跳检测
      * - 数据格式拦截器
+     * - 大消息的流式分块收发
+     *
+     * 连接上的收发、分帧和心跳由内部的 Session 完成。
+     *
+     * 默认构造的客户端独占一个事件循环线程；传入 ClientContext 时多个客户端共享运行时的循环和线程。
+     * 连接、断开和发送可以在任意线程调用，在其他线程调用时投递到事件循环线程执行。
      */
     class Client
     {
@@ -28,9 +38,20 @@ namespace libuv_net
         // 回调函数类型定义
         using ConnectHandler = std::function<void()>;                       // 连接回调
         using DisconnectHandler = std::function<void()>;                    // 断开连接回调
+        using ConnectErrorHandler = std::function<void(int status)>;        // 连接失败回调
         using PacketHandler = std::function<void(std::shared_ptr<Packet>)>; // 消息处理回调
 
         Client();
+
+        /**
+         * @brief 创建附加到共享运行时的客户端
+         *
+         * 从运行时分配一个事件循环，start() 和 stop() 不再启停循环线程，由运行时统一管理。
+         * 不能在同一运行时的事件循环线程中销毁，析构时需要等待该循环执行完关闭回调。
+         *
+         * @param context 客户端运行时
+         */
+        explicit Client(std::shared_ptr<ClientContext> context);
         ~Client();
 
         // 禁用拷贝构造和赋值
@@ -39,23 +60,42 @@ namespace libuv_net
 
         /**
          * @brief 启动事件循环
+         *
+         * 附加到共享运行时时不启动线程，返回运行时是否在运行。
          * @return 是否成功启动
          */
         bool start();
 
         /**
          * @brief 停止事件循环
+         *
+         * 附加到共享运行时时只停止读取，循环线程继续为其他客户端运行。
          */
         void stop();
 
         /**
          * @brief 连接到服务器
-         * @param host 服务器主机名或 IP 地址
+         *
+         * 主机名在事件循环上异步解析（结果按 TTL 缓存），解析出的 IPv6 和 IPv4 地址交替尝试：
+         * 上一个尝试在 250 毫秒内未完成时并行发起下一个，失败时立即尝试下一个，
+         * 最先建立的连接胜出，其余的尝试被放弃（Happy Eyeballs，RFC 8305）。
+         *
+         * @param host 服务器主机名或 IP 地址，IPv6 地址可以带方括号
          * @param port 服务器端口
          * @return 是否成功发起连接
          */
         bool connect(const std::string &host, uint16_t port);
 
+        /**
+         * @brief 通过 Unix 域套接字连接到同一主机上的服务器
+         *
+         * 消息接口与 TCP 连接完全相同。以 @ 开头的路径使用 Linux 的抽象命名空间。
+         *
+         * @param path 套接字路径
+         * @return 是否成功发起连接
+         */
+        bool connect_unix(const std::string &path);
+
         /**
          * @brief 断开与服务器的连接
          */
@@ -67,8 +107,22 @@ namespace libuv_net
          */
         void send(std::shared_ptr<Packet> packet);
 
+        /**
+         * @brief 流式发送大消息到服务器
+         * @param type 消息类型
+         * @param length 消息体总长度
+         * @param source 数据源回调，按窗口大小分块拉取
+         * @param sequence 序列号
+         * @return 是否成功提交
+         */
+        bool send_stream(PacketType type, uint32_t length, ChunkSource source, uint32_t sequence = 0);
+
         /**
          * @brief 发送数据到服务器（使用拦截器）
+         *
+         * 序列化结果移入数据包，在事件循环线程中再拷贝进帧缓冲区一次；
+         * 不经过中间向量、直接编码进帧缓冲区的只有 send<Type>() 的 Codec<T> 路径。
+         *
          * @param type 消息类型
          * @param data 要发送的数据
          */
@@ -78,12 +132,32 @@ namespace libuv_net
             auto interceptor = interceptor_manager_.get_interceptor(type);
             if (interceptor)
             {
-                auto serialized_data = interceptor->serialize(data);
-                auto packet = std::make_shared<Packet>(type, serialized_data);
-                send(packet);
+                send(std::make_shared<Packet>(type, interceptor->serialize(data)));
             }
         }
 
+        /**
+         * @brief 使用编解码器发送数据到服务器
+         * @param value 要发送的数据，编解码器在编译期确定
+         */
+        template <PacketType Type, typename T>
+        void send(const T &value)
+        {
+            context_->post(loop_, [this, value]()
+                           {
+                               if (!is_connected_)
+                               {
+                                   // 断开期间编码后缓存，重连后发出
+                                   std::vector<uint8_t> data;
+                                   if (Codec<T>::encode(value, data))
+                                   {
+                                       queue_packet(std::make_shared<Packet>(Type, std::move(data)));
+                                   }
+                                   return;
+                               }
+                               session_->send<Type>(value); });
+        }
+
         /**
          * @brief 设置连接回调
          * @param handler 回调函数
@@ -96,6 +170,12 @@ namespace libuv_net
          */
         void set_disconnect_handler(DisconnectHandler handler) { disconnect_handler_ = std::move(handler); }
 
+        /**
+         * @brief 设置连接失败回调，解析失败或所有地址都连接失败时调用
+         * @param handler 回调函数，参数为 libuv 错误码
+         */
+        void set_connect_error_handler(ConnectErrorHandler handler) { connect_error_handler_ = std::move(handler); }
+
         /**
          * @brief 设置消息处理回调
          * @param type 消息类型
@@ -103,7 +183,44 @@ namespace libuv_net
          */
         void set_packet_handler(PacketType type, PacketHandler handler)
         {
-            packet_handlers_[type] = std::move(handler);
+            packet_handlers_.set(type, std::move(handler));
+            codecs_.set_typed_handler(type, false);
+        }
+
+        /**
+         * @brief 设置类型化消息处理回调
+         *
+         * 值类型由处理器的最后一个参数推导，编解码器在编译期确定，
+         * 解码结果缓存在数据包上，每个消息只解码一次，以引用传给处理器，解码失败的消息被丢弃。
+         *
+         * @param handler 形如 void(Session &, const T &) 的回调
+         */
+        template <PacketType Type, typename F>
+        void on(F &&handler)
+        {
+            using T = detail::handler_value_t<F>;
+            static_assert(detail::has_codec<T>::value, "未为该类型特化 libuv_net::Codec");
+            packet_handlers_.set(Type, [this, handler = std::forward<F>(handler)](std::shared_ptr<Packet> packet) mutable
+                                 {
+                auto value = packet->template as<T>();
+                if (!value)
+                {
+                    spdlog::warn("消息解码失败，类型: {}", static_cast<int>(Type));
+                    return;
+                }
+                handler(*session_, *value); });
+            codecs_.set_typed_handler(Type, true);
+        }
+
+        /**
+         * @brief 登记编解码器
+         *
+         * 交给普通处理器的该类型消息先做解码校验，失败的消息被丢弃。
+         */
+        template <PacketType Type, typename T>
+        void register_codec()
+        {
+            codecs_.register_codec<T>(Type);
         }
 
         /**
@@ -115,6 +232,118 @@ namespace libuv_net
             default_packet_handler_ = std::move(handler);
         }
 
+        /**
+         * @brief 设置流式消息分块回调
+         * @param type 消息类型
+         * @param handler 回调函数
+         */
+        void set_chunk_handler(PacketType type, ChunkHandler handler)
+        {
+            chunk_handlers_.set(type, std::move(handler));
+        }
+
+        /**
+         * @brief 设置整帧缓存的最大消息长度
+         * @param size 最大长度，超出的消息在解析消息头时即被拒绝并断开连接
+         */
+        void set_max_frame_size(uint32_t size) { max_frame_size_ = size; }
+
+        /**
+         * @brief 设置流式收发的窗口大小
+         * @param size 窗口大小
+         */
+        void set_stream_window_size(size_t size) { stream_window_size_ = size; }
+
+        /**
+         * @brief 设置套接字选项，在连接建立后应用
+         * @param options 套接字选项
+         */
+        void set_socket_options(const SocketOptions &options) { socket_options_ = options; }
+
+        /**
+         * @brief 启用自动重连
+         *
+         * 连接失败或意外断开后按带随机抖动的指数退避重连，调用 disconnect() 后不再重连。
+         * 断开期间 send() 的消息缓存在按消息数和字节数限制的队列中，超出时丢弃新消息；
+         * 重连成功后在连接回调之前合并为一次写入发出。
+         * replay_sequenced 为 true 时还会重发断开前最近发出的带序列号消息（至少一次，接收方按序列号去重）。
+         *
+         * @param options 退避参数和缓存上限，enabled 为 false 时关闭
+         */
+        void set_reconnect(const ReconnectOptions &options);
+
+        // 断开期间缓存的消息数
+        size_t queued_count();
+
+        /**
+         * @brief 启用持久化日志
+         *
+         * 之后 send_durable() 的消息先追加到内存映射的段文件再发送，服务器需调用 enable_acknowledgements()。
+         * 日志中有上次运行未确认的消息时，连接建立后在其他消息之前重发。
+         *
+         * @param options 日志目录和段文件大小
+         * @return 是否成功打开日志
+         */
+        bool enable_journal(const JournalOptions &options);
+
+        /**
+         * @brief 持久化发送消息到服务器
+         *
+         * 消息追加到日志后立即发送，未连接时留在日志中。服务器确认前断开连接或进程重启，
+         * 消息都会在下一个连接上重发（至少一次，服务器按序列号去重）。
+         * 日志分配的序列号取代消息原有的序列号，消息头带 PACKET_FLAG_DURABLE。
+         * 服务器只确认带该标志的消息，其他带序列号的消息不会截断日志。
+         *
+         * @param packet 要发送的消息
+         */
+        void send_durable(std::shared_ptr<Packet> packet);
+
+        // 日志中未确认的消息数
+        size_t unacknowledged_count();
+
+        /**
+         * @brief 通过 Unix 域套接字连接时提议改用共享内存传输
+         *
+         * 连接建立后发出提议，服务器拒绝时继续使用套接字，对 TCP 连接不生效。
+         *
+         * @param options 环形缓冲区大小和是否轮询
+         */
+        void set_shared_memory(const ShmOptions &options) { shm_options_ = options; }
+
+        /**
+         * @brief 连接建立后请求数据报通道
+         *
+         * 服务器调用了 listen_udp() 时分配令牌，之后 send_unreliable() 经 UDP 发送，
+         * 服务器经 UDP 发来的消息交给与连接相同的处理器。只对 TCP 连接生效。
+         *
+         * @param enabled 是否请求
+         */
+        void enable_datagrams(bool enabled = true) { datagrams_enabled_ = enabled; }
+
+        /**
+         * @brief 以不可靠的方式发送消息
+         *
+         * 数据报通道建立后经 UDP 发送，否则经连接发送，见 Session::send_unreliable()。
+         * @param packet 要发送的消息
+         * @return 是否已提交
+         */
+        bool send_unreliable(std::shared_ptr<Packet> packet);
+
+        // 数据报通道是否已建立
+        bool has_datagram() const { return datagram_ != nullptr; }
+
+        // 地址解析器，可设置缓存时间或替换查询函数
+        Resolver &resolver() { return *resolver_; }
+
+        // 客户端运行时
+        ClientContext &context() { return *context_; }
+
+        // 运行时分配给本客户端的事件循环，连接上的回调都在该循环线程中执行
+        uv_loop_t *loop() const { return loop_; }
+
+        // 运行时的线程池，首次调用时创建
+        ThreadPool &thread_pool() { return context_->thread_pool(); }
+
         /**
          * @brief 添加拦截器
          * @param interceptor 拦截器
@@ -139,46 +368,98 @@ namespace libuv_net
     private:
         // libuv 回调函数
         static void on_connect(uv_connect_t *req, int status);
-        static void on_close(uv_handle_t *handle);
-        static void on_read(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf);
-        static void on_write(uv_write_t *req, int status);
+        static void on_attempt_connect(uv_connect_t *req, int status);
+        static void on_attempt_timer(uv_timer_t *handle);
         static void on_heartbeat_timer(uv_timer_t *handle);
+        static void on_handle_closed(uv_handle_t *handle);
+        static void on_reconnect_timer(uv_timer_t *handle);
 
-        // 内部处理函数
-        bool init_socket();
-        void append_to_buffer(const char *data, size_t len);
-        void start_heartbeat();
-        void stop_heartbeat();
-        void send_heartbeat();
+        Client(std::shared_ptr<ClientContext> context, bool owns_context);
+
+        // 内部处理函数，在事件循环线程中执行
+        bool prepare_connect();
+        bool start_connect(const std::string &host, uint16_t port);
+        bool start_connect_unix(const std::string &path);
+        void close_connection();
+        void handle_connect(int status);
+        // 向下一个地址发起连接尝试
+        void start_next_attempt();
+        // 放弃所有进行中的连接尝试
+        void abort_attempts();
+        // 关闭不再使用的会话，关闭完成前保持存活
+        void discard_session(std::shared_ptr<Session> session);
+        void connect_failed(int status);
+        // 按退避时间安排下一次重连
+        void schedule_reconnect();
+        // 断开期间缓存消息，未启用自动重连时丢弃
+        void queue_packet(std::shared_ptr<Packet> packet);
+        // 重连后发出缓存的消息
+        void flush_replay();
+        // 连接建立后重发日志中未确认的消息
+        void replay_journal();
+        std::shared_ptr<Session> create_session(Transport transport = Transport::TCP);
+        void on_session_closed();
+        void dispatch_packet(std::shared_ptr<Packet> packet);
+        // 服务器答复数据报通道的令牌后创建 UDP 套接字
+        void handle_datagram_bind(const Packet &packet);
+        // 会话、连接尝试和定时器是否都已关闭完成
+        bool is_quiescent() const;
 
         // 成员变量
-        uv_loop_t *loop_;                         // libuv 事件循环
-        uv_tcp_t socket_;                         // TCP 套接字
-        std::unique_ptr<ThreadPool> thread_pool_; // 线程池
-        std::thread loop_thread_;                 // 事件循环线程
-        bool should_stop_{false};                 // 是否应该停止事件循环
+        std::shared_ptr<ClientContext> context_;  // 客户端运行时，最后销毁
+        bool owns_context_;                       // 运行时是否由本客户端独占
+        uv_loop_t *loop_;                         // 运行时分配的事件循环
+        std::shared_ptr<Session> session_;        // 当前连接的会话
+        std::unique_ptr<Resolver> resolver_;      // 地址解析器
+        struct ConnectAttempt;
+        std::vector<std::shared_ptr<Session>> attempts_;         // 进行中的连接尝试
+        std::vector<std::shared_ptr<Session>> closing_sessions_; // 等待关闭完成的会话
+        std::vector<sockaddr_storage> pending_addresses_;        // 尚未尝试的地址
+        uv_timer_t attempt_timer_;                // 并行发起下一个连接尝试的定时器
+        uint64_t connect_generation_{0};          // 每次连接或断开时递增，丢弃过期的解析结果
+        int last_connect_error_{0};               // 最近一个失败的连接尝试的错误码
+        uv_timer_t heartbeat_timer_;              // 心跳定时器
+        uv_timer_t reconnect_timer_;              // 重连定时器
+        int open_handles_{0};                     // 尚未关闭完成的定时器数
 
-        // 状态标志
-        bool is_connected_{false};  // 是否已连接
-        bool is_connecting_{false}; // 是否正在连接
+        // 状态标志，其他线程可以查询
+        std::atomic<bool> is_connected_{false};  // 是否已连接
+        std::atomic<bool> is_connecting_{false}; // 是否正在连接
 
         // 回调函数
         ConnectHandler connect_handler_;                      // 连接回调
         DisconnectHandler disconnect_handler_;                // 断开连接回调
-        std::map<PacketType, PacketHandler> packet_handlers_; // 消息处理回调
+        ConnectErrorHandler connect_error_handler_;           // 连接失败回调
+        DispatchTable<PacketHandler> packet_handlers_;        // 消息处理回调
         PacketHandler default_packet_handler_;                // 默认消息处理回调
+        CodecTable codecs_;                                   // 编解码器登记表
+        DispatchTable<ChunkHandler> chunk_handlers_;          // 流式消息分块回调
 
         // 拦截器管理器
         InterceptorManager interceptor_manager_;
 
-        // 缓冲区
-        std::vector<uint8_t> buffer_; // 接收缓冲区
+        // 帧大小限制
+        uint32_t max_frame_size_{DEFAULT_MAX_FRAME_SIZE};        // 整帧缓存的最大消息长度
+        size_t stream_window_size_{DEFAULT_STREAM_WINDOW_SIZE}; // 流式收发的窗口大小
+        SocketOptions socket_options_;                          // 套接字选项
+        ShmOptions shm_options_;                                // 共享内存传输
+        bool datagrams_enabled_{false};                         // 是否请求数据报通道
+        std::unique_ptr<DatagramSocket> datagram_;              // 数据报通道的 UDP 套接字
+
+        // 自动重连
+        ReconnectOptions reconnect_options_;        // 退避参数和缓存上限
+        bool reconnect_enabled_{false};             // 是否自动重连
+        bool manual_disconnect_{false};             // 调用了 disconnect()，不再重连
+        Backoff backoff_;                           // 重连的退避时间
+        ReplayQueue pending_packets_{0, 0};         // 断开期间缓存的消息
+        size_t dropped_packets_{0};                 // 缓存已满时丢弃的消息数
+        ReplayQueue sent_packets_{0, 0};            // 最近发出的带序列号消息，重连后重发
+        std::string target_host_;                   // 最近一次连接的主机
+        uint16_t target_port_{0};                   // 最近一次连接的端口
+        std::string target_path_;                   // 最近一次连接的 Unix 域套接字路径
 
-        // 心跳相关
-        uv_timer_t heartbeat_timer_;
-        std::chrono::steady_clock::time_point last_heartbeat_time_;
-        static constexpr int HEARTBEAT_INTERVAL_MS = 30000; // 30秒
-        static constexpr int HEARTBEAT_TIMEOUT_MS = 90000;  // 90秒
+        // 持久化日志，未启用时为空
+        std::unique_ptr<Journal> journal_;
     };
 
 } // namespace libuv_net
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <uv.h>
+#include "libuv_net/thread_pool.hpp"
+
+namespace libuv_net
+{
+
+    /**
+     * @brief 客户端运行时，多个 Client 共享的事件循环和线程池
+     *
+     * 持有一个或多个事件循环，每个循环一个线程；Client 构造时按轮询分配一个循环，
+     * 此后连接上的所有 I/O、定时器和回调都在该循环线程中执行。
+     * 大量出站连接只占用连接本身，不再每个连接一个循环线程和一个线程池。
+     *
+     * 其他线程的操作经 post() 投递到循环线程执行；运行时未启动时任务在调用线程中直接执行。
+     * 运行时必须比附加到它的 Client 存活更久，Client 以 shared_ptr 持有运行时。
+     */
+    class ClientContext
+    {
+    public:
+        using Task = std::function<void()>;
+
+        /**
+         * @param loops 事件循环数，至少为 1
+         * @param pool_threads 线程池的线程数，0 表示硬件支持的线程数；线程池首次使用时才创建
+         */
+        explicit ClientContext(size_t loops = 1, size_t pool_threads = 0);
+        ~ClientContext();
+
+        // 禁用拷贝构造和赋值
+        ClientContext(const ClientContext &) = delete;
+        ClientContext &operator=(const ClientContext &) = delete;
+
+        /**
+         * @brief 为每个事件循环启动线程
+         * @return 是否成功启动
+         */
+        bool start();
+
+        /**
+         * @brief 停止所有事件循环线程，执行完已投递的任务后返回
+         */
+        void stop();
+
+        // 事件循环线程是否在运行
+        bool running() const { return running_; }
+
+        // 按轮询分配一个事件循环
+        uv_loop_t *acquire_loop();
+
+        // 事件循环数
+        size_t loop_count() const { return loops_.size(); }
+
+        // 线程池，首次调用时创建
+        ThreadPool &thread_pool() { return thread_pool_.get(); }
+
+        // 设置线程池的线程数，线程池已创建时返回 false
+        bool set_thread_pool_size(size_t threads) { return thread_pool_.set_size(threads); }
+
+        // 使用调用者共享的线程池，线程池已创建时返回 false
+        bool set_thread_pool(std::shared_ptr<ThreadPool> pool) { return thread_pool_.set(std::move(pool)); }
+
+        // 当前线程是否为该事件循环的线程
+        bool in_loop_thread(uv_loop_t *loop) const;
+
+        /**
+         * @brief 在事件循环线程中执行任务
+         *
+         * 当前线程就是循环线程或运行时未启动时直接执行，否则排队后唤醒循环，按投递顺序执行。
+         * 与 stop() 并发时，任务要么在停止前入队、由循环或 stop() 执行，要么在调用线程中直接执行。
+         */
+        template <typename F>
+        void post(uv_loop_t *loop, F &&task)
+        {
+            if (in_loop_thread(loop))
+            {
+                task();
+                return;
+            }
+            Task queued(std::forward<F>(task));
+            if (!enqueue(loop, queued))
+            {
+                queued();
+            }
+        }
+
+        /**
+         * @brief 在事件循环线程中执行任务并等待完成
+         *
+         * 直接执行的条件同 post()。不能在另一个循环线程中等待，否则两个循环可能互相等待。
+         */
+        template <typename F>
+        void run_sync(uv_loop_t *loop, F &&task)
+        {
+            if (in_loop_thread(loop))
+            {
+                task();
+                return;
+            }
+            std::promise<void> done;
+            auto finished = done.get_future();
+            Task queued([&task, &done]()
+                        {
+                            task();
+                            done.set_value(); });
+            if (!enqueue(loop, queued))
+            {
+                task();
+                return;
+            }
+            finished.wait();
+        }
+
+    private:
+        struct Loop;
+
+        static void on_async(uv_async_t *handle);
+        Loop &find(uv_loop_t *loop) const;
+        // 运行时接受投递时移走任务并返回 true，已停止时不动任务并返回 false
+        bool enqueue(uv_loop_t *loop, Task &task);
+
+        std::vector<std::unique_ptr<Loop>> loops_;
+        LazyThreadPool thread_pool_;              // 线程池，首次使用时创建
+        std::atomic<size_t> next_loop_{0};        // 下一个分配的事件循环
+        std::atomic<bool> running_{false};        // 事件循环线程是否在运行
+        std::atomic<bool> should_stop_{false};    // 是否应该停止事件循环
+        std::mutex state_mutex_;                  // 串行化 start() 和 stop()
+    };
+
+} // namespace libuv_net
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <uv.h>
+#include "libuv_net/client.hpp"
+#include "libuv_net/client_context.hpp"
+
+namespace libuv_net
+{
+    // 往返时间的指数加权平均中新样本的权重
+    constexpr double POOL_RTT_EWMA_WEIGHT = 0.2;
+
+    // 集群中的一个服务器地址
+    struct Endpoint
+    {
+        std::string host;
+        uint16_t port;
+    };
+
+    // 选择连接的策略
+    enum class BalancePolicy
+    {
+        LEAST_OUTSTANDING,    // 未答复请求最少的连接，相同时选往返时间短的
+        POWER_OF_TWO_CHOICES, // 随机取两个连接，选预计等待时间较短的，见 ClientPool
+    };
+
+    // 连接池的配置
+    struct ClientPoolOptions
+    {
+        size_t connections_per_endpoint = 2;                // 每个端点参与选择的连接数
+        size_t warm_spares = 1;                             // 每个端点额外保持的备用连接，活跃连接断开时顶替
+        BalancePolicy policy = BalancePolicy::LEAST_OUTSTANDING;      // 连接很多时两选一的开销更小
+        uint32_t eject_after_failures = 3;                  // failure_window 内连接失败或断开多少次后摘除端点
+        std::chrono::milliseconds failure_window{10000};    // 统计失败次数的时间窗口
+        std::chrono::milliseconds eject_duration{5000};     // 端点被摘除的时长，之后重新尝试连接
+        std::chrono::milliseconds reconnect_interval{1000}; // 检查并重连断开连接的间隔
+    };
+
+    // 一个端点的统计
+    struct EndpointStats
+    {
+        Endpoint endpoint;
+        size_t connected;   // 已连接的连接数（含备用连接）
+        size_t outstanding; // 未答复的请求数
+        double rtt_us;      // 各连接往返时间的平均值，尚无样本时为 0
+        uint64_t sent;      // 经该端点发出的请求数
+        bool ejected;       // 是否被摘除
+    };
+
+    /**
+     * @brief 客户端连接池，在一组相同的服务器之间分配请求
+     *
+     * 每个端点保持 connections_per_endpoint 个活跃连接和 warm_spares 个备用连接，
+     * 所有连接附加到同一个 ClientContext。每次发送按策略选择一个活跃连接，
+     * 依据是未答复的请求数和往返时间的指数加权平均。同一端点的连接在服务器上共用一个队列，
+     * 往返时间除以发送时端点上未答复的请求数得到每个请求占用的时间，
+     * 乘以端点当前的未答复请求数即为两选一策略中的预计等待时间。
+     *
+     * 往返时间按“服务器对每个请求按顺序答复一个消息”的模式测量：连接上收到的每个消息
+     * 对应最早一个未答复的请求。服务器主动推送的消息会使统计偏小，但不影响收发。
+     *
+     * failure_window 内连接失败或断开 eject_after_failures 次的端点被摘除 eject_duration，
+     * 期间不参与选择也不重连。连接成功不清零计数，连上即断的端点也会被摘除。
+     * 断开的连接上未答复的请求不会重发。
+     *
+     * send() 可以在任意线程调用，但不能与 stop() 并发；处理器在连接所在的事件循环线程中执行。
+     */
+    class ClientPool
+    {
+    public:
+        using PacketHandler = Client::PacketHandler;
+
+        /**
+         * @param options 连接池配置
+         * @param context 客户端运行时，为空时创建一个单循环的运行时，由连接池启停
+         */
+        explicit ClientPool(const ClientPoolOptions &options = ClientPoolOptions(),
+                            std::shared_ptr<ClientContext> context = nullptr);
+        ~ClientPool();
+
+        // 禁用拷贝构造和赋值
+        ClientPool(const ClientPool &) = delete;
+        ClientPool &operator=(const ClientPool &) = delete;
+
+        /**
+         * @brief 设置消息处理回调，应在 start() 之前调用
+         * @param type 消息类型
+         * @param handler 回调函数
+         */
+        void set_packet_handler(PacketType type, PacketHandler handler)
+        {
+            handlers_.emplace_back(type, std::move(handler));
+        }
+
+        /**
+         * @brief 设置默认消息处理回调，应在 start() 之前调用
+         * @param handler 回调函数
+         */
+        void set_default_packet_handler(PacketHandler handler) { default_handler_ = std::move(handler); }
+
+        /**
+         * @brief 创建到所有端点的连接
+         * @param endpoints 服务器地址
+         * @return 是否成功启动
+         */
+        bool start(const std::vector<Endpoint> &endpoints);
+
+        /**
+         * @brief 关闭所有连接
+         */
+        void stop();
+
+        /**
+         * @brief 选择一个连接发送消息
+         * @param packet 要发送的消息
+         * @return 是否有可用的连接
+         */
+        bool send(std::shared_ptr<Packet> packet);
+
+        // 参与选择的已连接连接数
+        size_t active_count() const;
+
+        // 各端点的统计
+        std::vector<EndpointStats> stats() const;
+
+    private:
+        struct Connection;
+        struct EndpointState;
+
+        static void on_maintain_timer(uv_timer_t *handle);
+
+        // 以下函数在持有 mutex_ 时调用
+        Connection *select(std::chrono::steady_clock::time_point now);
+        Connection *least_outstanding(const std::vector<Connection *> &candidates) const;
+        Connection *power_of_two_choices(const std::vector<Connection *> &candidates);
+        // 活跃连接不足时用已连接的备用连接顶替断开的活跃连接
+        void promote_spares(size_t endpoint);
+        void record_failure(EndpointState &endpoint);
+
+        void on_connected(Connection *connection);
+        void on_disconnected(Connection *connection);
+        void on_connect_error(Connection *connection);
+        void on_reply(Connection *connection);
+        // 为断开的连接发起重连，连接在各自的事件循环中异步发起，不等待
+        void maintain();
+        // 在连接所在的事件循环线程中发起连接
+        void start_connect(Connection *connection, uint64_t generation, const Endpoint &endpoint);
+
+        bool owns_context_;                      // 运行时是否由连接池创建
+        std::shared_ptr<ClientContext> context_; // 客户端运行时，最后销毁
+        uv_loop_t *loop_;                        // 重连定时器所在的事件循环
+        uv_timer_t maintain_timer_;              // 重连定时器
+        std::atomic<bool> timer_closed_{false};  // 重连定时器是否已关闭完成
+        ClientPoolOptions options_;
+
+        std::vector<std::pair<PacketType, PacketHandler>> handlers_; // 消息处理回调
+        PacketHandler default_handler_;                              // 默认消息处理回调
+
+        mutable std::mutex mutex_;                          // 保护以下成员
+        bool running_{false};                               // 是否已启动
+        uint64_t generation_{0};                            // 每次 start() 递增，过期的连接任务据此放弃
+        std::vector<std::unique_ptr<EndpointState>> endpoints_;
+        std::vector<std::unique_ptr<Connection>> connections_;
+        std::vector<Connection *> candidates_;              // 选择连接时的候选，复用以免每次分配
+        std::mt19937 random_{std::random_device{}()};       // 两选一策略的随机数
+    };
+
+} // namespace libuv_net
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <type_traits>
+#include "libuv_net/message.hpp"
+
+namespace libuv_net
+{
+    /*
+     * 编解码器 Codec<T>（主模板声明在 message.hpp 中）
+     *
+     * 按值类型特化，在编译期解析，不经过 std::any，不依赖 RTTI。特化需提供：
+     * - static bool encode(const T &value, std::vector<uint8_t> &out);
+     * - static bool decode(const uint8_t *data, size_t size, T &value) noexcept;
+     *
+     * 解码失败返回 false 而不是抛出异常。
+     *
+     * 能预先算出编码长度的编解码器还可以提供以下两个函数，发送时直接编码进
+     * 已预留消息头的帧缓冲区，省去中间缓冲区和一次拷贝：
+     * - static size_t encoded_size(const T &value);
+     * - static bool encode_to(const T &value, uint8_t *out, size_t size);
+     */
+
+    // 文本编解码器
+    template <>
+    struct Codec<std::string>
+    {
+        static bool encode(const std::string &value, std::vector<uint8_t> &out)
+        {
+            out.assign(value.begin(), value.end());
+            return true;
+        }
+
+        static bool decode(const uint8_t *data, size_t size, std::string &value) noexcept
+        {
+            value.assign(reinterpret_cast<const char *>(data), size);
+            return true;
+        }
+    };
+
+    // 二进制编解码器
+    template <>
+    struct Codec<std::vector<uint8_t>>
+    {
+        static bool encode(const std::vector<uint8_t> &value, std::vector<uint8_t> &out)
+        {
+            out = value;
+            return true;
+        }
+
+        static bool decode(const uint8_t *data, size_t size, std::vector<uint8_t> &value) noexcept
+        {
+            value.assign(data, data + size);
+            return true;
+        }
+    };
+
+    namespace detail
+    {
+        template <typename T, typename = void>
+        struct has_sized_encode : std::false_type
+        {
+        };
+
+        template <typename T>
+        struct has_sized_encode<T, std::void_t<decltype(Codec<T>::encoded_size(std::declval<const T &>())),
+                                               decltype(Codec<T>::encode_to(std::declval<const T &>(),
+                                                                            std::declval<uint8_t *>(), size_t{}))>>
+            : std::true_type
+        {
+        };
+
+        template <typename... Args>
+        struct last_arg;
+
+        template <typename Arg>
+        struct last_arg<Arg>
+        {
+            using type = Arg;
+        };
+
+        template <typename First, typename... Rest>
+        struct last_arg<First, Rest...> : last_arg<Rest...>
+        {
+        };
+
+        // 从处理器签名中取出最后一个参数的值类型
+        template <typename F>
+        struct handler_traits : handler_traits<decltype(&F::operator())>
+        {
+        };
+
+        template <typename R, typename... Args>
+        struct handler_traits<R (*)(Args...)>
+        {
+            using value_type = std::decay_t<typename last_arg<Args...>::type>;
+        };
+
+        template <typename C, typename R, typename... Args>
+        struct handler_traits<R (C::*)(Args...)> : handler_traits<R (*)(Args...)>
+        {
+        };
+
+        template <typename C, typename R, typename... Args>
+        struct handler_traits<R (C::*)(Args...) const> : handler_traits<R (*)(Args...)>
+        {
+        };
+
+        template <typename F>
+        using handler_value_t = typename handler_traits<std::decay_t<F>>::value_type;
+
+        // 校验能否解码，结果缓存在数据包上，处理器再取用时不会重复解析
+        template <typename T>
+        bool validate_packet(const Packet &packet)
+        {
+            return packet.as<T>() != nullptr;
+        }
+    } // namespace detail
+
+    /**
+     * @brief 消息类型到编解码器的登记表
+     *
+     * register_codec 登记的类型在交给普通处理器之前先做解码校验，失败的消息被丢弃；
+     * 类型化处理器自己解码，这里不再重复解码。
+     */
+    class CodecTable
+    {
+    public:
+        using Validator = bool (*)(const Packet &);
+
+        // 登记编解码器
+        template <typename T>
+        void register_codec(PacketType type)
+        {
+            static_assert(detail::has_codec<T>::value, "未为该类型特化 libuv_net::Codec");
+            slot(type).validate = &detail::validate_packet<T>;
+        }
+
+        // 标记该类型的处理器是否为类型化处理器
+        void set_typed_handler(PacketType type, bool typed)
+        {
+            if (typed || slots_.contains(type))
+            {
+                slot(type).typed_handler = typed;
+            }
+        }
+
+        // 消息是否可以交给处理器
+        bool accepts(const Packet &packet) const
+        {
+            auto entry = slots_.find(packet.type());
+            if (!entry || !entry->validate || entry->typed_handler)
+            {
+                return true;
+            }
+            return entry->validate(packet);
+        }
+
+    private:
+        struct Slot
+        {
+            Validator validate = nullptr;
+            bool typed_handler = false;
+        };
+
+        Slot &slot(PacketType type)
+        {
+            if (!slots_.contains(type))
+            {
+                slots_.set(type, Slot{});
+            }
+            return *slots_.find(type);
+        }
+
+        DispatchTable<Slot> slots_;
+    };
+
+} // namespace libuv_net
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <uv.h>
+#include "libuv_net/message.hpp"
+
+namespace libuv_net
+{
+    // 合并多个消息时数据报的最大长度，不超过 IPv6 的最小 MTU，避免 IP 分片
+    constexpr size_t DATAGRAM_BATCH_SIZE = 1200;
+    // 单个数据报的最大长度（UDP 负载的上限）
+    constexpr size_t DATAGRAM_MAX_SIZE = 65507;
+    // 数据报开头的连接令牌长度
+    constexpr size_t DATAGRAM_TOKEN_SIZE = sizeof(uint64_t);
+    // 令牌之后的发送计数长度
+    constexpr size_t DATAGRAM_COUNTER_SIZE = sizeof(uint64_t);
+    // 数据报末尾的认证标签长度
+    constexpr size_t DATAGRAM_TAG_SIZE = sizeof(uint64_t);
+    // 消息帧之外的固定开销
+    constexpr size_t DATAGRAM_OVERHEAD = DATAGRAM_TOKEN_SIZE + DATAGRAM_COUNTER_SIZE + DATAGRAM_TAG_SIZE;
+
+    // 数据报的认证密钥，经可靠连接下发，不出现在数据报中
+    using DatagramKey = std::array<uint8_t, 16>;
+
+    // 数据报通道协商的答复：连接令牌、服务器的 UDP 端口和认证密钥；请求的消息体为空，服务器拒绝时答复的消息体也为空
+    constexpr size_t DATAGRAM_BIND_SIZE = sizeof(uint64_t) + sizeof(uint16_t) + sizeof(DatagramKey);
+
+    inline std::vector<uint8_t> encode_datagram_bind(uint64_t token, uint16_t port, const DatagramKey &key)
+    {
+        std::vector<uint8_t> payload(DATAGRAM_BIND_SIZE);
+        std::memcpy(payload.data(), &token, sizeof(token));
+        std::memcpy(payload.data() + sizeof(token), &port, sizeof(port));
+        std::memcpy(payload.data() + sizeof(token) + sizeof(port), key.data(), key.size());
+        return payload;
+    }
+
+    inline bool decode_datagram_bind(const std::vector<uint8_t> &payload, uint64_t &token, uint16_t &port,
+                                     DatagramKey &key)
+    {
+        if (payload.size() != DATAGRAM_BIND_SIZE)
+        {
+            return false;
+        }
+        std::memcpy(&token, payload.data(), sizeof(token));
+        std::memcpy(&port, payload.data() + sizeof(token), sizeof(port));
+        std::memcpy(key.data(), payload.data() + sizeof(token) + sizeof(port), key.size());
+        return token != 0;
+    }
+
+    // 用 SipHash-2-4 计算数据的认证标签
+    uint64_t datagram_tag(const DatagramKey &key, const uint8_t *data, size_t size);
+
+    /**
+     * @brief UDP 数据报套接字
+     *
+     * 每个数据报以 8 字节的连接令牌开头，令牌在可靠连接上协商，标识数据报所属的会话；
+     * 之后是 8 字节的发送计数和一个或多个完整的消息帧（消息头 + 消息体），与流上的帧格式相同；
+     * 末尾是用该令牌的密钥对之前所有字节计算的 8 字节认证标签。
+     *
+     * 令牌和密钥由 add_token() 登记。未登记的令牌和标签不符的数据报在交给回调之前丢弃，
+     * 只看到 UDP 流量、没有看到连接内容的第三方无法伪造数据报。发送计数每个数据报递增，
+     * 重放的数据报标签仍然有效，由接收方按计数判断是否为新数据报。
+     *
+     * 同一事件循环迭代中发往同一令牌的消息合并到一个数据报中，在迭代末尾（轮询 I/O 之前）
+     * 用 uv_udp_try_send 直接发出；内核缓冲区已满时改用 uv_udp_send 排队，由 libuv 批量写出。
+     * 发送失败的数据报直接丢弃，不重传。
+     *
+     * 只能在事件循环线程中使用。句柄在关闭回调中释放，对象可以在 close() 之后立即销毁。
+     */
+    class DatagramSocket
+    {
+    public:
+        // 收到已认证的数据报的回调，counter 为对端的发送计数，data 为计数与标签之间的消息帧
+        using ReceiveHandler = std::function<void(const sockaddr *addr, uint64_t token, uint64_t counter,
+                                                  const uint8_t *data, size_t size)>;
+
+        explicit DatagramSocket(uv_loop_t *loop);
+        ~DatagramSocket();
+
+        // 禁用拷贝构造和赋值
+        DatagramSocket(const DatagramSocket &) = delete;
+        DatagramSocket &operator=(const DatagramSocket &) = delete;
+
+        // 绑定本地地址
+        int bind(const sockaddr *addr);
+
+        // 连接对端地址，之后发送时目的地址传空指针，只接收来自该地址的数据报
+        int connect(const sockaddr *addr);
+
+        // 开始接收数据报
+        int start(ReceiveHandler handler);
+
+        // 登记令牌及其认证密钥，之后才能收发该令牌的数据报
+        void add_token(uint64_t token, const DatagramKey &key);
+
+        // 注销令牌，丢弃本轮尚未发出的数据报
+        void remove_token(uint64_t token);
+
+        /**
+         * @brief 发送一个消息，追加到本轮发往该令牌的数据报中
+         *
+         * @param addr 目的地址，已连接时传空指针
+         * @param token 连接令牌
+         * @param type 消息类型
+         * @param sequence 序列号
+         * @param data 消息体
+         * @param size 消息体长度
+         * @return 令牌已登记且消息放得进一个数据报
+         */
+        bool send(const sockaddr *addr, uint64_t token, PacketType type, uint32_t sequence,
+                  const uint8_t *data, size_t size);
+
+        // 发送只有令牌的数据报，让对端记录本端的地址
+        void send_token(const sockaddr *addr, uint64_t token);
+
+        // 立即发出本轮合并的所有数据报
+        void flush();
+
+        // 关闭句柄，排队中的数据报被丢弃
+        void close();
+
+        // 本地端口，未绑定时为 0
+        int local_port() const;
+
+        // 是否已连接对端
+        bool connected() const { return connected_; }
+
+    private:
+        // 本轮发往一个令牌的数据报
+        struct Batch
+        {
+            sockaddr_storage addr;
+            bool has_addr;
+            std::vector<uint8_t> data;
+        };
+
+        // 一个令牌的认证密钥和发送计数
+        struct Endpoint
+        {
+            DatagramKey key;
+            uint64_t sent = 0;
+        };
+
+        static void on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf);
+        static void on_recv(uv_udp_t *handle, ssize_t nread, const uv_buf_t *buf, const sockaddr *addr, unsigned flags);
+        static void on_prepare(uv_prepare_t *handle);
+
+        // 取得发往该令牌的数据报，再追加 size 字节放不下时先发出已有的部分
+        Batch &batch_for(const sockaddr *addr, uint64_t token, size_t size);
+        // 写入发送计数、追加认证标签后发出
+        void send_datagram(uint64_t token, Batch &batch);
+
+        uv_udp_t *udp_;         // UDP 句柄，关闭回调中释放
+        uv_prepare_t *prepare_; // 在轮询 I/O 之前发出本轮合并的数据报，关闭回调中释放
+        bool connected_ = false;
+        ReceiveHandler handler_;
+        std::unordered_map<uint64_t, Batch> batches_;      // 按令牌合并的数据报
+        std::unordered_map<uint64_t, Endpoint> endpoints_; // 已登记的令牌
+    };
+
+} // namespace libuv_net
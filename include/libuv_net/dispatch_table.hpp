@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace libuv_net
+{
+    enum class PacketType : uint8_t;
+
+    /**
+     * @brief 按消息类型索引的稠密分发表
+     *
+     * PacketType 为 uint8_t，用 256 项的槽位数组直接索引到处理器，
+     * 查找只需两次数组访问，不做比较、哈希，也不拷贝 shared_ptr。
+     * 处理器本身存放在紧凑的 vector 中，槽位数组只占 512 字节，
+     * 未注册的类型不占用处理器的存储空间。
+     */
+    template <typename Handler>
+    class DispatchTable
+    {
+    public:
+        // 设置处理器，已存在时覆盖
+        void set(PacketType type, Handler handler)
+        {
+            auto &slot = slots_[index(type)];
+            if (slot == 0)
+            {
+                handlers_.push_back(std::move(handler));
+                slot = static_cast<uint16_t>(handlers_.size());
+            }
+            else
+            {
+                handlers_[slot - 1] = std::move(handler);
+            }
+        }
+
+        // 查找处理器，未注册时返回 nullptr
+        const Handler *find(PacketType type) const
+        {
+            uint16_t slot = slots_[index(type)];
+            return slot != 0 ? &handlers_[slot - 1] : nullptr;
+        }
+
+        Handler *find(PacketType type)
+        {
+            uint16_t slot = slots_[index(type)];
+            return slot != 0 ? &handlers_[slot - 1] : nullptr;
+        }
+
+        // 是否注册了该类型
+        bool contains(PacketType type) const { return slots_[index(type)] != 0; }
+
+        // 是否为空
+        bool empty() const { return handlers_.empty(); }
+
+        // 遍历已注册的处理器
+        template <typename F>
+        void for_each(F &&f) const
+        {
+            for (std::size_t i = 0; i < slots_.size(); ++i)
+            {
+                if (slots_[i] != 0)
+                {
+                    f(static_cast<PacketType>(i), handlers_[slots_[i] - 1]);
+                }
+            }
+        }
+
+    private:
+        static std::size_t index(PacketType type) { return static_cast<uint8_t>(type); }
+
+        std::array<uint16_t, 256> slots_{}; // 类型到处理器的槽位（0 表示未注册）
+        std::vector<Handler> handlers_;     // 已注册的处理器
+    };
+
+} // namespace libuv_net
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace libuv_net
+{
+    /**
+     * @brief 发送帧缓冲区池
+     *
+     * 写入完成的帧缓冲区归还到池中，下次发送时复用已有容量，稳态下发送不再分配内存。
+     * 每个线程一个池，只缓存有限数量、有限大小的缓冲区，避免长期占用大块内存。
+     *
+     * 写请求记下帧取自哪个池，完成后归还到原来的池：在用户线程取出、在事件循环线程写完的帧
+     * 回到用户线程的池，不会让一个池只出不进而另一个池只进不出。归还可能来自其他线程，因此加锁。
+     */
+    class FramePool
+    {
+    public:
+        static constexpr size_t MAX_CACHED_FRAMES = 64;          // 最多缓存的缓冲区数量
+        static constexpr size_t MAX_CACHED_CAPACITY = 1024 * 1024; // 可缓存的最大容量
+
+        // 获取大小为 size 的缓冲区
+        std::vector<uint8_t> acquire(size_t size)
+        {
+            std::vector<uint8_t> frame;
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!frames_.empty())
+            {
+                frame = std::move(frames_.back());
+                frames_.pop_back();
+            }
+            frame.resize(size);
+            return frame;
+        }
+
+        // 归还缓冲区
+        void release(std::vector<uint8_t> frame)
+        {
+            if (frame.capacity() == 0 || frame.capacity() > MAX_CACHED_CAPACITY)
+            {
+                return;
+            }
+            frame.clear();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (frames_.size() < MAX_CACHED_FRAMES)
+            {
+                frames_.push_back(std::move(frame));
+            }
+        }
+
+        // 当前线程的池，线程退出后由尚未归还的帧继续持有
+        static const std::shared_ptr<FramePool> &local()
+        {
+            thread_local std::shared_ptr<FramePool> pool = std::make_shared<FramePool>();
+            return pool;
+        }
+
+        // 缓存的缓冲区数量
+        size_t cached() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return frames_.size();
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::vector<std::vector<uint8_t>> frames_;
+    };
+
+} // namespace libuv_net
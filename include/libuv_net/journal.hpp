@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <uv.h>
+#include "libuv_net/message.hpp"
+
+namespace libuv_net
+{
+    // 日志的配置
+    struct JournalOptions
+    {
+        std::string directory;                  // 段文件所在的目录，不存在时创建
+        size_t segment_size = 16 * 1024 * 1024; // 每个段文件预分配的大小，单条记录不能超过该大小
+    };
+
+    // 段文件中每条记录的头部：帧长度和校验和
+    constexpr size_t JOURNAL_RECORD_HEADER = 2 * sizeof(uint32_t);
+
+    /**
+     * @brief 出站消息的预写日志，保存在内存映射的段文件中
+     *
+     * 每个段文件创建时按 segment_size 预分配并以 MAP_SHARED 映射，append() 只把帧拷贝进映射区，
+     * 不做系统调用；写满后换到新的段文件。映射区的内容在进程崩溃后仍由内核写回，
+     * 断电后的持久性由组提交保证：有新数据时在 libuv 的线程池中对脏页执行一次 msync，
+     * 提交进行期间追加的记录合并到下一次提交，每次 msync 覆盖一批消息而不是每个消息一次。
+     *
+     * 日志为每个消息分配序列号（写在帧的消息头中，跳过 0），对端按序列号累计确认，
+     * acknowledge() 之后全部记录都已确认的段文件被删除，确认位置保存在 ack 文件中。
+     * 打开时扫描已有的段文件，校验每条记录的校验和与序列号，丢弃末尾写了一半的记录，
+     * 未确认的消息可以经 for_each_pending() 重发到新的连接。
+     *
+     * 只能在事件循环线程中使用。Windows 上 open() 返回空指针。
+     */
+    class Journal
+    {
+    public:
+        // 提交完成的回调，参数为已写入磁盘的最大序列号
+        using DurableHandler = std::function<void(uint32_t sequence)>;
+
+        ~Journal();
+
+        // 禁用拷贝构造和赋值
+        Journal(const Journal &) = delete;
+        Journal &operator=(const Journal &) = delete;
+
+        /**
+         * @brief 打开日志目录并恢复未确认的消息
+         * @param loop 执行提交回调的事件循环
+         * @param options 日志配置
+         * @return 日志对象，失败时为空
+         */
+        static std::unique_ptr<Journal> open(uv_loop_t *loop, const JournalOptions &options);
+
+        /**
+         * @brief 追加一个消息并安排组提交
+         * @return 分配的序列号，写入失败时为 0
+         */
+        uint32_t append(PacketType type, const uint8_t *data, size_t size);
+
+        /**
+         * @brief 对端确认 sequence 及之前的消息，删除全部已确认的段文件
+         * @param sequence 对端收到的最大序列号，按差值的符号比较，可以回绕
+         */
+        void acknowledge(uint32_t sequence);
+
+        /**
+         * @brief 按顺序访问未确认的消息
+         * @param f 形如 void(const uint8_t *frame, size_t size) 的回调，frame 为完整的消息帧
+         */
+        template <typename F>
+        void for_each_pending(F &&f) const
+        {
+            for (const auto &entry : pending_)
+            {
+                f(entry.frame, entry.size);
+            }
+        }
+
+        /**
+         * @brief 同步写入所有脏页，阻塞调用线程
+         * @return 是否成功
+         */
+        bool sync();
+
+        // 设置提交完成的回调
+        void set_durable_handler(DurableHandler handler) { durable_handler_ = std::move(handler); }
+
+        // 未确认的消息数
+        size_t pending_count() const { return pending_.size(); }
+
+        // 未确认消息的总字节数
+        size_t pending_bytes() const { return pending_bytes_; }
+
+        // 最近分配的序列号
+        uint32_t last_sequence() const { return static_cast<uint32_t>(last_index_); }
+
+        // 已写入磁盘的最大序列号
+        uint32_t durable_sequence() const { return static_cast<uint32_t>(durable_index_); }
+
+        // 段文件数
+        size_t segment_count() const { return segments_.size(); }
+
+        // 是否没有进行中的提交
+        bool idle() const { return commit_ == nullptr; }
+
+    private:
+        struct Segment;
+        struct Commit;
+
+        // 未确认的记录，frame 指向段文件的映射区
+        struct Entry
+        {
+            uint64_t index;
+            const uint8_t *frame;
+            size_t size;
+        };
+
+        Journal() = default;
+
+        static void on_commit(uv_work_t *req);
+        static void on_commit_done(uv_work_t *req, int status);
+        // 打开并映射文件，文件小于 size 时预分配到 size
+        static std::shared_ptr<Segment> map_file(const std::string &path, size_t size, int flags);
+
+        // 扫描一个段文件中的记录，丢弃校验失败的记录及之后的内容
+        void recover(const std::shared_ptr<Segment> &segment);
+        // 删除全部记录都已确认的段文件，保留最后一个
+        void release_segments();
+        // 创建以 first_index 开头的新段文件
+        bool roll(uint64_t first_index);
+        // 有未写入磁盘的数据且没有进行中的提交时发起提交
+        void schedule_commit();
+        bool dirty() const;
+
+        uv_loop_t *loop_ = nullptr;
+        JournalOptions options_;
+        int directory_fd_ = -1;                        // 目录的描述符，新建段文件后同步目录项
+        bool directory_dirty_ = false;                 // 新建了段文件，下一次提交同步目录
+        std::shared_ptr<Segment> ack_file_;            // ack 文件的映射区：魔数和已确认的位置
+        bool ack_dirty_ = false;                       // 确认位置尚未写入磁盘
+        std::deque<std::shared_ptr<Segment>> segments_; // 按序列号排列的段文件，最后一个用于追加
+        std::deque<Entry> pending_;                    // 未确认的记录
+        size_t pending_bytes_ = 0;
+        uint64_t last_index_ = 0;                      // 最近分配的位置，低 32 位是序列号
+        uint64_t durable_index_ = 0;                   // 已写入磁盘的位置
+        uint64_t acked_index_ = 0;                     // 已确认的位置
+        Commit *commit_ = nullptr;                     // 进行中的提交
+        DurableHandler durable_handler_;
+    };
+
+} // namespace libuv_net
@@ -1,58 +1,150 @@
 #pragma once
 
 #include "libuv_net/message.hpp"
+#include "libuv_net/codec.hpp"
 #include <nlohmann/json.hpp>
 
 namespace libuv_net
 {
+    /**
+     * @brief JSON 在线路上的编码方式
+     *
+     * 文本 JSON 原样发送；二进制编码在消息体前加一个字节的子类型标识。
+     * 合法的文本 JSON 不会以 0x01~0x03 开头，因此接收端无需协商即可识别，
+     * 旧版本只发送文本 JSON 的对端保持兼容。
+     */
+    enum class JsonEncoding : uint8_t
+    {
+        TEXT = 0,    // 文本 JSON
+        CBOR = 1,    // CBOR
+        MSGPACK = 2, // MessagePack
+        UBJSON = 3   // UBJSON
+    };
+
+    namespace json_codec
+    {
+        // 按指定编码追加写入 out；文本 JSON 中含无效的 UTF-8 时抛出 nlohmann::json::type_error
+        inline void encode(const nlohmann::json &value, JsonEncoding encoding, std::vector<uint8_t> &out)
+        {
+            switch (encoding)
+            {
+            case JsonEncoding::CBOR:
+                out.push_back(static_cast<uint8_t>(encoding));
+                nlohmann::json::to_cbor(value, out);
+                break;
+            case JsonEncoding::MSGPACK:
+                out.push_back(static_cast<uint8_t>(encoding));
+                nlohmann::json::to_msgpack(value, out);
+                break;
+            case JsonEncoding::UBJSON:
+                out.push_back(static_cast<uint8_t>(encoding));
+                nlohmann::json::to_ubjson(value, out);
+                break;
+            case JsonEncoding::TEXT:
+            default:
+            {
+                // nlohmann 没有公开的写入任意缓冲区的接口，经 std::ostream 直接写入 vector 时每个字符都要构造 sentry，
+                // 实测比 dump() 后拷贝慢约 25%（见 bench/json_bench.cpp），因此保留中间字符串
+                std::string text = value.dump();
+                out.insert(out.end(), text.begin(), text.end());
+                break;
+            }
+            }
+        }
+
+        // 识别编码并直接从消息体解析，失败时返回 false 而不抛出异常
+        inline bool decode(const uint8_t *data, size_t size, nlohmann::json &value) noexcept
+        {
+            if (size > 0 && data[0] >= static_cast<uint8_t>(JsonEncoding::CBOR) &&
+                data[0] <= static_cast<uint8_t>(JsonEncoding::UBJSON))
+            {
+                auto encoding = static_cast<JsonEncoding>(data[0]);
+                const uint8_t *begin = data + 1;
+                const uint8_t *end = data + size;
+                if (encoding == JsonEncoding::CBOR)
+                {
+                    value = nlohmann::json::from_cbor(begin, end, true, false);
+                }
+                else if (encoding == JsonEncoding::MSGPACK)
+                {
+                    value = nlohmann::json::from_msgpack(begin, end, true, false);
+                }
+                else
+                {
+                    value = nlohmann::json::from_ubjson(begin, end, true, false);
+                }
+            }
+            else
+            {
+                value = nlohmann::json::parse(data, data + size, nullptr, false);
+            }
+            return !value.is_discarded();
+        }
+    } // namespace json_codec
+
+    // JSON 编解码器，供类型化处理器使用：发送文本 JSON，接收时识别所有编码
+    template <>
+    struct Codec<nlohmann::json>
+    {
+        static bool encode(const nlohmann::json &value, std::vector<uint8_t> &out)
+        {
+            out.clear();
+            try
+            {
+                json_codec::encode(value, JsonEncoding::TEXT, out);
+            }
+            catch (const nlohmann::json::type_error &)
+            {
+                // 字符串中含无效的 UTF-8
+                return false;
+            }
+            return true;
+        }
+
+        static bool decode(const uint8_t *data, size_t size, nlohmann::json &value) noexcept
+        {
+            return json_codec::decode(data, size, value);
+        }
+    };
+
     /**
      * @brief JSON拦截器
      *
-     * 用于处理JSON格式的消息
+     * 用于处理JSON格式的消息。发送时使用构造时指定的编码，
+     * 接收时根据子类型标识识别文本、CBOR、MessagePack 和 UBJSON。
      */
     class JsonInterceptor : public Interceptor
     {
     public:
         // 构造函数
-        JsonInterceptor() = default;
+        explicit JsonInterceptor(JsonEncoding encoding = JsonEncoding::TEXT) : encoding_(encoding) {}
 
         // 序列化数据
         std::vector<uint8_t> serialize(const std::any &data) override
         {
-            try
-            {
-                // 获取JSON对象
-                const auto &json = std::any_cast<nlohmann::json>(data);
-
-                // 转换为字符串
-                std::string json_str = json.dump();
-
-                // 转换为字节向量
-                return std::vector<uint8_t>(json_str.begin(), json_str.end());
-            }
-            catch (const std::bad_any_cast &)
+            // 获取JSON对象（按指针取出，不拷贝）
+            const auto *json = std::any_cast<nlohmann::json>(&data);
+            if (!json)
             {
                 return std::vector<uint8_t>();
             }
+
+            // 直接写入字节向量
+            std::vector<uint8_t> result;
+            json_codec::encode(*json, encoding_, result);
+            return result;
         }
 
         // 反序列化数据
         std::any deserialize(const std::vector<uint8_t> &data) override
         {
-            try
-            {
-                // 转换为字符串
-                std::string json_str(data.begin(), data.end());
-
-                // 解析JSON
-                auto json = nlohmann::json::parse(json_str);
-
-                return json;
-            }
-            catch (const nlohmann::json::parse_error &)
+            // 直接从消息体解析
+            nlohmann::json json;
+            if (!json_codec::decode(data.data(), data.size(), json))
             {
                 return std::any();
             }
+            return std::any(std::move(json));
         }
 
         // 获取支持的消息类型
@@ -60,6 +152,12 @@ namespace libuv_net
         {
             return PacketType::JSON;
         }
+
+        // 获取发送使用的编码
+        JsonEncoding encoding() const { return encoding_; }
+
+    private:
+        JsonEncoding encoding_;
     };
 
-} // namespace libuv_net
\ No newline at end of file
+} // namespace libuv_net
@@ -2,11 +2,13 @@
 
 #include <vector>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <functional>
 #include <string>
 #include <any>
-#include <map>
+#include <type_traits>
+#include "libuv_net/dispatch_table.hpp"
 
 namespace libuv_net
 {
@@ -16,28 +18,85 @@ namespace libuv_net
     // 消息类型枚举
     enum class PacketType : uint8_t
     {
-        TEXT = 0,      // 文本消息
-        BINARY = 1,    // 二进制消息
-        PING = 2,      // 心跳请求
-        PONG = 3,      // 心跳响应
-        HEARTBEAT = 4, // 心跳包
-        JSON = 5,      // JSON消息
-        PROTOBUF = 6   // Protobuf消息
+        TEXT = 0,          // 文本消息
+        BINARY = 1,        // 二进制消息
+        PING = 2,          // 心跳请求
+        PONG = 3,          // 心跳响应
+        HEARTBEAT = 4,     // 心跳包
+        JSON = 5,          // JSON消息
+        PROTOBUF = 6,      // Protobuf消息
+        SHM_HANDSHAKE = 7, // 共享内存传输的协商，由会话内部处理
+        DATAGRAM_BIND = 8, // 数据报通道的协商，由服务器和客户端内部处理
+        ACK = 9            // 对持久化消息的累计确认，见 SessionConfig::acknowledge
     };
 
+    // 消息头标志：消息来自发送方的持久化日志，接收方的 ACK 只确认这类消息的序列号
+    constexpr uint8_t PACKET_FLAG_DURABLE = 0x01;
+
     // 消息头结构
     struct PacketHeader
     {
         uint8_t version;   // 协议版本
         PacketType type;   // 消息类型
+        uint8_t flags;     // 消息头标志，见 PACKET_FLAG_DURABLE
+        uint8_t reserved;  // 保留，填 0
         uint32_t length;   // 消息长度
         uint32_t sequence; // 序列号
     };
+    static_assert(sizeof(PacketHeader) == 12, "消息头按 12 字节编码");
+
+    // 写入消息头
+    inline void write_packet_header(uint8_t *out, PacketType type, uint32_t length, uint32_t sequence, uint8_t flags = 0)
+    {
+        PacketHeader header{PROTOCOL_VERSION, type, flags, 0, length, sequence};
+        std::memcpy(out, &header, sizeof(PacketHeader));
+    }
+
+    // 已编码的完整消息帧，可由多个会话共享发送
+    using SharedFrame = std::shared_ptr<const std::vector<uint8_t>>;
+
+    // 编码一个完整的消息帧
+    inline SharedFrame make_shared_frame(PacketType type, const uint8_t *data, size_t size, uint32_t sequence = 0,
+                                         uint8_t flags = 0)
+    {
+        auto frame = std::make_shared<std::vector<uint8_t>>(sizeof(PacketHeader) + size);
+        write_packet_header(frame->data(), type, static_cast<uint32_t>(size), sequence, flags);
+        if (size > 0)
+        {
+            std::memcpy(frame->data() + sizeof(PacketHeader), data, size);
+        }
+        return frame;
+    }
+
+    // 确认消息的消息体：收到的最大的持久化消息序列号
+    inline std::vector<uint8_t> encode_ack(uint32_t sequence)
+    {
+        std::vector<uint8_t> payload(sizeof(sequence));
+        std::memcpy(payload.data(), &sequence, sizeof(sequence));
+        return payload;
+    }
+
+    inline bool decode_ack(const std::vector<uint8_t> &payload, uint32_t &sequence)
+    {
+        if (payload.size() != sizeof(sequence))
+        {
+            return false;
+        }
+        std::memcpy(&sequence, payload.data(), sizeof(sequence));
+        return true;
+    }
+
+    // 事件循环线程检查停止标志的间隔
+    constexpr int LOOP_WAKEUP_INTERVAL_MS = 10;
 
     // 心跳相关常量
     constexpr int HEARTBEAT_INTERVAL_MS = 30000; // 30秒
     constexpr int HEARTBEAT_TIMEOUT_MS = 90000;  // 90秒
 
+    // 帧大小相关常量
+    constexpr uint32_t DEFAULT_MAX_FRAME_SIZE = 16 * 1024 * 1024; // 整帧缓存的最大消息长度（16MB）
+    constexpr size_t DEFAULT_STREAM_WINDOW_SIZE = 64 * 1024;      // 流式收发的窗口大小（64KB）
+
     // 拦截器接口
     class Interceptor
     {
@@ -54,6 +113,31 @@ namespace libuv_net
         virtual PacketType get_type() const = 0;
     };
 
+    // 编解码器，按值类型特化，见 codec.hpp
+    template <typename T, typename Enable = void>
+    struct Codec;
+
+    namespace detail
+    {
+        template <typename T, typename = void>
+        struct has_codec : std::false_type
+        {
+        };
+
+        template <typename T>
+        struct has_codec<T, std::void_t<decltype(Codec<T>::decode(nullptr, 0, std::declval<T &>()))>>
+            : std::true_type
+        {
+        };
+
+        // 不依赖 RTTI 的类型标识
+        template <typename T>
+        struct type_tag
+        {
+            static constexpr char id = 0;
+        };
+    } // namespace detail
+
     /**
      * @brief 数据包类
      *
@@ -62,6 +146,7 @@ namespace libuv_net
      * - 消息类型
      * - 消息内容
      * - 序列号
+     * - 按需解码的结果缓存
      */
     class Packet
     {
@@ -83,7 +168,11 @@ namespace libuv_net
         const std::vector<uint8_t> &data() const { return data_; }
 
         // 设置消息数据
-        void set_data(std::vector<uint8_t> data) { data_ = std::move(data); }
+        void set_data(std::vector<uint8_t> data)
+        {
+            data_ = std::move(data);
+            clear_decoded();
+        }
 
         // 获取序列号
         uint32_t sequence() const { return sequence_; }
@@ -101,6 +190,8 @@ namespace libuv_net
             PacketHeader header{
                 PROTOCOL_VERSION,
                 type_,
+                0,
+                0,
                 static_cast<uint32_t>(data_.size()),
                 sequence_};
             result.insert(result.end(),
@@ -113,6 +204,70 @@ namespace libuv_net
             return result;
         }
 
+        /**
+         * @brief 附加拦截器，decoded() 和 as() 按需使用它解码
+         *
+         * 数据包共同持有拦截器，离开会话或客户端之后仍可解码。
+         * 会话附加拦截器后先解码一次，解码失败的消息不交付处理器，处理器取出的是缓存的结果。
+         */
+        void set_interceptor(std::shared_ptr<Interceptor> interceptor)
+        {
+            interceptor_ = std::move(interceptor);
+            clear_decoded();
+        }
+
+        /**
+         * @brief 获取拦截器解码后的数据
+         *
+         * 首次调用时才解码，结果缓存在数据包上，之后不再重复解析。
+         * 未附加拦截器或解码失败时返回空的 std::any。
+         */
+        const std::any &decoded() const
+        {
+            auto value = static_cast<const std::any *>(find_decoded(&detail::type_tag<std::any>::id));
+            if (!value)
+            {
+                auto result = std::make_shared<std::any>(interceptor_ ? interceptor_->deserialize(data_) : std::any());
+                value = result.get();
+                store_decoded(&detail::type_tag<std::any>::id, std::move(result));
+            }
+            return *value;
+        }
+
+        /**
+         * @brief 以指定类型获取解码后的数据
+         *
+         * 为 T 特化了 Codec<T> 时总是使用编译期确定的编解码器，不经过 std::any，即使附加了拦截器；
+         * 没有编解码器的类型才由附加的拦截器解码，再按 T 取出结果。
+         * 首次调用时才解码，结果缓存在数据包上，返回的指针在数据包的生命周期内有效。
+         * 类型不符或解码失败时返回 nullptr。缓存不是线程安全的。
+         */
+        template <typename T>
+        const T *as() const
+        {
+            if constexpr (detail::has_codec<T>::value)
+            {
+                const void *tag = &detail::type_tag<T>::id;
+                if (!has_decoded(tag))
+                {
+                    auto value = std::make_shared<T>();
+                    if (Codec<T>::decode(data_.data(), data_.size(), *value))
+                    {
+                        store_decoded(tag, std::move(value));
+                    }
+                    else
+                    {
+                        store_decoded(tag, nullptr);
+                    }
+                }
+                return static_cast<const T *>(find_decoded(tag));
+            }
+            else
+            {
+                return interceptor_ ? std::any_cast<T>(&decoded()) : nullptr;
+            }
+        }
+
         // 反序列化消息
         bool deserialize(const uint8_t *data, size_t length)
         {
@@ -142,19 +297,66 @@ namespace libuv_net
 
             data_.assign(data + sizeof(PacketHeader),
                          data + sizeof(PacketHeader) + data_length);
+            clear_decoded();
 
             return true;
         }
 
     private:
-        PacketType type_;           // 消息类型
-        std::vector<uint8_t> data_; // 消息数据
-        uint32_t sequence_;         // 序列号
+        // 解码结果，按类型标识缓存；value 为空表示解码失败
+        struct DecodedValue
+        {
+            const void *tag;
+            std::shared_ptr<void> value;
+        };
+
+        bool has_decoded(const void *tag) const
+        {
+            for (const auto &entry : decoded_)
+            {
+                if (entry.tag == tag)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const void *find_decoded(const void *tag) const
+        {
+            for (const auto &entry : decoded_)
+            {
+                if (entry.tag == tag)
+                {
+                    return entry.value.get();
+                }
+            }
+            return nullptr;
+        }
+
+        void store_decoded(const void *tag, std::shared_ptr<void> value) const
+        {
+            decoded_.push_back(DecodedValue{tag, std::move(value)});
+        }
+
+        void clear_decoded() { decoded_.clear(); }
+
+        PacketType type_;                           // 消息类型
+        std::vector<uint8_t> data_;                 // 消息数据
+        uint32_t sequence_;                         // 序列号
+        std::shared_ptr<Interceptor> interceptor_;  // 按需解码使用的拦截器
+        mutable std::vector<DecodedValue> decoded_; // 解码结果缓存
     };
 
     // 数据包处理回调函数类型
     using PacketHandler = std::function<void(std::shared_ptr<Packet>)>;
 
+    // 流式消息分块回调函数类型：header 描述所属的流，last 表示最后一块
+    using ChunkHandler = std::function<void(const PacketHeader &header, const uint8_t *data, size_t size, bool last)>;
+
+    // 流式发送数据源回调函数类型：向 buffer 写入至多 capacity 字节，返回实际写入的字节数
+    using ChunkSource = std::function<size_t(uint8_t *buffer, size_t capacity)>;
+
     // 拦截器管理类
     class InterceptorManager
     {
@@ -162,18 +364,22 @@ namespace libuv_net
         // 添加拦截器
         void add_interceptor(std::shared_ptr<Interceptor> interceptor)
         {
-            interceptors_[interceptor->get_type()] = std::move(interceptor);
+            auto type = interceptor->get_type();
+            interceptors_.set(type, std::move(interceptor));
         }
 
-        // 获取拦截器
-        std::shared_ptr<Interceptor> get_interceptor(PacketType type)
+        // 获取拦截器（不增加引用计数，生命周期由管理器持有）
+        Interceptor *get_interceptor(PacketType type) const
         {
-            auto it = interceptors_.find(type);
-            if (it != interceptors_.end())
-            {
-                return it->second;
-            }
-            return nullptr;
+            auto interceptor = interceptors_.find(type);
+            return interceptor ? interceptor->get() : nullptr;
+        }
+
+        // 获取拦截器的共享指针，供生命周期可能超出管理器的数据包持有
+        std::shared_ptr<Interceptor> share_interceptor(PacketType type) const
+        {
+            auto interceptor = interceptors_.find(type);
+            return interceptor ? *interceptor : nullptr;
         }
 
         // 序列化数据
@@ -199,7 +405,9 @@ namespace libuv_net
         }
 
     private:
-        std::map<PacketType, std::shared_ptr<Interceptor>> interceptors_;
+        DispatchTable<std::shared_ptr<Interceptor>> interceptors_;
     };
 
-} // namespace libuv_net
\ No newline at end of file
+} // namespace libuv_net
+
+#include "libuv_net/codec.hpp"
\ No newline at end of file
@@ -1,89 +1,290 @@
 #pragma once
 
 #include "libuv_net/message.hpp"
+#include "libuv_net/codec.hpp"
 #include <google/protobuf/message.h>
 #include <google/protobuf/descriptor.h>
-#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/arena.h>
+#include <mutex>
+#include <unordered_map>
 
 namespace libuv_net
 {
     /**
      * @brief Protobuf拦截器
      *
-     * 用于处理Protobuf格式的消息
+     * 用于处理Protobuf格式的消息。消息体格式为：
+     *
+     * | 类型ID(4字节，小端序) | Protobuf 编码(N字节) |
+     *
+     * 类型 ID 在注册表中映射到缓存的原型消息，反序列化时直接从消息体解析，
+     * 消息分配在可复用的 Arena 上：没有消息引用 Arena 时重置复用其内存块，
+     * 仍有消息在用时换用新的 Arena，旧的随最后一个消息释放。
+     *
+     * 同一个实例可以同时加到服务器和客户端（或多循环的 ClientContext）上，在多个线程中解码；
+     * 取用 Arena 时加锁，解析本身在锁外进行。注册消息类型应在开始收发之前完成。
      */
     class ProtobufInterceptor : public Interceptor
     {
     public:
+        // 默认的 Arena 初始内存块大小
+        static constexpr size_t DEFAULT_ARENA_BLOCK_SIZE = 64 * 1024;
+        // 类型 ID 的长度
+        static constexpr size_t TYPE_ID_SIZE = sizeof(uint32_t);
+
         // 构造函数
-        ProtobufInterceptor() = default;
+        explicit ProtobufInterceptor(size_t arena_block_size = DEFAULT_ARENA_BLOCK_SIZE)
+            : arena_block_size_(arena_block_size)
+        {
+        }
 
-        // 序列化数据
-        std::vector<uint8_t> serialize(const std::any &data) override
+        /**
+         * @brief 由消息全名计算默认的类型 ID（FNV-1a）
+         */
+        static uint32_t type_id_of(const google::protobuf::Descriptor *descriptor)
+        {
+            uint32_t hash = 2166136261u;
+            for (char c : descriptor->full_name())
+            {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        /**
+         * @brief 注册消息类型
+         * @param type_id 类型 ID
+         * @param prototype 原型消息，需在拦截器的生命周期内有效（通常为 default_instance）
+         * @return 类型 ID 是否未被占用
+         */
+        bool register_type(uint32_t type_id, const google::protobuf::Message *prototype)
         {
-            try
+            if (!prototype || prototypes_.count(type_id))
             {
-                // 获取Protobuf消息
-                const auto &message = std::any_cast<std::shared_ptr<google::protobuf::Message>>(data);
+                return false;
+            }
+            prototypes_[type_id] = prototype;
+            type_ids_[prototype->GetDescriptor()] = type_id;
+            return true;
+        }
 
-                // 序列化消息
-                std::string serialized;
-                if (!message->SerializeToString(&serialized))
-                {
-                    return std::vector<uint8_t>();
-                }
+        // 注册生成代码中的消息类型，类型 ID 默认由全名计算
+        template <typename MessageT>
+        bool register_type()
+        {
+            return register_type<MessageT>(type_id_of(MessageT::descriptor()));
+        }
+
+        template <typename MessageT>
+        bool register_type(uint32_t type_id)
+        {
+            return register_type(type_id, &MessageT::default_instance());
+        }
 
-                // 转换为字节向量
-                return std::vector<uint8_t>(serialized.begin(), serialized.end());
+        /**
+         * @brief 按全名注册已编译进程序的消息类型
+         * @param full_name 消息全名，如 "example.Quote"
+         * @return 是否注册成功
+         */
+        bool register_type(const std::string &full_name)
+        {
+            const google::protobuf::Descriptor *descriptor =
+                google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(full_name);
+            if (!descriptor)
+            {
+                return false;
             }
-            catch (const std::bad_any_cast &)
+            return register_type(type_id_of(descriptor),
+                                 google::protobuf::MessageFactory::generated_factory()->GetPrototype(descriptor));
+        }
+
+        // 序列化数据
+        std::vector<uint8_t> serialize(const std::any &data) override
+        {
+            // 获取Protobuf消息
+            const auto *message = std::any_cast<std::shared_ptr<google::protobuf::Message>>(&data);
+            if (!message || !*message)
             {
                 return std::vector<uint8_t>();
             }
+
+            // 查找类型 ID
+            auto it = type_ids_.find((*message)->GetDescriptor());
+            if (it == type_ids_.end())
+            {
+                return std::vector<uint8_t>();
+            }
+
+            // 直接序列化到字节向量
+            std::vector<uint8_t> result(encoded_size(**message));
+            encode_to(**message, it->second, result.data());
+            return result;
         }
 
         // 反序列化数据
         std::any deserialize(const std::vector<uint8_t> &data) override
         {
-            try
+            if (data.size() < TYPE_ID_SIZE)
             {
-                // 转换为字符串
-                std::string serialized(data.begin(), data.end());
+                return std::any();
+            }
 
-                // 创建动态消息工厂
-                google::protobuf::DynamicMessageFactory factory;
+            // 查找缓存的原型
+            auto it = prototypes_.find(read_type_id(data.data()));
+            if (it == prototypes_.end())
+            {
+                return std::any();
+            }
 
-                // 获取消息类型
-                const google::protobuf::Descriptor *descriptor =
-                    google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName("google.protobuf.Message");
+            // 在 Arena 上创建消息并直接从消息体解析
+            auto arena = acquire_arena();
+            google::protobuf::Message *message = it->second->New(&arena->arena);
+            if (!message->ParseFromArray(data.data() + TYPE_ID_SIZE, static_cast<int>(data.size() - TYPE_ID_SIZE)))
+            {
+                return std::any();
+            }
+
+            // 消息的生命周期与 Arena 绑定
+            return std::shared_ptr<google::protobuf::Message>(std::move(arena), message);
+        }
 
-                if (!descriptor)
-                {
-                    return std::any();
-                }
+        // 获取支持的消息类型
+        PacketType get_type() const override
+        {
+            return PacketType::PROTOBUF;
+        }
 
-                // 创建消息对象
-                std::unique_ptr<google::protobuf::Message> message(factory.GetPrototype(descriptor)->New());
+        // 编码后的消息体长度，同时缓存消息的序列化长度
+        static size_t encoded_size(const google::protobuf::Message &message)
+        {
+            return TYPE_ID_SIZE + message.ByteSizeLong();
+        }
 
-                // 解析消息
-                if (!message->ParseFromString(serialized))
-                {
-                    return std::any();
-                }
+        // 按 encoded_size() 缓存的长度写入类型 ID 和消息，out 至少需要 encoded_size() 字节
+        static void encode_to(const google::protobuf::Message &message, uint32_t type_id, uint8_t *out)
+        {
+            write_type_id(out, type_id);
+            message.SerializeWithCachedSizesToArray(out + TYPE_ID_SIZE);
+        }
 
-                return std::shared_ptr<google::protobuf::Message>(message.release());
+        // 读写消息体前缀中的类型 ID
+        static void write_type_id(uint8_t *out, uint32_t type_id)
+        {
+            for (size_t i = 0; i < TYPE_ID_SIZE; ++i)
+            {
+                out[i] = static_cast<uint8_t>(type_id >> (8 * i));
             }
-            catch (const std::exception &)
+        }
+
+        static uint32_t read_type_id(const uint8_t *data)
+        {
+            uint32_t type_id = 0;
+            for (size_t i = 0; i < TYPE_ID_SIZE; ++i)
             {
-                return std::any();
+                type_id |= static_cast<uint32_t>(data[i]) << (8 * i);
             }
+            return type_id;
         }
 
-        // 获取支持的消息类型
-        PacketType get_type() const override
+    private:
+        // 带自有初始内存块的 Arena，重置后保留初始块，稳态下解析不再分配内存
+        struct ArenaSlot
         {
-            return PacketType::PROTOBUF;
+            explicit ArenaSlot(size_t block_size)
+                : block(new char[block_size]), arena(make_options(block.get(), block_size))
+            {
+            }
+
+            static google::protobuf::ArenaOptions make_options(char *block, size_t block_size)
+            {
+                google::protobuf::ArenaOptions options;
+                options.initial_block = block;
+                options.initial_block_size = block_size;
+                return options;
+            }
+
+            std::unique_ptr<char[]> block;
+            google::protobuf::Arena arena;
+        };
+
+        std::shared_ptr<ArenaSlot> acquire_arena()
+        {
+            // 引用计数为 1 时其他线程也只能经由此处取得引用，重置是安全的
+            std::lock_guard<std::mutex> lock(arena_mutex_);
+            if (arena_ && arena_.use_count() == 1)
+            {
+                // 没有消息再引用该 Arena，重置后复用
+                arena_->arena.Reset();
+            }
+            else if (!arena_ || arena_->arena.SpaceUsed() >= arena_block_size_)
+            {
+                // 仍有消息在用且初始块已用完，换用新的 Arena
+                arena_ = std::make_shared<ArenaSlot>(arena_block_size_);
+            }
+            return arena_;
+        }
+
+        size_t arena_block_size_;
+        std::mutex arena_mutex_;           // 保护 arena_ 的取用和重置
+        std::shared_ptr<ArenaSlot> arena_;
+        std::unordered_map<uint32_t, const google::protobuf::Message *> prototypes_;
+        std::unordered_map<const google::protobuf::Descriptor *, uint32_t> type_ids_;
+    };
+
+    /**
+     * @brief Protobuf 消息的编解码器
+     *
+     * 与 ProtobufInterceptor 使用相同的消息体格式，类型 ID 取默认值（由全名计算）。
+     * 发送时用 ByteSizeLong() 算出长度，直接序列化进帧缓冲区，不经过中间字符串。
+     */
+    template <typename T>
+    struct Codec<T, std::enable_if_t<std::is_base_of<google::protobuf::Message, T>::value>>
+    {
+        static uint32_t type_id(const T &value)
+        {
+            if constexpr (std::is_same<T, google::protobuf::Message>::value)
+            {
+                return ProtobufInterceptor::type_id_of(value.GetDescriptor());
+            }
+            else
+            {
+                static const uint32_t id = ProtobufInterceptor::type_id_of(T::descriptor());
+                return id;
+            }
+        }
+
+        static size_t encoded_size(const T &value)
+        {
+            return ProtobufInterceptor::encoded_size(value);
+        }
+
+        static bool encode_to(const T &value, uint8_t *out, size_t size)
+        {
+            if (size < ProtobufInterceptor::TYPE_ID_SIZE)
+            {
+                return false;
+            }
+            ProtobufInterceptor::encode_to(value, type_id(value), out);
+            return true;
+        }
+
+        static bool encode(const T &value, std::vector<uint8_t> &out)
+        {
+            out.resize(encoded_size(value));
+            return encode_to(value, out.data(), out.size());
+        }
+
+        static bool decode(const uint8_t *data, size_t size, T &value) noexcept
+        {
+            if (size < ProtobufInterceptor::TYPE_ID_SIZE ||
+                ProtobufInterceptor::read_type_id(data) != type_id(value))
+            {
+                return false;
+            }
+            return value.ParseFromArray(data + ProtobufInterceptor::TYPE_ID_SIZE,
+                                        static_cast<int>(size - ProtobufInterceptor::TYPE_ID_SIZE));
         }
     };
 
-} // namespace libuv_net
\ No newline at end of file
+} // namespace libuv_net
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace libuv_net
+{
+    /**
+     * @brief 限流参数
+     *
+     * 速率为 0 表示不限制；突发容量为 0 时取一秒的速率。
+     */
+    struct RateLimit
+    {
+        double packets_per_second = 0; // 每秒消息数
+        double packet_burst = 0;       // 消息数的突发容量
+        double bytes_per_second = 0;   // 每秒字节数
+        double byte_burst = 0;         // 字节数的突发容量
+
+        bool enabled() const { return packets_per_second > 0 || bytes_per_second > 0; }
+    };
+
+    /**
+     * @brief 令牌桶
+     *
+     * 允许透支：只要桶中还有令牌就放行，一次消耗可以超过剩余令牌，
+     * 之后需要等令牌补回正数才能再放行。这样大于突发容量的消息也能通过，只是之后等待更久。
+     */
+    class TokenBucket
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        TokenBucket() = default;
+        TokenBucket(double rate, double burst, Clock::time_point now = Clock::now())
+            : rate_(rate), burst_(burst > 0 ? burst : rate), tokens_(burst > 0 ? burst : rate), last_refill_(now)
+        {
+        }
+
+        // 是否限制
+        bool limited() const { return rate_ > 0; }
+
+        // 按经过的时间补充令牌
+        void refill(Clock::time_point now)
+        {
+            if (!limited())
+            {
+                return;
+            }
+            double elapsed = std::chrono::duration<double>(now - last_refill_).count();
+            tokens_ = std::min(burst_, tokens_ + elapsed * rate_);
+            last_refill_ = now;
+        }
+
+        // 是否可以放行
+        bool available() const { return !limited() || tokens_ > 0; }
+
+        // 消耗令牌
+        void consume(double count)
+        {
+            if (limited())
+            {
+                tokens_ -= count;
+            }
+        }
+
+        // 恢复可放行还需等待的时间
+        Clock::duration wait_time() const
+        {
+            if (available())
+            {
+                return Clock::duration::zero();
+            }
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(-tokens_ / rate_)) +
+                   std::chrono::milliseconds(1);
+        }
+
+    private:
+        double rate_ = 0;
+        double burst_ = 0;
+        double tokens_ = 0;
+        Clock::time_point last_refill_{};
+    };
+
+    /**
+     * @brief 一组消息数和字节数令牌桶
+     */
+    class RateBuckets
+    {
+    public:
+        using Clock = TokenBucket::Clock;
+
+        RateBuckets() = default;
+        explicit RateBuckets(const RateLimit &limit, Clock::time_point now = Clock::now())
+            : packets_(limit.packets_per_second, limit.packet_burst, now),
+              bytes_(limit.bytes_per_second, limit.byte_burst, now)
+        {
+        }
+
+        // 补充令牌后检查是否可以放行
+        bool available(Clock::time_point now)
+        {
+            packets_.refill(now);
+            bytes_.refill(now);
+            return packets_.available() && bytes_.available();
+        }
+
+        void consume(double packets, double bytes)
+        {
+            packets_.consume(packets);
+            bytes_.consume(bytes);
+        }
+
+        Clock::duration wait_time() const
+        {
+            return std::max(packets_.wait_time(), bytes_.wait_time());
+        }
+
+    private:
+        TokenBucket packets_;
+        TokenBucket bytes_;
+    };
+
+} // namespace libuv_net
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <uv.h>
+
+namespace libuv_net
+{
+    class Session;
+
+    /**
+     * @brief 读取的轮转调度器
+     *
+     * 会话一次处理的消息数或时间超出预算时暂停读取并排入队列，剩余的数据
+     * 在之后的事件循环迭代中按轮转顺序继续处理，避免一个会话长时间占用事件循环。
+     * 队列非空时启动 uv_idle_t，使事件循环在还有待处理数据时不阻塞在轮询上。
+     *
+     * 每个事件循环一个调度器，只能在事件循环线程中使用。
+     */
+    class ReadScheduler
+    {
+    public:
+        explicit ReadScheduler(uv_loop_t *loop);
+        ~ReadScheduler();
+
+        // 禁用拷贝构造和赋值
+        ReadScheduler(const ReadScheduler &) = delete;
+        ReadScheduler &operator=(const ReadScheduler &) = delete;
+
+        // 将会话排入队列，下一轮继续处理
+        void defer(std::weak_ptr<Session> session);
+
+        // 关闭 idle 句柄，需在删除事件循环之前调用并执行关闭回调
+        void close();
+
+        // 排队中的会话数
+        size_t pending() const { return queue_.size(); }
+
+    private:
+        static void on_idle(uv_idle_t *handle);
+
+        uv_idle_t *idle_;                           // idle 句柄，关闭回调中释放
+        std::vector<std::weak_ptr<Session>> queue_; // 等待继续处理的会话
+        std::vector<std::weak_ptr<Session>> turn_;  // 本轮处理的会话
+    };
+
+} // namespace libuv_net
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <random>
+#include <vector>
+#include "libuv_net/message.hpp"
+
+namespace libuv_net
+{
+    // 自动重连的配置
+    struct ReconnectOptions
+    {
+        bool enabled = true;                           // 是否自动重连
+        std::chrono::milliseconds initial_delay{100};  // 第一次重连前的等待时间
+        std::chrono::milliseconds max_delay{30000};    // 等待时间的上限
+        double multiplier = 2.0;                       // 每次失败后等待时间的倍数
+        double jitter = 0.5;                           // 随机缩短的比例，等待时间在 [d × (1 - jitter), d] 中均匀取值
+        size_t max_queued_packets = 1024;              // 断开期间最多缓存的消息数
+        size_t max_queued_bytes = 1024 * 1024;         // 断开期间最多缓存的字节数（含消息头）
+        bool replay_sequenced = false;                 // 重连后重发断开前最近发出的带序列号消息，接收方按序列号去重
+    };
+
+    /**
+     * @brief 带随机抖动的指数退避
+     *
+     * 大量客户端同时断开时，随机抖动让重连分散开，不会同时冲击刚恢复的服务器。
+     */
+    class Backoff
+    {
+    public:
+        explicit Backoff(const ReconnectOptions &options = ReconnectOptions()) : options_(options) {}
+
+        // 下一次重连前的等待时间，每调用一次按倍数增长直到上限
+        std::chrono::milliseconds next_delay()
+        {
+            double delay = std::min(static_cast<double>(options_.initial_delay.count()) * factor_,
+                                    static_cast<double>(options_.max_delay.count()));
+            factor_ *= options_.multiplier;
+            ++attempts_;
+
+            double jitter = std::clamp(options_.jitter, 0.0, 1.0);
+            std::uniform_real_distribution<double> scale(1.0 - jitter, 1.0);
+            return std::chrono::milliseconds(static_cast<int64_t>(delay * scale(random_)));
+        }
+
+        // 连接成功后恢复初始等待时间
+        void reset()
+        {
+            factor_ = 1.0;
+            attempts_ = 0;
+        }
+
+        // 自上次成功以来的重连次数
+        uint32_t attempts() const { return attempts_; }
+
+    private:
+        ReconnectOptions options_;
+        double factor_ = 1.0;
+        uint32_t attempts_ = 0;
+        std::mt19937 random_{std::random_device{}()};
+    };
+
+    /**
+     * @brief 按消息数和字节数限制的消息队列，用于断开期间缓存待发的消息
+     */
+    class ReplayQueue
+    {
+    public:
+        ReplayQueue(size_t max_packets, size_t max_bytes) : max_packets_(max_packets), max_bytes_(max_bytes) {}
+
+        // 追加消息，超出限制时不追加并返回 false
+        bool push(std::shared_ptr<Packet> packet)
+        {
+            size_t size = frame_size(*packet);
+            if (packets_.size() + 1 > max_packets_ || bytes_ + size > max_bytes_)
+            {
+                return false;
+            }
+            bytes_ += size;
+            packets_.push_back(std::move(packet));
+            return true;
+        }
+
+        // 追加消息，超出限制时丢弃最早的消息
+        void push_evicting(std::shared_ptr<Packet> packet)
+        {
+            size_t size = frame_size(*packet);
+            if (size > max_bytes_ || max_packets_ == 0)
+            {
+                return;
+            }
+            while (!packets_.empty() && (packets_.size() + 1 > max_packets_ || bytes_ + size > max_bytes_))
+            {
+                bytes_ -= frame_size(*packets_.front());
+                packets_.pop_front();
+            }
+            bytes_ += size;
+            packets_.push_back(std::move(packet));
+        }
+
+        // 把所有消息编码为连续的帧追加到 out
+        void append_frames(std::vector<uint8_t> &out) const
+        {
+            out.reserve(out.size() + bytes_);
+            for (const auto &packet : packets_)
+            {
+                size_t offset = out.size();
+                const auto &data = packet->data();
+                out.resize(offset + sizeof(PacketHeader) + data.size());
+                write_packet_header(out.data() + offset, packet->type(), static_cast<uint32_t>(data.size()),
+                                    packet->sequence());
+                std::copy(data.begin(), data.end(), out.begin() + static_cast<std::ptrdiff_t>(offset + sizeof(PacketHeader)));
+            }
+        }
+
+        template <typename F>
+        void for_each(F &&f) const
+        {
+            for (const auto &packet : packets_)
+            {
+                f(packet);
+            }
+        }
+
+        void clear()
+        {
+            packets_.clear();
+            bytes_ = 0;
+        }
+
+        bool empty() const { return packets_.empty(); }
+        size_t size() const { return packets_.size(); }
+        size_t bytes() const { return bytes_; }
+
+    private:
+        static size_t frame_size(const Packet &packet) { return sizeof(PacketHeader) + packet.data().size(); }
+
+        size_t max_packets_;
+        size_t max_bytes_;
+        size_t bytes_ = 0;
+        std::deque<std::shared_ptr<Packet>> packets_;
+    };
+
+} // namespace libuv_net
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <uv.h>
+
+namespace libuv_net
+{
+    // 上一个连接尝试未完成时开始下一个地址的间隔（RFC 8305 建议的 250 毫秒）
+    constexpr int CONNECT_ATTEMPT_DELAY_MS = 250;
+
+    // 解析结果的默认缓存时间，getaddrinfo 不返回记录的 TTL
+    constexpr std::chrono::seconds DEFAULT_RESOLVE_TTL{30};
+
+    /**
+     * @brief 解析数字形式的 IPv4 或 IPv6 地址，不查询 DNS
+     *
+     * IPv6 地址可以带方括号，如 [::1]。
+     *
+     * @return 0 或 libuv 错误码
+     */
+    int parse_ip_address(const std::string &host, int port, sockaddr_storage &addr);
+
+    /**
+     * @brief 同步解析地址，先按数字地址解析，否则调用 getaddrinfo 取第一个结果
+     *
+     * 会阻塞调用线程，只用于启动时的监听地址；建立连接使用 Resolver。
+     *
+     * @return 0 或 libuv 错误码
+     */
+    int resolve_address(uv_loop_t *loop, const std::string &host, int port, sockaddr_storage &addr);
+
+    /**
+     * @brief 按 Happy Eyeballs（RFC 8305）的顺序排列地址
+     *
+     * 以第一个地址的协议族开始，IPv6 和 IPv4 交替，同一协议族内保持解析器给出的顺序。
+     */
+    std::vector<sockaddr_storage> interleave_addresses(const std::vector<sockaddr_storage> &addresses);
+
+    /**
+     * @brief 异步地址解析器，带结果缓存
+     *
+     * 在事件循环上调用 uv_getaddrinfo（由 libuv 的线程池执行），不阻塞事件循环；
+     * 成功的结果按主机名缓存 TTL 时长，同一主机名同时发起的解析合并为一次查询。
+     * 查询函数可以替换，用于测试或接入自定义的解析服务。
+     *
+     * 只能在事件循环线程中使用。
+     */
+    class Resolver
+    {
+    public:
+        // 解析完成的回调，地址中已填入端口
+        using Callback = std::function<void(int status, std::vector<sockaddr_storage> addresses)>;
+        // 查询函数：解析主机名，完成时调用 done（可以同步调用），端口由解析器填入
+        using Lookup = std::function<void(const std::string &host, Callback done)>;
+
+        explicit Resolver(uv_loop_t *loop);
+        ~Resolver();
+
+        // 禁用拷贝构造和赋值
+        Resolver(const Resolver &) = delete;
+        Resolver &operator=(const Resolver &) = delete;
+
+        /**
+         * @brief 解析主机名
+         *
+         * 数字地址直接返回，缓存未过期时同步返回缓存的结果，否则异步查询。
+         *
+         * @param host 主机名或 IP 地址
+         * @param port 端口
+         * @param callback 完成回调
+         */
+        void resolve(const std::string &host, uint16_t port, Callback callback);
+
+        // 设置缓存时间，0 表示不缓存
+        void set_ttl(std::chrono::milliseconds ttl) { ttl_ = ttl; }
+
+        // 替换查询函数，为空时恢复为 uv_getaddrinfo；完成回调可以在解析器销毁后调用，此时被忽略
+        void set_lookup(Lookup lookup) { lookup_ = std::move(lookup); }
+
+        // 清空缓存
+        void clear_cache() { cache_.clear(); }
+
+        // 取消所有进行中的查询，回调不再执行
+        void cancel();
+
+    private:
+        struct Query;
+        struct CacheEntry
+        {
+            std::vector<sockaddr_storage> addresses;
+            std::chrono::steady_clock::time_point expires;
+        };
+        struct Waiter
+        {
+            uint16_t port;
+            Callback callback;
+        };
+
+        static void on_getaddrinfo(uv_getaddrinfo_t *req, int status, addrinfo *res);
+        // 查询完成，缓存结果并通知所有等待的调用者
+        void complete(const std::string &host, int status, std::vector<sockaddr_storage> addresses);
+
+        uv_loop_t *loop_;
+        std::chrono::milliseconds ttl_{DEFAULT_RESOLVE_TTL};
+        Lookup lookup_;
+        std::unordered_map<std::string, CacheEntry> cache_;            // 主机名到解析结果的缓存
+        std::unordered_map<std::string, std::vector<Waiter>> waiting_; // 进行中的查询及等待的调用者
+        std::vector<Query *> queries_;                                 // 进行中的 uv_getaddrinfo 请求
+        // 查询函数的完成回调只持有弱引用，cancel() 或析构后失效，迟到的回调不再访问解析器
+        std::shared_ptr<Resolver *> token_ = std::make_shared<Resolver *>(this);
+    };
+
+} // namespace libuv_net
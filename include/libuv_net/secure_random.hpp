@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+namespace libuv_net
+{
+    /**
+     * @brief 用操作系统的密码学安全随机源填充缓冲区
+     *
+     * Linux 上使用 getrandom()，其他 Unix 读取 /dev/urandom，Windows 上使用 BCryptGenRandom。
+     * 用于对端不应能够猜到的值，例如共享内存段的名称和数据报通道的令牌。
+     *
+     * @return 是否填满了缓冲区
+     */
+    bool fill_secure_random(void *out, size_t size);
+
+} // namespace libuv_net
@@ -3,12 +3,17 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <functional>
 #include <uv.h>
 #include "libuv_net/session.hpp"
+#include "libuv_net/session_pool.hpp"
+#include "libuv_net/topic_index.hpp"
+#include "libuv_net/read_scheduler.hpp"
+#include "libuv_net/unix_socket.hpp"
+#include "libuv_net/resolver.hpp"
 #include "libuv_net/thread_pool.hpp"
 #include <iostream>
-#include <map>
 
 namespace libuv_net
 {
@@ -29,6 +34,8 @@ namespace libuv_net
         // 回调函数类型定义
         using SessionHandler = std::function<void(std::shared_ptr<Session>)>;                         // 会话处理回调
         using PacketHandler = std::function<void(std::shared_ptr<Session>, std::shared_ptr<Packet>)>; // 消息处理回调
+        using ChunkHandler = std::function<void(std::shared_ptr<Session>, const PacketHeader &,
+                                                const uint8_t *, size_t, bool)>; // 流式消息分块回调
 
         Server();
         ~Server();
@@ -50,10 +57,44 @@ namespace libuv_net
 
         /**
          * @brief 启动服务器
-         * @param host 监听主机名或 IP 地址
+         *
+         * 主机名在调用线程中同步解析，取第一个地址。监听 "::" 时同时接受 IPv4 和 IPv6 连接
+         * （系统未强制 IPV6_V6ONLY 时）。
+         *
+         * @param host 监听主机名或 IP 地址，IPv6 地址可以带方括号
          * @param port 监听端口
+         * @return 是否成功监听
+         */
+        bool listen(const std::string &host, int port);
+
+        /**
+         * @brief 在 Unix 域套接字上监听
+         *
+         * 同一主机上的连接不经过 TCP 协议栈，会话的消息接口与 TCP 连接完全相同，
+         * 可以与 listen() 同时使用。以 @ 开头的路径使用 Linux 的抽象命名空间，不创建套接字文件；
+         * 其他路径在停止监听时删除套接字文件。Windows 上为命名管道的名称。
+         *
+         * @param path 套接字路径
+         * @return 是否成功监听
+         */
+        bool listen_unix(const std::string &path);
+
+        /**
+         * @brief 在 UDP 端口上接收数据报通道
+         *
+         * 客户端通过已建立的 TCP 连接请求数据报通道，服务器分配随机的令牌和认证密钥并答复 UDP 端口，
+         * 之后双方可以用 Session::send_unreliable() 经 UDP 发送可丢失的消息，收到的消息交给
+         * 与连接相同的处理器，同样受长度上限和限流约束。令牌区分会话，密钥认证每个数据报，
+         * 见 DatagramSocket；密钥经连接明文下发，能看到连接内容的第三方仍可伪造数据报。
+         *
+         * @param host 监听主机名或 IP 地址
+         * @param port 监听端口，0 表示由系统分配
+         * @return 是否成功监听
          */
-        void listen(const std::string &host, int port);
+        bool listen_udp(const std::string &host, int port);
+
+        // 数据报通道的 UDP 端口，未监听时为 0
+        int udp_port() const { return datagram_ ? datagram_->local_port() : 0; }
 
         /**
          * @brief 停止服务器
@@ -79,7 +120,32 @@ namespace libuv_net
          */
         void set_packet_handler(PacketType type, PacketHandler handler)
         {
-            packet_handlers_[type] = std::move(handler);
+            session_config_->set_packet_handler(type, wrap_packet_handler(std::move(handler)));
+        }
+
+        /**
+         * @brief 设置类型化消息处理回调
+         *
+         * 值类型由处理器的最后一个参数推导，编解码器在编译期确定，
+         * 解码结果缓存在数据包上，每个消息只解码一次，以引用传给处理器，解码失败的消息被丢弃。
+         *
+         * @param handler 形如 void(Session &, const T &) 的回调
+         */
+        template <PacketType Type, typename F>
+        void on(F &&handler)
+        {
+            session_config_->on<Type>(std::forward<F>(handler));
+        }
+
+        /**
+         * @brief 登记编解码器
+         *
+         * 交给普通处理器的该类型消息先做解码校验，失败的消息被丢弃。
+         */
+        template <PacketType Type, typename T>
+        void register_codec()
+        {
+            session_config_->codecs.register_codec<T>(Type);
         }
 
         /**
@@ -88,7 +154,156 @@ namespace libuv_net
          */
         void set_default_packet_handler(PacketHandler handler)
         {
-            default_packet_handler_ = std::move(handler);
+            session_config_->default_packet_handler = wrap_packet_handler(std::move(handler));
+        }
+
+        /**
+         * @brief 设置流式消息分块回调
+         *
+         * 该类型的消息不再整帧缓存，消息体按块交付，内存占用受窗口大小约束。
+         *
+         * @param type 消息类型
+         * @param handler 回调函数
+         */
+        void set_chunk_handler(PacketType type, ChunkHandler handler)
+        {
+            SessionConfig::ChunkHandler wrapped;
+            if (handler)
+            {
+                wrapped = [handler = std::move(handler)](Session &session, const PacketHeader &header,
+                                                         const uint8_t *data, size_t size, bool last)
+                { handler(session.shared_from_this(), header, data, size, last); };
+            }
+            session_config_->chunk_handlers.set(type, std::move(wrapped));
+        }
+
+        /**
+         * @brief 设置整帧缓存的最大消息长度
+         * @param size 最大长度，超出的消息在解析消息头时即被拒绝并关闭会话
+         */
+        void set_max_frame_size(uint32_t size) { session_config_->max_frame_size = size; }
+
+        /**
+         * @brief 设置流式收发的窗口大小
+         * @param size 窗口大小
+         */
+        void set_stream_window_size(size_t size) { session_config_->stream_window_size = size > 0 ? size : 1; }
+
+        /**
+         * @brief 设置每个会话的入站限流
+         *
+         * 会话超出限额时暂停读取而不是继续缓存数据，令牌补足后自动恢复。
+         *
+         * @param limit 限流参数
+         */
+        void set_rate_limit(const RateLimit &limit) { session_config_->rate_limit = limit; }
+
+        /**
+         * @brief 设置每个会话某一消息类型的入站限流
+         * @param type 消息类型
+         * @param limit 限流参数
+         */
+        void set_rate_limit(PacketType type, const RateLimit &limit) { session_config_->type_rate_limits.set(type, limit); }
+
+        /**
+         * @brief 设置所有会话共享的入站限流
+         *
+         * 可在服务器运行期间调用：令牌桶整体原子替换，事件循环线程中正在使用的旧桶在用完后释放。
+         *
+         * @param limit 限流参数，不限制时传入默认值
+         */
+        void set_global_rate_limit(const RateLimit &limit)
+        {
+            std::atomic_store(&session_config_->global_rate_limit,
+                              limit.enabled() ? std::make_shared<RateBuckets>(limit) : std::shared_ptr<RateBuckets>());
+        }
+
+        /**
+         * @brief 设置每个会话每轮的处理预算
+         *
+         * 会话一次读取中处理的消息数或时间超出预算时暂停读取，剩余数据在之后的事件循环迭代中
+         * 与其他超出预算的会话轮转处理，一个会话的大量小消息不会长时间阻塞其他会话。
+         *
+         * @param packets 每轮最多处理的消息数，0 表示不限制
+         * @param time 每轮最多处理的时间，0 表示不限制
+         */
+        void set_read_budget(size_t packets, std::chrono::microseconds time = std::chrono::microseconds(0))
+        {
+            session_config_->read_budget_packets = packets;
+            session_config_->read_budget_time = time;
+        }
+
+        /**
+         * @brief 设置套接字选项
+         *
+         * 收发缓冲区大小同时设置到监听套接字上，由接受的连接继承；其余选项在接受连接后逐个设置。
+         * 应在 listen() 之前调用。
+         *
+         * @param options 套接字选项
+         */
+        void set_socket_options(const SocketOptions &options) { session_config_->socket_options = options; }
+
+        /**
+         * @brief 接受 Unix 域套接字客户端发起的共享内存传输
+         *
+         * 协商成功后该连接的消息经由共享内存中的环形缓冲区收发，套接字只用来传递通知。
+         * options.polling 为 true 时服务器一侧每次事件循环迭代都检查环形缓冲区，不等待通知。
+         *
+         * @param options 是否接受和是否轮询，环形缓冲区大小由客户端决定
+         */
+        void enable_shared_memory(const ShmOptions &options) { session_config_->shared_memory = options; }
+
+        /**
+         * @brief 确认客户端经 send_durable() 发来的持久化消息
+         *
+         * 每次读取处理完后答复一个 ACK，携带收到过的最大的持久化消息序列号，客户端据此截断持久化日志。
+         * 其他带序列号的消息不确认。
+         * 重连后客户端会重发未确认的消息，处理器需按序列号去重。
+         *
+         * @param enabled 是否确认
+         */
+        void enable_acknowledgements(bool enabled = true) { session_config_->acknowledge = enabled; }
+
+        /**
+         * @brief 设置准入控制
+         *
+         * 按采样间隔测量事件循环延迟和所有会话的缓冲字节数，超过阈值时进入过载状态：
+         * 新连接按 action 暂停接受（留在内核的监听队列中）或接受后立即关闭，
+         * shed_types 中的消息在分发前直接丢弃。应在 start() 之前调用。
+         *
+         * @param limits 阈值，不限制时传入默认值
+         */
+        void set_admission_control(const AdmissionLimits &limits);
+
+        // 准入控制的状态和计数，可在任意线程调用
+        AdmissionMetrics admission_metrics() const { return admission_.metrics(); }
+
+        /**
+         * @brief 线程池，首次调用时创建，用于把耗时的处理移出事件循环
+         *
+         * 不调用时不创建任何工作线程。
+         */
+        ThreadPool &thread_pool() { return thread_pool_.get(); }
+
+        /**
+         * @brief 设置线程池的线程数，0 表示硬件支持的线程数
+         * @return 线程池已创建时返回 false
+         */
+        bool set_thread_pool_size(size_t threads) { return thread_pool_.set_size(threads); }
+
+        /**
+         * @brief 使用调用者共享的线程池，多个服务器和客户端运行时可以共用一个
+         * @return 线程池已创建时返回 false
+         */
+        bool set_thread_pool(std::shared_ptr<ThreadPool> pool) { return thread_pool_.set(std::move(pool)); }
+
+        /**
+         * @brief 添加拦截器，所有会话共享
+         * @param interceptor 拦截器
+         */
+        void add_interceptor(std::shared_ptr<Interceptor> interceptor)
+        {
+            session_config_->interceptors.add_interceptor(std::move(interceptor));
         }
 
         /**
@@ -101,35 +316,157 @@ namespace libuv_net
          * @brief 发送消息到指定会话
          * @param session_id 会话ID
          * @param packet 要发送的消息
+         * @return 会话是否存在
+         */
+        bool send_to(uint64_t session_id, std::shared_ptr<Packet> packet);
+
+        /**
+         * @brief 发送消息到指定会话
+         * @param session_id 十进制表示的会话ID
+         * @param packet 要发送的消息
+         * @return 会话是否存在
+         */
+        bool send_to(const std::string &session_id, std::shared_ptr<Packet> packet);
+
+        /**
+         * @brief 订阅主题
+         * @param session 会话，关闭时自动取消其所有订阅
+         * @param topic 主题
+         * @return 是否新增了订阅
          */
-        void send_to(const std::string &session_id, std::shared_ptr<Packet> packet);
+        bool subscribe(const std::shared_ptr<Session> &session, const std::string &topic);
+
+        /**
+         * @brief 取消订阅主题
+         * @param session 会话
+         * @param topic 主题
+         * @return 是否存在该订阅
+         */
+        bool unsubscribe(const std::shared_ptr<Session> &session, const std::string &topic);
+
+        /**
+         * @brief 发布消息到主题
+         *
+         * 消息只编码一次，编码后的帧由所有订阅者共享，开销与订阅者数量成正比，与连接总数无关。
+         *
+         * @param topic 主题
+         * @param packet 要发布的消息
+         * @return 订阅者数量
+         */
+        size_t publish(const std::string &topic, std::shared_ptr<Packet> packet);
+
+        /**
+         * @brief 使用编解码器发布数据到主题
+         * @param topic 主题
+         * @param value 要发布的数据，编解码器在编译期确定
+         * @return 订阅者数量
+         */
+        template <PacketType Type, typename T>
+        size_t publish(const std::string &topic, const T &value)
+        {
+            if (topics_.subscriber_count(topic) == 0)
+            {
+                return 0;
+            }
+
+            std::vector<uint8_t> data;
+            if (!Codec<T>::encode(value, data))
+            {
+                spdlog::error("消息编码失败，类型: {}", static_cast<int>(Type));
+                return 0;
+            }
+            return publish_frame(topic, make_shared_frame(Type, data.data(), data.size()));
+        }
+
+        // 主题的订阅者数量
+        size_t subscriber_count(const std::string &topic) const { return topics_.subscriber_count(topic); }
+
+        /**
+         * @brief 查找会话
+         * @param session_id 会话ID
+         * @return 会话，不存在时返回空指针
+         */
+        std::shared_ptr<Session> find_session(uint64_t session_id) const;
+
+        // 获取当前会话数
+        size_t session_count() const { return sessions_.size(); }
+
+        /**
+         * @brief 预先分配会话槽位
+         *
+         * 预先分配 count 个会话的内存块并预留会话表的容量，连接数在该范围内时
+         * 接受连接不再向分配器申请会话内存，也不会触发会话表扩容。应在 start() 之前调用。
+         *
+         * @param count 会话数量
+         */
+        void reserve_sessions(size_t count)
+        {
+            session_pool_.reserve(count);
+            sessions_.reserve(count);
+        }
 
     private:
         // libuv 回调函数
         static void on_connection(uv_stream_t *server, int status);
         static void on_close(uv_handle_t *handle);
+        static void on_heartbeat_timer(uv_timer_t *handle);
+        static void on_admission_timer(uv_timer_t *handle);
+        static void on_wakeup_timer(uv_timer_t *handle);
+
+        // 将服务器的消息回调包装为会话配置中的回调
+        static SessionConfig::PacketHandler wrap_packet_handler(PacketHandler handler)
+        {
+            if (!handler)
+            {
+                return nullptr;
+            }
+            return [handler = std::move(handler)](Session &session, std::shared_ptr<Packet> packet)
+            { handler(session.shared_from_this(), std::move(packet)); };
+        }
 
         // 内部处理函数
-        void handle_new_session(uv_tcp_t *client);
+        void handle_new_session(uv_stream_t *listener);
+        // 过载时暂停接受或拒绝新连接
+        void refuse_connection(uv_stream_t *listener);
+        // 不再过载时接受暂停期间到达的连接
+        void resume_accepting();
         void on_session_closed(std::shared_ptr<Session> session);
+        // 为会话分配数据报通道的令牌并答复客户端
+        void bind_datagram(Session &session);
+        void on_datagram(const sockaddr *addr, uint64_t token, uint64_t counter, const uint8_t *data, size_t size);
+        size_t publish_frame(const std::string &topic, const SharedFrame &frame);
         void on_read(std::shared_ptr<Session> session, ssize_t nread, const uv_buf_t *buf);
         uv_buf_t on_alloc(uv_handle_t *handle, size_t suggested_size);
 
         // 成员变量
         uv_loop_t *loop_;                         // libuv 事件循环
         uv_tcp_t server_;                         // TCP 服务器句柄
-        std::unique_ptr<ThreadPool> thread_pool_; // 线程池
+        uv_pipe_t pipe_server_;                   // Unix 域套接字服务器句柄
+        std::string unix_path_;                   // 正在监听的 Unix 域套接字路径
+        uv_timer_t wakeup_timer_;                 // 定时唤醒事件循环，检查停止标志
+        uv_timer_t heartbeat_timer_;              // 所有会话共用的心跳定时器
+        std::unique_ptr<ReadScheduler> read_scheduler_; // 读取的轮转调度器
+        uv_timer_t admission_timer_;              // 准入控制的采样定时器
+        AdmissionControl admission_;              // 准入控制
+        uint64_t last_admission_sample_{0};       // 上次采样的时间（纳秒），0 表示尚未采样
+        std::vector<uv_stream_t *> pending_accepts_; // 因过载尚未接受连接的监听句柄
+        std::unique_ptr<DatagramSocket> datagram_;   // 数据报通道的 UDP 套接字
+        std::unordered_map<uint64_t, uint64_t> datagram_sessions_; // 数据报令牌到会话ID的索引
+        LazyThreadPool thread_pool_;              // 线程池，首次使用时创建
         std::thread loop_thread_;                 // 事件循环线程
         bool should_stop_{false};                 // 是否应该停止事件循环
 
-        std::vector<std::shared_ptr<Session>> sessions_; // 会话列表
+        std::unordered_map<uint64_t, std::shared_ptr<Session>> sessions_; // 会话ID到会话的索引
+        SessionPool session_pool_;                                        // 会话对象池
+        TopicIndex topics_;                                               // 主题订阅索引
         std::mutex sessions_mutex_;                      // 会话映射表互斥锁
 
         // 回调函数
-        SessionHandler connect_handler_;                      // 连接处理回调
-        SessionHandler close_handler_;                        // 关闭处理回调
-        std::map<PacketType, PacketHandler> packet_handlers_; // 消息处理回调
-        PacketHandler default_packet_handler_;                // 默认消息处理回调
+        SessionHandler connect_handler_; // 连接处理回调
+        SessionHandler close_handler_;   // 关闭处理回调
+
+        // 所有会话共享的处理器表、拦截器、编解码器和帧大小限制
+        std::shared_ptr<SessionConfig> session_config_;
 
         bool is_listening_{false}; // 服务器是否正在监听
     };
@@ -6,13 +6,120 @@
 #include <uv.h>
 #include <vector>
 #include "libuv_net/message.hpp"
+#include "libuv_net/codec.hpp"
+#include "libuv_net/frame_pool.hpp"
+#include "libuv_net/rate_limit.hpp"
+#include "libuv_net/admission_control.hpp"
+#include "libuv_net/socket_options.hpp"
+#include "libuv_net/shm_channel.hpp"
+#include "libuv_net/datagram.hpp"
 #include <spdlog/spdlog.h>
-#include <map>
+#include <list>
+#include <atomic>
 #include <chrono>
 
 namespace libuv_net
 {
 
+    class Session;
+    class ReadScheduler;
+
+    /**
+     * @brief 会话的处理器表和参数
+     *
+     * 服务器构建一份，所有会话共享同一个实例，每个连接不再各自持有处理器表、拦截器和闭包。
+     * 会话自身修改处理器或参数时先复制一份（写时复制），不影响共享该实例的其他会话。
+     */
+    struct SessionConfig
+    {
+        using PacketHandler = std::function<void(Session &, std::shared_ptr<Packet>)>;
+        using ChunkHandler = std::function<void(Session &, const PacketHeader &, const uint8_t *, size_t, bool)>;
+        using CloseHandler = std::function<void(Session &)>;
+        using ReadHandler = std::function<void(ssize_t, const uv_buf_t *)>;
+        using AllocCallback = std::function<uv_buf_t(size_t)>;
+
+        DispatchTable<PacketHandler> packet_handlers; // 消息处理回调
+        PacketHandler default_packet_handler;         // 默认消息处理回调
+        DispatchTable<ChunkHandler> chunk_handlers;   // 流式消息分块回调
+        CloseHandler close_handler;                   // 关闭处理回调
+        ReadHandler read_handler;                     // 读取处理回调，设置后替代内置的分帧
+        AllocCallback alloc_callback;                 // 读取缓冲区分配回调
+        InterceptorManager interceptors;              // 拦截器管理器
+        CodecTable codecs;                            // 编解码器登记表
+
+        uint32_t max_frame_size{DEFAULT_MAX_FRAME_SIZE};        // 整帧缓存的最大消息长度
+        size_t stream_window_size{DEFAULT_STREAM_WINDOW_SIZE}; // 流式收发的窗口大小
+
+        RateLimit rate_limit;                           // 每个会话的入站限流
+        DispatchTable<RateLimit> type_rate_limits;      // 每个会话按消息类型的入站限流
+        std::shared_ptr<RateBuckets> global_rate_limit; // 所有会话共享的入站限流，只经 std::atomic_load/atomic_store 访问
+
+        ReadScheduler *read_scheduler = nullptr;      // 读取的轮转调度器，为空时不限制每轮的处理量
+        size_t read_budget_packets = 0;               // 每个会话每轮最多处理的消息数，0 表示不限制
+        std::chrono::microseconds read_budget_time{0}; // 每个会话每轮最多处理的时间，0 表示不限制
+
+        AdmissionControl *admission = nullptr; // 准入控制，过载时丢弃低优先级类型的消息
+
+        SocketOptions socket_options; // 套接字选项，由 apply_socket_options() 应用
+
+        ShmOptions shared_memory; // 是否接受对端发起的共享内存传输，以及本端是否轮询
+
+        // 是否确认对端经连接发来的持久化消息（消息头带 PACKET_FLAG_DURABLE）：
+        // 有新的持久化消息时，每次读取处理完后答复一个 ACK，携带收到过的最大序列号。其他带序列号的消息不确认
+        bool acknowledge = false;
+
+        // 所有会话共享的令牌桶，服务器运行期间可能被其他线程替换
+        std::shared_ptr<RateBuckets> load_global_rate_limit() const
+        {
+            return std::atomic_load(&global_rate_limit);
+        }
+
+        // 是否配置了每个会话或按消息类型的入站限流
+        bool session_rate_limited() const
+        {
+            return rate_limit.enabled() || !type_rate_limits.empty();
+        }
+
+        // 设置消息处理回调
+        void set_packet_handler(PacketType type, PacketHandler handler)
+        {
+            packet_handlers.set(type, std::move(handler));
+            codecs.set_typed_handler(type, false);
+        }
+
+        /**
+         * @brief 设置类型化消息处理回调
+         *
+         * 值类型由处理器的最后一个参数推导，编解码器在编译期确定，
+         * 解码结果缓存在数据包上，每个消息只解码一次，以引用传给处理器，解码失败的消息被丢弃。
+         *
+         * @param handler 形如 void(Session &, const T &) 的回调
+         */
+        template <PacketType Type, typename F>
+        void on(F &&handler)
+        {
+            using T = detail::handler_value_t<F>;
+            static_assert(detail::has_codec<T>::value, "未为该类型特化 libuv_net::Codec");
+            packet_handlers.set(Type, [handler = std::forward<F>(handler)](Session &session, std::shared_ptr<Packet> packet) mutable
+                                {
+                auto value = packet->template as<T>();
+                if (!value)
+                {
+                    spdlog::warn("消息解码失败，类型: {}", static_cast<int>(Type));
+                    return;
+                }
+                handler(session, *value); });
+            codecs.set_typed_handler(Type, true);
+        }
+    };
+
+    // 会话的传输方式
+    enum class Transport : uint8_t
+    {
+        TCP, // TCP 套接字（uv_tcp_t）
+        PIPE // Unix 域套接字或 Windows 命名管道（uv_pipe_t）
+    };
+
     /**
      * @brief 会话类
      *
@@ -22,6 +129,7 @@ namespace libuv_net
      * - 错误处理
      * - 心跳检测
      * - 数据格式拦截器
+     * - 大消息的流式分块收发
      */
     class Session : public std::enable_shared_from_this<Session>
     {
@@ -33,9 +141,12 @@ namespace libuv_net
         // 读取处理回调函数类型
         using ReadHandler = std::function<void(ssize_t, const uv_buf_t *)>;
 
-        // 构造函数
-        explicit Session(uv_loop_t *loop);
-        Session(uv_loop_t *loop, uv_tcp_t *client);
+        // 构造函数，config 为空时使用独立的默认配置
+        explicit Session(uv_loop_t *loop, std::shared_ptr<SessionConfig> config = nullptr);
+        Session(uv_loop_t *loop, Transport transport, std::shared_ptr<SessionConfig> config = nullptr);
+        // 从监听句柄接受连接
+        Session(uv_loop_t *loop, uv_tcp_t *client, std::shared_ptr<SessionConfig> config = nullptr);
+        Session(uv_loop_t *loop, uv_pipe_t *client, std::shared_ptr<SessionConfig> config = nullptr);
         ~Session();
 
         // 禁用拷贝构造和赋值
@@ -44,33 +155,52 @@ namespace libuv_net
 
         /**
          * @brief 获取会话ID
+         *
+         * 进程内单调递增，不会因会话对象的地址被复用而重复。
+         *
          * @return 会话ID
          */
-        std::string id() const { return id_; }
+        uint64_t id() const { return id_; }
+
+        // 获取会话配置
+        const SessionConfig &config() const { return *config_; }
+
+        // 替换会话配置，通常由服务器在会话启动前设置共享的配置
+        void set_config(std::shared_ptr<SessionConfig> config) { config_ = std::move(config); }
 
         // 设置回调函数
         void set_alloc_callback(std::function<uv_buf_t(size_t)> callback)
         {
-            alloc_callback_ = std::move(callback);
+            mutable_config().alloc_callback = std::move(callback);
         }
 
         void set_read_callback(ReadHandler handler)
         {
-            read_handler_ = std::move(handler);
+            mutable_config().read_handler = std::move(handler);
         }
 
         void set_close_callback(CloseHandler handler)
         {
-            close_handler_ = std::move(handler);
+            set_close_handler(std::move(handler));
         }
 
         // 启动会话
         void start()
         {
+            last_heartbeat_time_ = std::chrono::steady_clock::now();
             start_read();
-            start_heartbeat();
         }
 
+        /**
+         * @brief 心跳检查，由持有会话的服务器或客户端按心跳间隔统一调用
+         *
+         * 超过心跳超时时间未收到心跳时关闭会话，否则发送一个心跳包。
+         *
+         * @param now 当前时间
+         * @return 会话是否仍然存活
+         */
+        bool check_heartbeat(std::chrono::steady_clock::time_point now);
+
         // 开始读取数据
         int start_read();
         // 停止读取数据
@@ -80,23 +210,122 @@ namespace libuv_net
         // 发送消息
         void send(std::shared_ptr<Packet> packet);
 
-        // 发送数据（使用拦截器）
+        /**
+         * @brief 流式发送大消息
+         *
+         * 先发送消息头，再按窗口大小分块从 source 拉取消息体，
+         * 上一块写入完成后才拉取下一块，内存占用不超过一个窗口。
+         * 流发送期间的其他消息会排队，待流结束后按顺序发出。
+         *
+         * @param type 消息类型
+         * @param length 消息体总长度
+         * @param source 数据源回调
+         * @param sequence 序列号
+         * @return 是否成功提交
+         */
+        bool send_stream(PacketType type, uint32_t length, ChunkSource source, uint32_t sequence = 0);
+
+        /**
+         * @brief 发送数据（使用拦截器）
+         *
+         * 拦截器的接口返回 std::vector，消息体先序列化到该向量，再拷贝进帧缓冲区一次；
+         * 只有实现了 encoded_size/encode_to 的 Codec<T> 经 send<Type>() 直接编码进帧缓冲区。
+         */
         template <typename T>
         void send_data(PacketType type, const T &data)
         {
-            auto interceptor = interceptor_manager_.get_interceptor(type);
+            auto interceptor = config_->interceptors.get_interceptor(type);
             if (interceptor)
             {
                 auto serialized_data = interceptor->serialize(data);
-                auto packet = std::make_shared<Packet>(type, serialized_data);
-                send(packet);
+                send_frame(type, serialized_data.size(), [&serialized_data](uint8_t *out, size_t size)
+                           {
+                               if (size > 0)
+                               {
+                                   std::memcpy(out, serialized_data.data(), size);
+                               }
+                               return true; });
             }
         }
 
-        // 获取底层 socket
-        uv_tcp_t &get_socket() { return socket_; }
+        /**
+         * @brief 直接在帧缓冲区中写入消息体并发送
+         *
+         * 帧缓冲区来自调用线程的 FramePool，写入完成后归还到同一个池。帧已预留消息头的位置，
+         * writer 把消息体写到 out 指向的 size 字节中，消息体只在写入套接字时拷贝一次。
+         *
+         * @param type 消息类型
+         * @param size 消息体长度
+         * @param writer 形如 bool(uint8_t *out, size_t size) 的回调，返回 false 时放弃发送
+         * @param sequence 序列号
+         * @return 是否成功提交
+         */
+        template <typename Writer>
+        bool send_frame(PacketType type, size_t size, Writer &&writer, uint32_t sequence = 0)
+        {
+            if (is_closing_ || size > UINT32_MAX)
+            {
+                return false;
+            }
+
+            const auto &pool = FramePool::local();
+            auto frame = pool->acquire(sizeof(PacketHeader) + size);
+            write_packet_header(frame.data(), type, static_cast<uint32_t>(size), sequence);
+            if (!writer(frame.data() + sizeof(PacketHeader), size))
+            {
+                pool->release(std::move(frame));
+                return false;
+            }
+            write_frame(std::move(frame), pool);
+            return true;
+        }
+
+        /**
+         * @brief 发送已编码的共享消息帧
+         *
+         * 帧缓冲区由所有发送它的会话共享，写入完成前保持存活，发布到多个会话时只编码一次。
+         *
+         * @param frame 完整的消息帧（含消息头）
+         */
+        void send_frame(SharedFrame frame);
+
+        // 使用编解码器发送数据，编解码器在编译期确定
+        template <PacketType Type, typename T>
+        void send(const T &value)
+        {
+            bool sent = false;
+            if constexpr (detail::has_sized_encode<T>::value)
+            {
+                // 直接编码进帧缓冲区
+                sent = send_frame(Type, Codec<T>::encoded_size(value), [&value](uint8_t *out, size_t size)
+                                  { return Codec<T>::encode_to(value, out, size); });
+            }
+            else
+            {
+                std::vector<uint8_t> data;
+                sent = Codec<T>::encode(value, data) &&
+                       send_frame(Type, data.size(), [&data](uint8_t *out, size_t size)
+                                  {
+                                      std::memcpy(out, data.data(), size);
+                                      return true; });
+            }
+            if (!sent && !is_closing_)
+            {
+                spdlog::error("消息编码失败，类型: {}", static_cast<int>(Type));
+            }
+        }
 
-        // 获取远程地址
+        // 获取底层 socket，仅用于 TCP 会话
+        uv_tcp_t &get_socket() { return socket_.tcp; }
+        // 获取底层管道，仅用于 Unix 域套接字会话
+        uv_pipe_t &get_pipe() { return socket_.pipe; }
+        // 获取底层的流句柄
+        uv_stream_t *get_stream() { return reinterpret_cast<uv_stream_t *>(&socket_); }
+
+        // 获取传输方式
+        Transport transport() const { return transport_; }
+
+        // 获取远程地址，Unix 域套接字会话为套接字路径
         const std::string &get_remote_address() const { return remote_address_; }
         // 获取远程端口
         uint16_t get_remote_port() const { return remote_port_; }
@@ -104,17 +333,161 @@ namespace libuv_net
         // 设置消息处理回调
         void set_packet_handler(PacketType type, PacketHandler handler)
         {
-            packet_handlers_[type] = std::move(handler);
+            SessionConfig::PacketHandler wrapped;
+            if (handler)
+            {
+                wrapped = [handler = std::move(handler)](Session &, std::shared_ptr<Packet> packet)
+                { handler(std::move(packet)); };
+            }
+            mutable_config().set_packet_handler(type, std::move(wrapped));
+        }
+
+        /**
+         * @brief 设置类型化消息处理回调
+         *
+         * 值类型由处理器的最后一个参数推导，编解码器在编译期确定，
+         * 解码结果缓存在数据包上，每个消息只解码一次，以引用传给处理器，解码失败的消息被丢弃。
+         *
+         * @param handler 形如 void(Session &, const T &) 的回调
+         */
+        template <PacketType Type, typename F>
+        void on(F &&handler)
+        {
+            mutable_config().on<Type>(std::forward<F>(handler));
+        }
+
+        // 登记编解码器，交给普通处理器的该类型消息先做解码校验
+        template <PacketType Type, typename T>
+        void register_codec()
+        {
+            mutable_config().codecs.register_codec<T>(Type);
         }
 
         // 设置默认消息处理回调
         void set_default_packet_handler(PacketHandler handler)
         {
-            default_packet_handler_ = std::move(handler);
+            SessionConfig::PacketHandler wrapped;
+            if (handler)
+            {
+                wrapped = [handler = std::move(handler)](Session &, std::shared_ptr<Packet> packet)
+                { handler(std::move(packet)); };
+            }
+            mutable_config().default_packet_handler = std::move(wrapped);
         }
 
         // 设置关闭处理回调
-        void set_close_handler(CloseHandler handler) { close_handler_ = std::move(handler); }
+        void set_close_handler(CloseHandler handler)
+        {
+            SessionConfig::CloseHandler wrapped;
+            if (handler)
+            {
+                wrapped = [handler = std::move(handler)](Session &)
+                { handler(); };
+            }
+            mutable_config().close_handler = std::move(wrapped);
+        }
+
+        // 设置流式消息分块回调，该类型的消息不再整帧缓存，而是按块交付
+        void set_chunk_handler(PacketType type, ChunkHandler handler)
+        {
+            SessionConfig::ChunkHandler wrapped;
+            if (handler)
+            {
+                wrapped = [handler = std::move(handler)](Session &, const PacketHeader &header, const uint8_t *data, size_t size, bool last)
+                { handler(header, data, size, last); };
+            }
+            mutable_config().chunk_handlers.set(type, std::move(wrapped));
+        }
+
+        // 设置整帧缓存的最大消息长度，超出的消息头在解析时即被拒绝
+        void set_max_frame_size(uint32_t size) { mutable_config().max_frame_size = size; }
+        uint32_t max_frame_size() const { return config_->max_frame_size; }
+
+        // 设置流式收发的窗口大小
+        void set_stream_window_size(size_t size) { mutable_config().stream_window_size = size > 0 ? size : 1; }
+        size_t stream_window_size() const { return config_->stream_window_size; }
+
+        /**
+         * @brief 设置入站限流
+         *
+         * 超出限额时暂停读取（uv_read_stop），已读到的数据留在缓冲区中，令牌补足后继续处理并恢复读取。
+         *
+         * @param limit 每个会话的限流参数
+         */
+        void set_rate_limit(const RateLimit &limit) { mutable_config().rate_limit = limit; }
+
+        // 设置某一消息类型的入站限流
+        void set_rate_limit(PacketType type, const RateLimit &limit) { mutable_config().type_rate_limits.set(type, limit); }
+
+        // 设置套接字选项，连接建立后由 apply_socket_options() 应用
+        void set_socket_options(const SocketOptions &options) { mutable_config().socket_options = options; }
+
+        // 将配置中的套接字选项应用到已连接的套接字，只对 TCP 会话生效
+        int apply_socket_options()
+        {
+            return transport_ == Transport::TCP ? libuv_net::apply_socket_options(&socket_.tcp, config_->socket_options) : 0;
+        }
+
+        /**
+         * @brief 提议改用共享内存传输，只用于 Unix 域套接字会话
+         *
+         * 创建共享内存段并把名称发给对端，对端同意后双方改由共享内存中的环形缓冲区收发消息，
+         * 套接字只用来传递通知；对端拒绝时继续使用套接字。等待答复期间发送的消息暂存，答复后按顺序发出。
+         *
+         * @param options 环形缓冲区大小和是否轮询
+         * @return 是否已发出提议
+         */
+        bool offer_shared_memory(const ShmOptions &options);
+
+        // 是否已改用共享内存传输
+        bool is_shared_memory() const;
+
+        /**
+         * @brief 以不可靠的方式发送消息
+         *
+         * 数据报通道可用时经 UDP 发出，可能丢失、乱序，但不会因重传而延迟。
+         * 序列号由会话按消息类型递增分配（忽略 packet 中的序列号），接收方丢弃比已收到的同类型消息更旧的消息，
+         * 适合会被下一条消息取代的数据（如位置、指标）。数据报通道未建立时经可靠的连接发送。
+         *
+         * @param packet 要发送的消息
+         * @return 是否已提交
+         */
+        bool send_unreliable(std::shared_ptr<Packet> packet);
+
+        /**
+         * @brief 关联数据报通道，由服务器或客户端在协商令牌后调用
+         *
+         * @param socket 数据报套接字，由服务器或客户端持有，会话关闭前保持有效
+         * @param token 连接令牌
+         */
+        void attach_datagram(DatagramSocket *socket, uint64_t token);
+
+        // 记录对端的数据报地址，套接字未连接对端时收到对端的数据报后才能发送；
+        // 只接受发送计数大于之前所有数据报的来源，重放的数据报不改变对端地址
+        void set_datagram_peer(const sockaddr *addr, uint64_t counter);
+
+        // 数据报通道的令牌，未关联时为 0
+        uint64_t datagram_token() const;
+
+        // 数据报通道是否可以发送
+        bool has_datagram() const;
+
+        // 处理数据报中的消息帧，使用与连接相同的处理器
+        void receive_datagram(const uint8_t *data, size_t size);
+
+        // 读取是否被暂停（限流或调用了 stop()）
+        bool is_read_paused() const { return read_pause_ != 0; }
+
+        /**
+         * @brief 缓冲中的字节数
+         *
+         * 包括已提交但尚未写入套接字的数据、排队等待发送的消息和暂存区中尚未处理的数据。
+         * 需遍历发送队列，只用于定时采样。
+         */
+        size_t buffered_bytes() const;
+
+        // 会话是否已关闭（关闭回调已执行）
+        bool is_closed() const { return is_closed_; }
 
         // 处理接收到的数据
         void append_to_buffer(const char *data, size_t len);
@@ -122,51 +495,132 @@ namespace libuv_net
         // 添加拦截器
         void add_interceptor(std::shared_ptr<Interceptor> interceptor)
         {
-            interceptor_manager_.add_interceptor(std::move(interceptor));
+            mutable_config().interceptors.add_interceptor(std::move(interceptor));
+        }
+
+        // 设置拦截器管理器
+        void set_interceptor_manager(const InterceptorManager &manager)
+        {
+            mutable_config().interceptors = manager;
         }
 
     private:
+        friend class ReadScheduler;
+        struct WriteRequest;
+        struct OutboundItem;
+        struct RateState;
+        struct ShmState;
+        struct DatagramState;
+
+        // 暂停读取的原因，任一原因存在时都不读取
+        enum ReadPause : uint8_t
+        {
+            PAUSE_STOPPED = 1 << 0,    // 调用了 stop()
+            PAUSE_RATE_LIMIT = 1 << 1, // 入站限流
+            PAUSE_BUDGET = 1 << 2      // 本轮处理预算用完，等待调度器轮转
+        };
+
         static void on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf);
         static void on_read(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf);
         static void on_close(uv_handle_t *handle);
         static void on_write(uv_write_t *req, int status);
-        static void on_heartbeat_timer(uv_timer_t *handle);
+        // 写入完成：继续发送流或归还帧缓冲区
+        void complete_write(std::unique_ptr<WriteRequest> request);
 
-        // 处理接收到的数据
-        void process_buffer();
+        // 共享配置被其他会话引用时先复制一份
+        SessionConfig &mutable_config();
+        // 解析数据中的完整消息，返回已处理的字节数
+        size_t process_data(const uint8_t *data, size_t size);
+        // 处理暂存区中的数据
+        void process_pending();
+        // 按暂停原因停止和恢复读取
+        void pause_reading(uint8_t reason);
+        void resume_reading(uint8_t reason);
+        // 检查入站限流，超出时暂停读取并安排恢复；pause 为 false 时只返回结果，由调用方丢弃消息
+        bool admit(PacketType type, size_t packets, size_t bytes, bool pause = true);
+        static void on_rate_timer(uv_timer_t *handle);
         // 处理消息
         void handle_packet(std::shared_ptr<Packet> packet);
-        // 启动心跳检测
-        void start_heartbeat();
-        // 停止心跳检测
-        void stop_heartbeat();
         // 发送心跳包
         void send_heartbeat();
+        // 记录收到的持久化消息的序列号，保留其中最大的
+        void record_durable(const PacketHeader &header);
+        // 答复收到的最大的持久化消息序列号
+        void flush_ack();
+        // 处理共享内存的协商消息
+        void handle_shm_handshake(const Packet &packet);
+        void send_shm_handshake(uint8_t op, size_t ring_size, const std::string &name);
+        // 改用共享内存传输
+        void activate_shm();
+        // 读取环形缓冲区中的数据
+        void drain_shm();
+        // 把暂存的写请求写入环形缓冲区
+        void flush_shm();
+        // 通过套接字通知对端
+        void ring_doorbell();
+        static void on_shm_idle(uv_idle_t *handle);
+        // 写出一个完整的消息帧（流发送期间排队）
+        void write_frame(std::vector<uint8_t> frame, std::shared_ptr<FramePool> pool);
+        // 提交一次 uv_write
+        bool submit_write(std::vector<uint8_t> data, bool stream_chunk, std::shared_ptr<FramePool> pool = nullptr);
+        bool submit_write(SharedFrame frame);
+        bool submit_request(WriteRequest *request, const std::vector<uint8_t> &data);
+        // 开始发送一个流
+        void start_stream(std::unique_ptr<OutboundItem> stream);
+        // 拉取并写出流的下一块
+        void pump_stream();
+        // 流的一块写入完成
+        void on_stream_chunk_written(std::vector<uint8_t> buffer);
+        // 发送排队中的消息
+        void flush_outbound_queue();
+
+        // 套接字句柄，两种句柄都以 uv_stream_t 开头，可以统一按流读写
+        union Socket
+        {
+            uv_tcp_t tcp;
+            uv_pipe_t pipe;
+        };
 
         uv_loop_t *loop_;
-        uv_tcp_t socket_;
-        std::string id_;
-        std::function<uv_buf_t(size_t)> alloc_callback_;
-        ReadHandler read_handler_;
-        CloseHandler close_handler_;
+        Socket socket_;
+        Transport transport_;
+        uint64_t id_;
+        std::shared_ptr<SessionConfig> config_; // 处理器表和参数，通常由服务器的所有会话共享
         bool is_closing_ = false;
+        bool is_closed_ = false;
+        bool is_reading_ = false; // 是否已调用 uv_read_start
+        uint8_t read_pause_ = 0;  // 暂停读取的原因
 
         std::string remote_address_; // 远程地址
-        uint16_t remote_port_;       // 远程端口
+        uint16_t remote_port_{0};    // 远程端口
 
-        std::vector<uint8_t> read_buffer_;    // 读取缓冲区
-        std::vector<uint8_t> message_buffer_; // 消息缓冲区
+        // 暂存区：跨越多次读取的不完整消息和暂停读取时尚未处理的数据，处理完后释放
+        std::vector<uint8_t> read_buffer_;
 
-        // 消息处理回调
-        std::map<PacketType, PacketHandler> packet_handlers_;
-        PacketHandler default_packet_handler_;
+        // 限流状态，只在配置了限流时分配
+        std::unique_ptr<RateState> rate_state_;
 
-        // 拦截器管理器
-        InterceptorManager interceptor_manager_;
+        // 共享内存传输的状态，只在协商时分配
+        std::unique_ptr<ShmState> shm_;
 
-        // 心跳相关
-        uv_timer_t heartbeat_timer_;
+        // 数据报通道的状态，只在关联时分配
+        std::unique_ptr<DatagramState> datagram_;
+
+        // 正在接收的流
+        bool inbound_streaming_{false};
+        PacketHeader inbound_header_{};
+        uint32_t inbound_remaining_{0};
+
+        // 正在发送的流及其后排队的消息
+        std::unique_ptr<OutboundItem> outbound_stream_;
+        std::list<std::unique_ptr<OutboundItem>> outbound_queue_;
+
+        // 最后收到心跳的时间
         std::chrono::steady_clock::time_point last_heartbeat_time_;
+
+        // 收到的最大的持久化消息序列号，ack_pending_ 表示尚未答复
+        uint32_t ack_sequence_{0};
+        bool ack_pending_{false};
     };
 
 } // namespace libuv_net
\ No newline at end of file
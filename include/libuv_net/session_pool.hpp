@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include "libuv_net/session.hpp"
+
+namespace libuv_net
+{
+    /**
+     * @brief 会话对象池
+     *
+     * 会话连同 shared_ptr 的控制块一起分配在池中的定长内存块上，会话析构后内存块回到池中，
+     * 下一个连接直接复用，连接频繁断开重连时不再反复向分配器申请和归还内存。
+     * 会话只在关闭回调执行之后才会析构，复用的内存块上重新构造会话时 libuv 句柄随之重新初始化。
+     *
+     * 每个事件循环一个池；会话可能在其他线程释放最后一个引用，归还内存块时加锁。
+     */
+    class SessionPool
+    {
+    public:
+        // 默认最多缓存的空闲内存块数量
+        static constexpr size_t DEFAULT_MAX_CACHED = 1024;
+        // 内存块大小：会话加上控制块（引用计数和分配器）的余量
+        static constexpr size_t BLOCK_SIZE = sizeof(Session) + 64;
+
+        // 构造函数
+        explicit SessionPool(size_t max_cached = DEFAULT_MAX_CACHED)
+            : state_(std::make_shared<State>(max_cached))
+        {
+        }
+
+        /**
+         * @brief 预先分配内存块
+         * @param count 内存块数量，同时提高最多缓存的数量
+         */
+        void reserve(size_t count)
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            state_->max_cached = std::max(state_->max_cached, count);
+            state_->free_blocks.reserve(count);
+            while (state_->free_blocks.size() < count)
+            {
+                state_->free_blocks.push_back(::operator new(BLOCK_SIZE));
+            }
+        }
+
+        // 在池中创建会话
+        template <typename... Args>
+        std::shared_ptr<Session> create(Args &&...args)
+        {
+            return std::allocate_shared<Session>(Allocator<Session>(state_), std::forward<Args>(args)...);
+        }
+
+        // 当前空闲的内存块数量
+        size_t cached() const
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            return state_->free_blocks.size();
+        }
+
+    private:
+        // 池的状态由分配器共享，会话可以比池的持有者存活更久
+        struct State
+        {
+            explicit State(size_t max) : max_cached(max) {}
+
+            ~State()
+            {
+                for (void *block : free_blocks)
+                {
+                    ::operator delete(block);
+                }
+            }
+
+            void *allocate(size_t size)
+            {
+                if (size > BLOCK_SIZE)
+                {
+                    return ::operator new(size);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!free_blocks.empty())
+                    {
+                        void *block = free_blocks.back();
+                        free_blocks.pop_back();
+                        return block;
+                    }
+                }
+                return ::operator new(BLOCK_SIZE);
+            }
+
+            void deallocate(void *block, size_t size)
+            {
+                if (size <= BLOCK_SIZE)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (free_blocks.size() < max_cached)
+                    {
+                        free_blocks.push_back(block);
+                        return;
+                    }
+                }
+                ::operator delete(block);
+            }
+
+            std::mutex mutex;
+            std::vector<void *> free_blocks;
+            size_t max_cached;
+        };
+
+        // 供 allocate_shared 使用的分配器
+        template <typename T>
+        struct Allocator
+        {
+            using value_type = T;
+
+            explicit Allocator(std::shared_ptr<State> state) : state(std::move(state)) {}
+
+            template <typename U>
+            Allocator(const Allocator<U> &other) : state(other.state)
+            {
+            }
+
+            T *allocate(size_t n)
+            {
+                static_assert(alignof(T) <= alignof(std::max_align_t), "会话池不支持超对齐的类型");
+                return static_cast<T *>(state->allocate(n * sizeof(T)));
+            }
+
+            void deallocate(T *p, size_t n)
+            {
+                state->deallocate(p, n * sizeof(T));
+            }
+
+            template <typename U>
+            bool operator==(const Allocator<U> &other) const { return state == other.state; }
+
+            template <typename U>
+            bool operator!=(const Allocator<U> &other) const { return state != other.state; }
+
+            std::shared_ptr<State> state;
+        };
+
+        std::shared_ptr<State> state_;
+    };
+
+} // namespace libuv_net
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace libuv_net
+{
+    /**
+     * @brief 共享内存传输的参数
+     */
+    struct ShmOptions
+    {
+        bool enabled = false;       // 是否使用共享内存传输
+        size_t ring_size = 1 << 20; // 每个方向环形缓冲区的大小，向上取整为 2 的幂
+        bool polling = false;       // 轮询模式：每次事件循环迭代都检查环形缓冲区，不等待通知，适合独占核心
+    };
+
+    // 环形缓冲区的控制字段，生产者和消费者的字段分别独占缓存行
+    struct ShmRingHeader
+    {
+        alignas(64) std::atomic<uint64_t> tail;     // 生产者写入的位置
+        std::atomic<uint32_t> reader_waiting;       // 消费者等待通知
+        alignas(64) std::atomic<uint64_t> head;     // 消费者读取的位置
+        std::atomic<uint32_t> writer_waiting;       // 生产者因缓冲区满等待通知
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                  "共享内存中的原子变量必须是无锁的");
+
+    /**
+     * @brief 共享内存中的单生产者单消费者字节环形缓冲区
+     *
+     * 只保存位置，不拷贝数据以外的任何内容；帧按字节流写入，可以跨越缓冲区末尾，
+     * 由会话现有的分帧逻辑拼接。等待标志用于减少通知：只有对方正在等待时才需要唤醒。
+     */
+    class ShmRing
+    {
+    public:
+        ShmRing() = default;
+        ShmRing(ShmRingHeader *header, uint8_t *data, size_t capacity)
+            : header_(header), data_(data), capacity_(capacity)
+        {
+        }
+
+        // 写入尽可能多的数据，返回写入的字节数
+        size_t write(const uint8_t *data, size_t size)
+        {
+            // 设置 writer_waiting 之后的重试依赖这次读取与标志的写入保持全序，见 empty()
+            uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+            uint64_t head = header_->head.load(std::memory_order_seq_cst);
+            size_t count = std::min(size, capacity_ - static_cast<size_t>(tail - head));
+            if (count == 0)
+            {
+                return 0;
+            }
+
+            size_t offset = static_cast<size_t>(tail & (capacity_ - 1));
+            size_t first = std::min(count, capacity_ - offset);
+            std::memcpy(data_ + offset, data, first);
+            std::memcpy(data_, data + first, count - first);
+            header_->tail.store(tail + count, std::memory_order_seq_cst);
+            return count;
+        }
+
+        // 可读的第一段连续数据
+        std::pair<const uint8_t *, size_t> peek() const
+        {
+            uint64_t head = header_->head.load(std::memory_order_relaxed);
+            uint64_t tail = header_->tail.load(std::memory_order_acquire);
+            size_t offset = static_cast<size_t>(head & (capacity_ - 1));
+            size_t count = std::min(static_cast<size_t>(tail - head), capacity_ - offset);
+            return {data_ + offset, count};
+        }
+
+        // 释放已读取的数据
+        void consume(size_t size)
+        {
+            header_->head.fetch_add(size, std::memory_order_seq_cst);
+        }
+
+        /**
+         * @brief 缓冲区是否为空，设置 reader_waiting 之后用它重新检查
+         *
+         * 等待标志与位置构成 Dekker 式的握手：本端先写标志再读对方的位置，对方先写位置再读标志。
+         * 两边都必须是 seq_cst，acquire 读取可以被重排到之前的标志写入前面，双方可能都看不到对方的更新而错过通知。
+         */
+        bool empty() const
+        {
+            return header_->head.load(std::memory_order_seq_cst) == header_->tail.load(std::memory_order_seq_cst);
+        }
+
+        // 等待标志：设置后重新检查缓冲区，对方在状态变化后清除标志并发送通知
+        void set_reader_waiting(bool waiting) { header_->reader_waiting.store(waiting, std::memory_order_seq_cst); }
+        bool take_reader_waiting() { return header_->reader_waiting.exchange(0, std::memory_order_seq_cst) != 0; }
+        void set_writer_waiting(bool waiting) { header_->writer_waiting.store(waiting, std::memory_order_seq_cst); }
+        bool take_writer_waiting() { return header_->writer_waiting.exchange(0, std::memory_order_seq_cst) != 0; }
+
+    private:
+        ShmRingHeader *header_ = nullptr;
+        uint8_t *data_ = nullptr;
+        size_t capacity_ = 0;
+    };
+
+    /**
+     * @brief 一个连接的共享内存段：每个方向一个环形缓冲区
+     *
+     * 发起方创建具名的共享内存段，通过 Unix 域套接字把名称发给对方，对方答复后发起方删除名称。
+     * 段以 0600 权限创建，只有同一用户的进程可以打开；名称含发起方的进程 ID 和 128 位随机数，
+     * 其他进程无法猜到。接受方只打开属于套接字对端进程的段：名称中的进程 ID 和段的所有者
+     * 必须与 SO_PEERCRED 报告的对端一致，对端不能让接受方映射第三方进程的段。
+     * Windows 上不支持，create()/open() 返回空指针。
+     */
+    class ShmChannel
+    {
+    public:
+        ~ShmChannel();
+
+        // 禁用拷贝构造和赋值
+        ShmChannel(const ShmChannel &) = delete;
+        ShmChannel &operator=(const ShmChannel &) = delete;
+
+        // 创建共享内存段（发起方），失败时返回空指针
+        static std::unique_ptr<ShmChannel> create(size_t ring_size);
+
+        /**
+         * @brief 打开对方创建的共享内存段（接受方）
+         * @param name 对方发来的段名称
+         * @param ring_size 对方发来的环形缓冲区大小
+         * @param creator_pid 对端进程 ID，名称必须由该进程创建
+         * @param creator_uid 对端用户 ID，段的所有者必须是该用户
+         * @return 通道对象，失败或段不属于对端时为空指针
+         */
+        static std::unique_ptr<ShmChannel> open(const std::string &name, size_t ring_size,
+                                                int64_t creator_pid, uint32_t creator_uid);
+
+        // 删除共享内存段的名称，已映射的内存不受影响
+        void unlink();
+
+        const std::string &name() const { return name_; }
+        size_t ring_size() const { return ring_size_; }
+
+        // 本端写入、对方读取的环形缓冲区
+        ShmRing &tx() { return tx_; }
+        // 对方写入、本端读取的环形缓冲区
+        ShmRing &rx() { return rx_; }
+
+    private:
+        ShmChannel() = default;
+
+        // 映射共享内存段，initiator 决定两个环形缓冲区的方向
+        bool map(int fd, size_t ring_size, bool initiator, bool initialize);
+
+        std::string name_;
+        bool owns_name_ = false;
+        void *memory_ = nullptr;
+        size_t mapped_size_ = 0;
+        size_t ring_size_ = 0;
+        ShmRing tx_;
+        ShmRing rx_;
+    };
+
+} // namespace libuv_net
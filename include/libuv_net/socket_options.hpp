@@ -0,0 +1,56 @@
+#pragma once
+
+#include <uv.h>
+
+namespace libuv_net
+{
+    /**
+     * @brief 套接字选项
+     *
+     * 为 0 或 false 的项保持系统默认值。SO_BUSY_POLL、TCP_QUICKACK 只在 Linux 上生效，
+     * TCP_NOTSENT_LOWAT 在 Linux 和 macOS 上生效，其他平台上忽略。
+     */
+    struct SocketOptions
+    {
+        bool nodelay = false;           // TCP_NODELAY，关闭 Nagle 算法
+        bool keepalive = false;         // SO_KEEPALIVE
+        unsigned keepalive_delay = 60;  // 开启保活时首次探测前的空闲秒数
+        int send_buffer_size = 0;       // SO_SNDBUF（字节）
+        int recv_buffer_size = 0;       // SO_RCVBUF（字节）
+        int busy_poll_us = 0;           // SO_BUSY_POLL，阻塞读取时忙等的微秒数
+        bool quickack = false;          // TCP_QUICKACK，内核会自动复位，每次读取后重新设置
+        int notsent_lowat = 0;          // TCP_NOTSENT_LOWAT，内核中未发送数据的上限（字节）
+
+        // 小消息请求-响应：立即发送、立即确认，限制内核中排队的未发送数据
+        static SocketOptions low_latency()
+        {
+            SocketOptions options;
+            options.nodelay = true;
+            options.quickack = true;
+            options.notsent_lowat = 16 * 1024;
+            return options;
+        }
+
+        // 高带宽时延积的链路：放大收发缓冲区
+        static SocketOptions high_throughput()
+        {
+            SocketOptions options;
+            options.send_buffer_size = 4 * 1024 * 1024;
+            options.recv_buffer_size = 4 * 1024 * 1024;
+            return options;
+        }
+    };
+
+    /**
+     * @brief 将选项应用到 TCP 句柄
+     *
+     * 句柄必须已关联套接字（已绑定、已接受或已连接）。单项失败只记录警告并继续设置其余各项。
+     *
+     * @return 0 或第一个失败项的 libuv 错误码
+     */
+    int apply_socket_options(uv_tcp_t *handle, const SocketOptions &options);
+
+    // 重新设置 TCP_QUICKACK，内核在确认模式切换后会自动将其复位
+    void rearm_quickack(uv_tcp_t *handle);
+
+} // namespace libuv_net
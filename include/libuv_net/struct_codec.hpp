@@ -0,0 +1,409 @@
+#pragma once
+
+#include <array>
+#include <tuple>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "libuv_net/message.hpp"
+#include "libuv_net/codec.hpp"
+
+namespace libuv_net
+{
+    /**
+     * @brief 定长结构体的字段声明
+     *
+     * 特化时提供返回成员指针元组的 constexpr 函数 members()，字段按元组顺序紧凑排列，
+     * 不含对齐填充，多字节字段一律按小端序编码：
+     *
+     *     template <>
+     *     struct StructFields<Quote>
+     *     {
+     *         static constexpr auto members() { return std::make_tuple(&Quote::price, &Quote::volume); }
+     *     };
+     *
+     * 也可以在全局作用域使用 LIBUV_NET_STRUCT(Quote, price, volume) 生成同样的特化。
+     * 支持的字段类型：算术类型、枚举、上述类型的 std::array，以及已声明字段的嵌套结构体。
+     */
+    template <typename T>
+    struct StructFields;
+
+    namespace detail
+    {
+        template <typename T, typename = void>
+        struct is_struct_message : std::false_type
+        {
+        };
+
+        template <typename T>
+        struct is_struct_message<T, std::void_t<decltype(StructFields<T>::members())>> : std::true_type
+        {
+        };
+
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+        constexpr bool host_is_little_endian = true;
+#else
+        constexpr bool host_is_little_endian = false;
+#endif
+
+        // 写入 size 字节的值，Swap 为 true 时逐字节反转，大端主机借此写出小端序
+        template <bool Swap>
+        inline void store_bytes(const void *value, uint8_t *out, size_t size)
+        {
+            if constexpr (Swap)
+            {
+                const auto *bytes = static_cast<const uint8_t *>(value);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    out[i] = bytes[size - 1 - i];
+                }
+            }
+            else
+            {
+                std::memcpy(out, value, size);
+            }
+        }
+
+        // store_bytes 的逆操作
+        template <bool Swap>
+        inline void load_bytes(const uint8_t *in, void *value, size_t size)
+        {
+            if constexpr (Swap)
+            {
+                auto *bytes = static_cast<uint8_t *>(value);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    bytes[i] = in[size - 1 - i];
+                }
+            }
+            else
+            {
+                std::memcpy(value, in, size);
+            }
+        }
+
+        // 单个字段的线路格式
+        template <typename T, typename = void>
+        struct wire_field;
+
+        // 算术类型和枚举：小端主机上直接拷贝，否则逐字节反转
+        template <typename T>
+        struct wire_field<T, std::enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value>>
+        {
+            static constexpr size_t size = sizeof(T);
+            static constexpr bool is_raw = host_is_little_endian && !std::is_same<T, bool>::value;
+
+            static void write(const T &value, uint8_t *out)
+            {
+                store_bytes<!host_is_little_endian>(&value, out, size);
+            }
+
+            static void read(const uint8_t *in, T &value)
+            {
+                if constexpr (std::is_same<T, bool>::value)
+                {
+                    value = in[0] != 0;
+                }
+                else
+                {
+                    load_bytes<!host_is_little_endian>(in, &value, size);
+                }
+            }
+        };
+
+        // 定长数组：元素无需转换时整体拷贝
+        template <typename T, size_t N>
+        struct wire_field<std::array<T, N>>
+        {
+            static constexpr size_t size = N * wire_field<T>::size;
+            static constexpr bool is_raw = wire_field<T>::is_raw && sizeof(std::array<T, N>) == size;
+
+            static void write(const std::array<T, N> &value, uint8_t *out)
+            {
+                if constexpr (is_raw)
+                {
+                    std::memcpy(out, value.data(), size);
+                }
+                else
+                {
+                    for (size_t i = 0; i < N; ++i)
+                    {
+                        wire_field<T>::write(value[i], out + i * wire_field<T>::size);
+                    }
+                }
+            }
+
+            static void read(const uint8_t *in, std::array<T, N> &value)
+            {
+                if constexpr (is_raw)
+                {
+                    std::memcpy(value.data(), in, size);
+                }
+                else
+                {
+                    for (size_t i = 0; i < N; ++i)
+                    {
+                        wire_field<T>::read(in + i * wire_field<T>::size, value[i]);
+                    }
+                }
+            }
+        };
+
+        template <typename T>
+        struct member_type;
+
+        template <typename C, typename M>
+        struct member_type<M C::*>
+        {
+            using type = M;
+        };
+
+        template <typename Member>
+        using member_type_t = typename member_type<std::decay_t<Member>>::type;
+
+        // LIBUV_NET_STRUCT 的字段数：字段列表字符串中的逗号数加一
+        constexpr size_t count_macro_fields(const char *fields)
+        {
+            size_t count = 1;
+            for (; *fields; ++fields)
+            {
+                count += *fields == ',';
+            }
+            return count;
+        }
+
+        template <typename Tuple>
+        struct members_size;
+
+        template <typename... Members>
+        struct members_size<std::tuple<Members...>>
+        {
+            static constexpr size_t value = (size_t{0} + ... + wire_field<member_type_t<Members>>::size);
+        };
+    } // namespace detail
+
+    /**
+     * @brief 定长结构体的编解码
+     *
+     * 编码长度 SIZE 在编译期确定，编解码按字段直接读写调用方的缓冲区，不分配内存。
+     */
+    template <typename T>
+    class StructCodec
+    {
+        static_assert(detail::is_struct_message<T>::value, "未为该类型特化 libuv_net::StructFields");
+
+    public:
+        static constexpr auto members = StructFields<T>::members();
+        static constexpr size_t SIZE = detail::members_size<std::decay_t<decltype(members)>>::value;
+
+        // 编码到 out，out 至少需要 SIZE 字节
+        static void write(const T &value, uint8_t *out)
+        {
+            std::apply([&](auto... member)
+                       {
+                size_t offset = 0;
+                ((write_field(value.*member, out + offset), offset += field_size(member)), ...); },
+                       members);
+        }
+
+        // 从 in 解码，in 至少需要 SIZE 字节
+        static void read(const uint8_t *in, T &value)
+        {
+            std::apply([&](auto... member)
+                       {
+                size_t offset = 0;
+                ((read_field(in + offset, value.*member), offset += field_size(member)), ...); },
+                       members);
+        }
+
+        // 编码到定长缓冲区，长度在编译期检查
+        template <size_t N>
+        static void write(const T &value, std::array<uint8_t, N> &out)
+        {
+            static_assert(N >= SIZE, "缓冲区小于结构体的编码长度");
+            write(value, out.data());
+        }
+
+        template <size_t N>
+        static void read(const std::array<uint8_t, N> &in, T &value)
+        {
+            static_assert(N >= SIZE, "缓冲区小于结构体的编码长度");
+            read(in.data(), value);
+        }
+
+    private:
+        template <typename Member>
+        static constexpr size_t field_size(Member)
+        {
+            return detail::wire_field<detail::member_type_t<Member>>::size;
+        }
+
+        template <typename F>
+        static void write_field(const F &field, uint8_t *out)
+        {
+            detail::wire_field<F>::write(field, out);
+        }
+
+        template <typename F>
+        static void read_field(const uint8_t *in, F &field)
+        {
+            detail::wire_field<F>::read(in, field);
+        }
+    };
+
+    namespace detail
+    {
+        // 嵌套结构体按自身的字段布局展开
+        template <typename T>
+        struct wire_field<T, std::enable_if_t<is_struct_message<T>::value>>
+        {
+            static constexpr size_t size = StructCodec<T>::SIZE;
+            static constexpr bool is_raw = false;
+
+            static void write(const T &value, uint8_t *out)
+            {
+                StructCodec<T>::write(value, out);
+            }
+
+            static void read(const uint8_t *in, T &value)
+            {
+                StructCodec<T>::read(in, value);
+            }
+        };
+    } // namespace detail
+
+    // 声明了字段的结构体可直接用于 send<Type>() 和类型化处理器
+    template <typename T>
+    struct Codec<T, std::enable_if_t<detail::is_struct_message<T>::value>>
+    {
+        static constexpr size_t encoded_size(const T &)
+        {
+            return StructCodec<T>::SIZE;
+        }
+
+        static bool encode_to(const T &value, uint8_t *out, size_t size)
+        {
+            if (size < StructCodec<T>::SIZE)
+            {
+                return false;
+            }
+            StructCodec<T>::write(value, out);
+            return true;
+        }
+
+        static bool encode(const T &value, std::vector<uint8_t> &out)
+        {
+            out.resize(StructCodec<T>::SIZE);
+            StructCodec<T>::write(value, out.data());
+            return true;
+        }
+
+        static bool decode(const uint8_t *data, size_t size, T &value) noexcept
+        {
+            if (size != StructCodec<T>::SIZE)
+            {
+                return false;
+            }
+            StructCodec<T>::read(data, value);
+            return true;
+        }
+    };
+
+    /**
+     * @brief 定长结构体拦截器
+     *
+     * 将某一消息类型的消息体按 StructCodec<T> 编解码，解码结果为 T。
+     * 消息体长度与 T 的编码长度不符时解码失败。
+     */
+    template <typename T>
+    class StructInterceptor : public Interceptor
+    {
+    public:
+        // 构造函数
+        explicit StructInterceptor(PacketType type = PacketType::BINARY) : type_(type) {}
+
+        // 序列化数据
+        std::vector<uint8_t> serialize(const std::any &data) override
+        {
+            const auto *value = std::any_cast<T>(&data);
+            if (!value)
+            {
+                return std::vector<uint8_t>();
+            }
+
+            std::vector<uint8_t> result(StructCodec<T>::SIZE);
+            StructCodec<T>::write(*value, result.data());
+            return result;
+        }
+
+        // 反序列化数据
+        std::any deserialize(const std::vector<uint8_t> &data) override
+        {
+            T value{};
+            if (!Codec<T>::decode(data.data(), data.size(), value))
+            {
+                return std::any();
+            }
+            return std::any(value);
+        }
+
+        // 获取支持的消息类型
+        PacketType get_type() const override
+        {
+            return type_;
+        }
+
+    private:
+        PacketType type_;
+    };
+
+} // namespace libuv_net
+
+// 以下宏用于 LIBUV_NET_STRUCT 展开字段列表，最多支持 16 个字段
+#define LIBUV_NET_DETAIL_EXPAND(x) x
+#define LIBUV_NET_DETAIL_CAT_IMPL(a, b) a##b
+#define LIBUV_NET_DETAIL_CAT(a, b) LIBUV_NET_DETAIL_CAT_IMPL(a, b)
+#define LIBUV_NET_DETAIL_COUNT_IMPL(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+#define LIBUV_NET_DETAIL_COUNT(...) \
+    LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_COUNT_IMPL(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define LIBUV_NET_DETAIL_M1(m) &Self::m
+#define LIBUV_NET_DETAIL_M2(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M1(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M3(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M2(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M4(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M3(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M5(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M4(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M6(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M5(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M7(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M6(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M8(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M7(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M9(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M8(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M10(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M9(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M11(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M10(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M12(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M11(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M13(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M12(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M14(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M13(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M15(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M14(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_M16(m, ...) &Self::m, LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_M15(__VA_ARGS__))
+#define LIBUV_NET_DETAIL_MEMBERS(...) \
+    LIBUV_NET_DETAIL_EXPAND(LIBUV_NET_DETAIL_CAT(LIBUV_NET_DETAIL_M, LIBUV_NET_DETAIL_COUNT(__VA_ARGS__))(__VA_ARGS__))
+
+/**
+ * @brief 为结构体声明字段，需在全局作用域使用，Type 应为完整限定名
+ *
+ *     struct Quote { int64_t price; uint32_t volume; };
+ *     LIBUV_NET_STRUCT(Quote, price, volume)
+ */
+#define LIBUV_NET_STRUCT(Type, ...)                                                    \
+    namespace libuv_net                                                                \
+    {                                                                                  \
+        static_assert(detail::count_macro_fields(#__VA_ARGS__) <= 16,                  \
+                      "LIBUV_NET_STRUCT 最多支持 16 个字段");                      \
+        template <>                                                                    \
+        struct StructFields<Type>                                                      \
+        {                                                                              \
+            static constexpr auto members()                                            \
+            {                                                                          \
+                using Self = Type;                                                     \
+                return std::make_tuple(LIBUV_NET_DETAIL_MEMBERS(__VA_ARGS__));         \
+            }                                                                          \
+        };                                                                             \
+    }
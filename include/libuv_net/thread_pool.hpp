@@ -8,6 +8,7 @@
 #include <functional>
 #include <future>
 #include <atomic>
+#include <memory>
 
 namespace libuv_net {
 
@@ -66,4 +67,51 @@ private:
     std::atomic<bool> stop_{false}; // 停止标志
 };
 
+// 首次使用时才创建的线程池，也可以注入调用者共享的线程池
+class LazyThreadPool {
+public:
+    // 线程数为 0 时使用硬件支持的线程数
+    explicit LazyThreadPool(size_t num_threads = 0) : num_threads_(num_threads) {}
+
+    // 设置创建时的线程数，线程池已创建时返回 false
+    bool set_size(size_t num_threads) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pool_) {
+            return false;
+        }
+        num_threads_ = num_threads;
+        return true;
+    }
+
+    // 使用外部的线程池，线程池已创建时返回 false
+    bool set(std::shared_ptr<ThreadPool> pool) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pool_) {
+            return false;
+        }
+        pool_ = std::move(pool);
+        return true;
+    }
+
+    // 获取线程池，首次调用时创建
+    ThreadPool& get() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pool_) {
+            pool_ = std::make_shared<ThreadPool>(num_threads_ ? num_threads_ : std::thread::hardware_concurrency());
+        }
+        return *pool_;
+    }
+
+    // 线程池是否已创建或注入
+    bool created() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pool_ != nullptr;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    size_t num_threads_;
+    std::shared_ptr<ThreadPool> pool_;
+};
+
 } // namespace libuv_net 
\ No newline at end of file
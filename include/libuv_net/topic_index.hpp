@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+namespace libuv_net
+{
+    class Session;
+
+    /**
+     * @brief 主题到订阅会话的索引
+     *
+     * 同时维护主题到会话、会话到主题两个方向的索引：发布只遍历该主题的订阅者，
+     * 会话关闭时只清理它订阅过的主题。索引不持有会话，会话关闭时应调用 remove()。
+     */
+    class TopicIndex
+    {
+    public:
+        // 订阅主题，已订阅时返回 false
+        bool subscribe(Session *session, const std::string &topic)
+        {
+            if (!subscribers_[topic].insert(session).second)
+            {
+                return false;
+            }
+            topics_[session].push_back(topic);
+            return true;
+        }
+
+        // 取消订阅，未订阅时返回 false
+        bool unsubscribe(Session *session, const std::string &topic)
+        {
+            auto it = subscribers_.find(topic);
+            if (it == subscribers_.end() || it->second.erase(session) == 0)
+            {
+                return false;
+            }
+            if (it->second.empty())
+            {
+                subscribers_.erase(it);
+            }
+
+            auto &topics = topics_[session];
+            topics.erase(std::find(topics.begin(), topics.end(), topic));
+            if (topics.empty())
+            {
+                topics_.erase(session);
+            }
+            return true;
+        }
+
+        // 移除会话的所有订阅
+        void remove(Session *session)
+        {
+            auto it = topics_.find(session);
+            if (it == topics_.end())
+            {
+                return;
+            }
+
+            for (const auto &topic : it->second)
+            {
+                auto subscribers = subscribers_.find(topic);
+                subscribers->second.erase(session);
+                if (subscribers->second.empty())
+                {
+                    subscribers_.erase(subscribers);
+                }
+            }
+            topics_.erase(it);
+        }
+
+        // 遍历主题的订阅者
+        template <typename F>
+        void for_each_subscriber(const std::string &topic, F &&f) const
+        {
+            auto it = subscribers_.find(topic);
+            if (it == subscribers_.end())
+            {
+                return;
+            }
+            for (Session *session : it->second)
+            {
+                f(*session);
+            }
+        }
+
+        // 主题的订阅者数量
+        size_t subscriber_count(const std::string &topic) const
+        {
+            auto it = subscribers_.find(topic);
+            return it == subscribers_.end() ? 0 : it->second.size();
+        }
+
+    private:
+        std::unordered_map<std::string, std::unordered_set<Session *>> subscribers_; // 主题到订阅会话
+        std::unordered_map<Session *, std::vector<std::string>> topics_;             // 会话到订阅的主题
+    };
+
+} // namespace libuv_net
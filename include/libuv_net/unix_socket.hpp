@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <uv.h>
+
+namespace libuv_net
+{
+    // 是否为 Linux 抽象命名空间的地址：以 @ 开头，不在文件系统中创建套接字文件
+    inline bool is_abstract_socket_path(const std::string &path)
+    {
+        return !path.empty() && path[0] == '@';
+    }
+
+    /**
+     * @brief 在抽象命名空间中绑定地址，并将套接字交给管道句柄
+     *
+     * 链接的 libuv 不一定提供 uv_pipe_bind2，这里直接创建套接字后用 uv_pipe_open 接管。
+     * 只在 Linux 上支持，其他平台返回 UV_ENOTSUP。
+     *
+     * @param handle 已初始化、尚未打开的管道句柄
+     * @param path 以 @ 开头的地址
+     * @return 0 或 libuv 错误码
+     */
+    int bind_abstract_socket(uv_pipe_t *handle, const std::string &path);
+
+    /**
+     * @brief 连接抽象命名空间中的地址，并将套接字交给管道句柄
+     *
+     * 本机的 Unix 域套接字连接立即完成，返回 0 时句柄已处于连接状态；
+     * 对端的监听队列已满时不等待，返回 UV_EAGAIN。
+     *
+     * @param handle 已初始化、尚未打开的管道句柄
+     * @param path 以 @ 开头的地址
+     * @return 0 或 libuv 错误码
+     */
+    int connect_abstract_socket(uv_pipe_t *handle, const std::string &path);
+
+    // Unix 域套接字对端进程的身份，由内核在连接时记录，对端无法伪造
+    struct PeerCredentials
+    {
+        int64_t pid = 0;
+        uint32_t uid = 0;
+    };
+
+    /**
+     * @brief 获取已连接的 Unix 域套接字对端的进程 ID 和用户 ID
+     *
+     * 使用 SO_PEERCRED，只在 Linux 上支持，其他平台返回 UV_ENOTSUP。
+     *
+     * @param handle 已连接的管道句柄
+     * @param credentials 对端的身份
+     * @return 0 或 libuv 错误码
+     */
+    int get_peer_credentials(const uv_pipe_t *handle, PeerCredentials &credentials);
+
+} // namespace libuv_net
@@ -1,6 +1,8 @@
 #include "libuv_net/client.hpp"
+#include "libuv_net/unix_socket.hpp"
 #include <spdlog/spdlog.h>
 #include <cstring>
+#include <algorithm>
 #ifdef _WIN32
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -11,62 +13,122 @@
 namespace libuv_net
 {
 
-    Client::Client()
+    // 一个地址的连接尝试
+    struct Client::ConnectAttempt
     {
-        loop_ = uv_loop_new();
-        if (!loop_)
-        {
-            throw std::runtime_error("创建事件循环失败");
-        }
-        thread_pool_ = std::make_unique<ThreadPool>();
+        uv_connect_t req;
+        Client *client;
+        std::shared_ptr<Session> session;
+    };
 
-        // 初始化心跳定时器
-        uv_timer_init(loop_, &heartbeat_timer_);
-        heartbeat_timer_.data = this;
+    Client::Client() : Client(std::make_shared<ClientContext>(), true)
+    {
     }
 
-    Client::~Client()
+    Client::Client(std::shared_ptr<ClientContext> context) : Client(std::move(context), false)
     {
-        stop();
-        disconnect();
-        uv_loop_delete(loop_);
     }
 
-    bool Client::start()
+    Client::Client(std::shared_ptr<ClientContext> context, bool owns_context)
+        : context_(std::move(context)), owns_context_(owns_context), loop_(context_->acquire_loop())
+    {
+        // 句柄只能在事件循环线程中初始化
+        context_->run_sync(loop_, [this]()
+                           {
+                               // 初始化心跳定时器
+                               uv_timer_init(loop_, &heartbeat_timer_);
+                               heartbeat_timer_.data = this;
+
+                               // 初始化连接尝试定时器
+                               uv_timer_init(loop_, &attempt_timer_);
+                               attempt_timer_.data = this;
+
+                               // 初始化重连定时器
+                               uv_timer_init(loop_, &reconnect_timer_);
+                               reconnect_timer_.data = this;
+                               open_handles_ = 3;
+
+                               resolver_ = std::make_unique<Resolver>(loop_); });
+    }
+
+    Client::~Client()
     {
-        if (loop_thread_.joinable())
+        if (owns_context_)
         {
-            spdlog::warn("事件循环已经在运行");
-            return false;
+            context_->stop();
         }
 
-        should_stop_ = false;
-        loop_thread_ = std::thread([this]()
-                                   {
-            spdlog::info("事件循环线程启动");
-            while (!should_stop_)
+        // 投递在此之前的任务执行完后，在事件循环线程中关闭连接和定时器
+        context_->run_sync(loop_, [this]()
+                           {
+                               close_connection();
+                               uv_close(reinterpret_cast<uv_handle_t *>(&heartbeat_timer_), on_handle_closed);
+                               uv_close(reinterpret_cast<uv_handle_t *>(&attempt_timer_), on_handle_closed);
+                               uv_close(reinterpret_cast<uv_handle_t *>(&reconnect_timer_), on_handle_closed);
+                               resolver_->cancel(); });
+
+        // 等待关闭回调执行完毕，之后事件循环中不再有引用本对象的回调
+        bool quiescent = false;
+        while (true)
+        {
+            context_->run_sync(loop_, [this, &quiescent]()
+                               { quiescent = is_quiescent(); });
+            if (quiescent)
+            {
+                break;
+            }
+            if (context_->running())
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            else
             {
                 uv_run(loop_, UV_RUN_NOWAIT);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
             }
-            spdlog::info("事件循环线程退出"); });
+        }
+        session_.reset();
+    }
 
-        return true;
+    bool Client::is_quiescent() const
+    {
+        return open_handles_ == 0 && attempts_.empty() && closing_sessions_.empty() &&
+               (!session_ || session_->is_closed()) && (!journal_ || journal_->idle());
+    }
+
+    void Client::on_handle_closed(uv_handle_t *handle)
+    {
+        --static_cast<Client *>(handle->data)->open_handles_;
+    }
+
+    bool Client::start()
+    {
+        if (!owns_context_)
+        {
+            return context_->running();
+        }
+        return context_->start();
     }
 
     void Client::stop()
     {
-        if (!loop_thread_.joinable())
+        if (owns_context_)
         {
-            return;
+            if (!context_->running())
+            {
+                return;
+            }
+            context_->stop();
         }
 
-        should_stop_ = true;
-        loop_thread_.join();
-        stop_heartbeat();
+        context_->run_sync(loop_, [this]()
+                           {
+                               if (session_)
+                               {
+                                   session_->stop();
+                               } });
     }
 
-    bool Client::connect(const std::string &host, uint16_t port)
+    bool Client::prepare_connect()
     {
         // 检查连接状态
         if (is_connected_ || is_connecting_)
@@ -75,292 +137,654 @@ namespace libuv_net
             return false;
         }
 
-        // 初始化套接字
-        if (!init_socket())
+        // 上一个会话的句柄必须先关闭完成
+        if (session_ && !session_->is_closed())
         {
+            spdlog::warn("上一个连接尚未关闭完成");
             return false;
         }
+        return true;
+    }
 
-        // 解析地址
-        struct sockaddr_in addr;
-        uv_ip4_addr(host.c_str(), port, &addr);
-
-        // 创建连接请求
-        auto connect_req = new uv_connect_t;
-        connect_req->data = this;
+    bool Client::connect(const std::string &host, uint16_t port)
+    {
+        bool result = false;
+        context_->run_sync(loop_, [&]()
+                           { result = start_connect(host, port); });
+        return result;
+    }
 
-        // 发起连接
-        int result = uv_tcp_connect(connect_req, &socket_,
-                                    reinterpret_cast<const struct sockaddr *>(&addr),
-                                    on_connect);
-        if (result)
+    bool Client::start_connect(const std::string &host, uint16_t port)
+    {
+        if (!prepare_connect())
         {
-            spdlog::error("连接失败: {}", uv_strerror(result));
-            delete connect_req;
-            is_connecting_ = false;
             return false;
         }
 
+        target_host_ = host;
+        target_port_ = port;
+        target_path_.clear();
+        manual_disconnect_ = false;
         is_connecting_ = true;
+        last_connect_error_ = 0;
+        uint64_t generation = ++connect_generation_;
         spdlog::info("正在连接到服务器 {}:{}", host, port);
+
+        // 数字地址和缓存命中时同步回调
+        resolver_->resolve(host, port, [this, generation](int status, std::vector<sockaddr_storage> addresses)
+                           {
+                               if (generation != connect_generation_ || !is_connecting_)
+                               {
+                                   return;
+                               }
+                               if (status)
+                               {
+                                   connect_failed(status);
+                                   return;
+                               }
+                               pending_addresses_ = interleave_addresses(addresses);
+                               start_next_attempt(); });
         return true;
     }
 
-    void Client::disconnect()
+    void Client::start_next_attempt()
     {
-        if (!is_connected_ && !is_connecting_)
+        uv_timer_stop(&attempt_timer_);
+        while (!pending_addresses_.empty())
         {
+            sockaddr_storage addr = pending_addresses_.front();
+            pending_addresses_.erase(pending_addresses_.begin());
+
+            auto session = create_session();
+            auto attempt = new ConnectAttempt{uv_connect_t{}, this, session};
+            attempt->req.data = attempt;
+            int result = uv_tcp_connect(&attempt->req, &session->get_socket(),
+                                        reinterpret_cast<const struct sockaddr *>(&addr), on_attempt_connect);
+            if (result)
+            {
+                delete attempt;
+                last_connect_error_ = result;
+                discard_session(std::move(session));
+                continue;
+            }
+            attempts_.push_back(std::move(session));
+
+            // 本次尝试未完成时，经过间隔后并行尝试下一个地址
+            if (!pending_addresses_.empty())
+            {
+                uv_timer_start(&attempt_timer_, on_attempt_timer, CONNECT_ATTEMPT_DELAY_MS, 0);
+            }
             return;
         }
 
-        // 关闭套接字
-        if (!uv_is_closing((uv_handle_t *)&socket_))
+        // 所有地址都已失败
+        if (attempts_.empty())
         {
-            uv_close((uv_handle_t *)&socket_, on_close);
+            connect_failed(last_connect_error_ ? last_connect_error_ : UV_ECONNREFUSED);
         }
+    }
 
-        is_connected_ = false;
-        is_connecting_ = false;
-        stop_heartbeat();
-        spdlog::info("客户端已断开连接");
+    void Client::on_attempt_timer(uv_timer_t *handle)
+    {
+        static_cast<Client *>(handle->data)->start_next_attempt();
     }
 
-    void Client::send(std::shared_ptr<Packet> packet)
+    void Client::on_attempt_connect(uv_connect_t *req, int status)
     {
-        if (!is_connected_)
+        std::unique_ptr<ConnectAttempt> attempt(static_cast<ConnectAttempt *>(req->data));
+        auto client = attempt->client;
+
+        // 已被放弃的尝试
+        auto it = std::find(client->attempts_.begin(), client->attempts_.end(), attempt->session);
+        if (it == client->attempts_.end())
         {
-            spdlog::warn("客户端未连接，无法发送消息");
             return;
         }
+        client->attempts_.erase(it);
 
-        // 序列化消息
-        auto data = packet->serialize();
-        auto write_req = new uv_write_t;
-        write_req->data = this;
+        if (status < 0)
+        {
+            // 立即尝试下一个地址
+            spdlog::debug("连接尝试失败: {}", uv_strerror(status));
+            client->last_connect_error_ = status;
+            client->discard_session(std::move(attempt->session));
+            client->start_next_attempt();
+            return;
+        }
 
-        // 创建缓冲区
-        uv_buf_t buf = uv_buf_init(reinterpret_cast<char *>(data.data()), data.size());
+        // 最先建立的连接胜出
+        client->abort_attempts();
+        client->session_ = std::move(attempt->session);
+        client->handle_connect(0);
+    }
 
-        // 发送数据
-        int result = uv_write(write_req, (uv_stream_t *)&socket_, &buf, 1, on_write);
-        if (result)
+    void Client::abort_attempts()
+    {
+        uv_timer_stop(&attempt_timer_);
+        pending_addresses_.clear();
+        for (auto &session : attempts_)
         {
-            spdlog::error("发送失败: {}", uv_strerror(result));
-            delete write_req;
+            discard_session(std::move(session));
         }
+        attempts_.clear();
     }
 
-    void Client::on_connect(uv_connect_t *req, int status)
+    void Client::discard_session(std::shared_ptr<Session> session)
     {
-        auto client = static_cast<Client *>(req->data);
-        delete req;
+        Session *raw = session.get();
+        session->set_close_handler([this, raw]()
+                                   { closing_sessions_.erase(std::find_if(closing_sessions_.begin(), closing_sessions_.end(),
+                                                                          [raw](const std::shared_ptr<Session> &s)
+                                                                          { return s.get() == raw; })); });
+        closing_sessions_.push_back(session);
+        session->close();
+    }
 
-        if (status < 0)
+    void Client::connect_failed(int status)
+    {
+        spdlog::error("连接错误: {}", uv_strerror(status));
+        is_connecting_ = false;
+        if (connect_error_handler_)
+        {
+            connect_error_handler_(status);
+        }
+        schedule_reconnect();
+    }
+
+    void Client::set_reconnect(const ReconnectOptions &options)
+    {
+        context_->run_sync(loop_, [this, &options]()
+                           {
+                               reconnect_options_ = options;
+                               reconnect_enabled_ = options.enabled;
+                               backoff_ = Backoff(options);
+                               pending_packets_ = ReplayQueue(options.max_queued_packets, options.max_queued_bytes);
+                               sent_packets_ = ReplayQueue(options.max_queued_packets, options.max_queued_bytes);
+                               if (!reconnect_enabled_)
+                               {
+                                   uv_timer_stop(&reconnect_timer_);
+                               } });
+    }
+
+    size_t Client::queued_count()
+    {
+        size_t count = 0;
+        context_->run_sync(loop_, [this, &count]()
+                           { count = pending_packets_.size(); });
+        return count;
+    }
+
+    void Client::schedule_reconnect()
+    {
+        bool has_target = !target_host_.empty() || !target_path_.empty();
+        if (!reconnect_enabled_ || manual_disconnect_ || !has_target ||
+            uv_is_active(reinterpret_cast<uv_handle_t *>(&reconnect_timer_)))
         {
-            spdlog::error("连接错误: {}", uv_strerror(status));
-            client->is_connecting_ = false;
             return;
         }
 
-        // 开始读取数据
-        int result = uv_read_start((uv_stream_t *)&client->socket_,
-                                   [](uv_handle_t * /*handle*/, size_t suggested_size, uv_buf_t *buf)
-                                   {
-                                       *buf = uv_buf_init(new char[suggested_size], suggested_size);
-                                   },
-                                   on_read);
-        if (result)
+        auto delay = backoff_.next_delay();
+        spdlog::info("{} 毫秒后第 {} 次重连", delay.count(), backoff_.attempts());
+        uv_timer_start(&reconnect_timer_, on_reconnect_timer, static_cast<uint64_t>(delay.count()), 0);
+    }
+
+    void Client::on_reconnect_timer(uv_timer_t *handle)
+    {
+        auto client = static_cast<Client *>(handle->data);
+        if (client->is_connected_ || client->is_connecting_)
         {
-            spdlog::error("开始读取失败: {}", uv_strerror(result));
-            client->is_connecting_ = false;
-            client->disconnect();
             return;
         }
 
-        client->is_connected_ = true;
-        client->is_connecting_ = false;
-        client->start_heartbeat();
-        spdlog::info("连接成功");
+        bool started = client->target_path_.empty() ? client->start_connect(client->target_host_, client->target_port_)
+                                                    : client->start_connect_unix(client->target_path_);
+        if (!started && !client->is_connecting_)
+        {
+            client->schedule_reconnect();
+        }
+    }
 
-        // 调用连接回调
-        if (client->connect_handler_)
+    void Client::queue_packet(std::shared_ptr<Packet> packet)
+    {
+        bool has_target = !target_host_.empty() || !target_path_.empty();
+        if (!reconnect_enabled_ || manual_disconnect_ || !has_target)
+        {
+            spdlog::warn("客户端未连接，无法发送消息");
+            return;
+        }
+        if (!pending_packets_.push(std::move(packet)) && dropped_packets_++ == 0)
         {
-            client->connect_handler_();
+            spdlog::warn("重连缓存已满（{} 个消息，{} 字节），丢弃之后的消息", pending_packets_.size(), pending_packets_.bytes());
         }
     }
 
-    void Client::on_close(uv_handle_t *handle)
+    void Client::flush_replay()
     {
-        auto client = static_cast<Client *>(handle->data);
-        client->is_connected_ = false;
-        client->is_connecting_ = false;
-        client->stop_heartbeat();
+        bool replay_sent = reconnect_options_.replay_sequenced && !sent_packets_.empty();
+        if (pending_packets_.empty() && !replay_sent)
+        {
+            return;
+        }
 
-        // 调用断开连接回调
-        if (client->disconnect_handler_)
+        // 合并为一次写入：先重发断开前的带序列号消息，再发断开期间缓存的消息
+        auto frames = std::make_shared<std::vector<uint8_t>>();
+        if (replay_sent)
+        {
+            sent_packets_.append_frames(*frames);
+        }
+        pending_packets_.append_frames(*frames);
+        spdlog::info("重连后发出 {} 个缓存的消息，重发 {} 个消息，共 {} 字节，断开期间丢弃 {} 个消息",
+                     pending_packets_.size(), replay_sent ? sent_packets_.size() : 0, frames->size(), dropped_packets_);
+        dropped_packets_ = 0;
+
+        if (reconnect_options_.replay_sequenced)
+        {
+            pending_packets_.for_each([this](const std::shared_ptr<Packet> &packet)
+                                      {
+                                          if (packet->sequence() != 0)
+                                          {
+                                              sent_packets_.push_evicting(packet);
+                                          } });
+        }
+        pending_packets_.clear();
+        session_->send_frame(std::move(frames));
+    }
+
+    bool Client::enable_journal(const JournalOptions &options)
+    {
+        bool result = false;
+        context_->run_sync(loop_, [&]()
+                           {
+                               journal_ = Journal::open(loop_, options);
+                               result = journal_ != nullptr;
+                               if (result && is_connected_)
+                               {
+                                   replay_journal();
+                               } });
+        return result;
+    }
+
+    void Client::send_durable(std::shared_ptr<Packet> packet)
+    {
+        context_->post(loop_, [this, packet = std::move(packet)]()
+                       {
+                           if (!journal_)
+                           {
+                               spdlog::warn("未启用持久化日志，无法持久化发送");
+                               return;
+                           }
+                           const auto &data = packet->data();
+                           uint32_t sequence = journal_->append(packet->type(), data.data(), data.size());
+
+                           // 未连接时留在日志中，连接建立后重发
+                           if (sequence != 0 && is_connected_)
+                           {
+                               session_->send_frame(make_shared_frame(packet->type(), data.data(), data.size(), sequence, PACKET_FLAG_DURABLE));
+                           } });
+    }
+
+    size_t Client::unacknowledged_count()
+    {
+        size_t count = 0;
+        context_->run_sync(loop_, [this, &count]()
+                           { count = journal_ ? journal_->pending_count() : 0; });
+        return count;
+    }
+
+    void Client::replay_journal()
+    {
+        if (!journal_ || journal_->pending_count() == 0)
         {
-            client->disconnect_handler_();
+            return;
         }
+
+        // 合并为一次写入
+        auto frames = std::make_shared<std::vector<uint8_t>>();
+        frames->reserve(journal_->pending_bytes());
+        journal_->for_each_pending([&frames](const uint8_t *frame, size_t size)
+                                   { frames->insert(frames->end(), frame, frame + size); });
+        spdlog::info("重发日志中 {} 个未确认的消息，共 {} 字节", journal_->pending_count(), frames->size());
+        session_->send_frame(std::move(frames));
+    }
+
+    bool Client::connect_unix(const std::string &path)
+    {
+        bool result = false;
+        context_->run_sync(loop_, [&]()
+                           { result = start_connect_unix(path); });
+        return result;
     }
 
-    void Client::on_read(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf)
+    bool Client::start_connect_unix(const std::string &path)
     {
-        auto client = static_cast<Client *>(stream->data);
+        if (!prepare_connect())
+        {
+            return false;
+        }
 
-        if (nread < 0)
+        target_host_.clear();
+        target_path_ = path;
+        manual_disconnect_ = false;
+
+        // 创建会话
+        session_ = create_session(Transport::PIPE);
+
+        if (is_abstract_socket_path(path))
         {
-            if (nread != UV_EOF)
+            // 抽象命名空间的连接直接完成，连接回调仍在事件循环中执行
+            int result = connect_abstract_socket(&session_->get_pipe(), path);
+            if (result)
             {
-                spdlog::error("读取错误: {}", uv_strerror(nread));
+                spdlog::error("连接 Unix 域套接字 {} 失败: {}", path, uv_strerror(result));
+                session_->set_close_handler(nullptr);
+                session_->close();
+                return false;
             }
-            client->disconnect();
-            return;
+
+            // 定时器关闭完成前客户端不会销毁；其间断开过连接时不再完成
+            struct ConnectTimer
+            {
+                uv_timer_t timer;
+                Client *client;
+                uint64_t generation;
+            };
+            auto timer = new ConnectTimer{uv_timer_t{}, this, ++connect_generation_};
+            uv_timer_init(loop_, &timer->timer);
+            timer->timer.data = timer;
+            ++open_handles_;
+            uv_timer_start(&timer->timer, [](uv_timer_t *handle)
+                           {
+                               auto timer = static_cast<ConnectTimer *>(handle->data);
+                               uv_close(reinterpret_cast<uv_handle_t *>(handle), [](uv_handle_t *h)
+                                        {
+                                            auto timer = static_cast<ConnectTimer *>(h->data);
+                                            --timer->client->open_handles_;
+                                            delete timer; });
+                               if (timer->generation == timer->client->connect_generation_)
+                               {
+                                   timer->client->handle_connect(0);
+                               } },
+                           0, 0);
+        }
+        else
+        {
+            auto connect_req = new uv_connect_t;
+            connect_req->data = this;
+            uv_pipe_connect(connect_req, &session_->get_pipe(), path.c_str(), on_connect);
         }
 
-        if (nread == 0)
+        is_connecting_ = true;
+        spdlog::info("正在连接到 Unix 域套接字 {}", path);
+        return true;
+    }
+
+    void Client::disconnect()
+    {
+        context_->run_sync(loop_, [this]()
+                           { close_connection(); });
+    }
+
+    void Client::close_connection()
+    {
+        // 主动断开后不再重连，丢弃缓存的消息
+        manual_disconnect_ = true;
+        uv_timer_stop(&reconnect_timer_);
+        pending_packets_.clear();
+        sent_packets_.clear();
+        dropped_packets_ = 0;
+
+        if (!is_connected_ && !is_connecting_)
         {
             return;
         }
 
-        // 处理接收到的数据
-        client->append_to_buffer(buf->base, nread);
+        // 放弃进行中的解析和连接尝试
+        ++connect_generation_;
+        abort_attempts();
+
+        // 关闭会话
+        if (session_)
+        {
+            session_->close();
+        }
+
+        is_connected_ = false;
+        is_connecting_ = false;
+        spdlog::info("客户端已断开连接");
+    }
+
+    void Client::send(std::shared_ptr<Packet> packet)
+    {
+        context_->post(loop_, [this, packet = std::move(packet)]() mutable
+                       {
+                           if (!is_connected_)
+                           {
+                               queue_packet(std::move(packet));
+                               return;
+                           }
+                           if (reconnect_enabled_ && reconnect_options_.replay_sequenced && packet->sequence() != 0)
+                           {
+                               sent_packets_.push_evicting(packet);
+                           }
+                           session_->send(std::move(packet)); });
+    }
+
+    bool Client::send_unreliable(std::shared_ptr<Packet> packet)
+    {
+        bool result = false;
+        context_->run_sync(loop_, [&]()
+                           {
+                               if (!is_connected_)
+                               {
+                                   spdlog::warn("客户端未连接，无法发送消息");
+                                   return;
+                               }
+                               result = session_->send_unreliable(std::move(packet)); });
+        return result;
+    }
+
+    bool Client::send_stream(PacketType type, uint32_t length, ChunkSource source, uint32_t sequence)
+    {
+        bool result = false;
+        context_->run_sync(loop_, [&]()
+                           {
+                               if (!is_connected_)
+                               {
+                                   spdlog::warn("客户端未连接，无法发送消息");
+                                   return;
+                               }
+                               result = session_->send_stream(type, length, std::move(source), sequence); });
+        return result;
     }
 
-    void Client::on_write(uv_write_t *req, int status)
+    void Client::on_connect(uv_connect_t *req, int status)
     {
         auto client = static_cast<Client *>(req->data);
         delete req;
+        client->handle_connect(status);
+    }
 
+    void Client::handle_connect(int status)
+    {
         if (status < 0)
         {
-            spdlog::error("写入错误: {}", uv_strerror(status));
-            client->disconnect();
+            session_->set_close_handler(nullptr);
+            session_->close();
+            connect_failed(status);
+            return;
         }
-    }
 
-    void Client::on_heartbeat_timer(uv_timer_t *handle)
-    {
-        auto client = static_cast<Client *>(handle->data);
+        // 开始读取数据并启动心跳
+        session_->apply_socket_options();
+        session_->start();
+        if (shm_options_.enabled && session_->transport() == Transport::PIPE &&
+            !session_->offer_shared_memory(shm_options_))
+        {
+            spdlog::warn("无法创建共享内存，继续使用套接字");
+        }
+        if (datagrams_enabled_ && session_->transport() == Transport::TCP)
+        {
+            session_->send(std::make_shared<Packet>(PacketType::DATAGRAM_BIND, std::vector<uint8_t>()));
+        }
+        uv_timer_start(&heartbeat_timer_, on_heartbeat_timer, HEARTBEAT_INTERVAL_MS, HEARTBEAT_INTERVAL_MS);
 
-        // 检查心跳超时
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                           now - client->last_heartbeat_time_)
-                           .count();
+        is_connected_ = true;
+        is_connecting_ = false;
+        backoff_.reset();
+        spdlog::info("连接成功");
+        replay_journal();
+        flush_replay();
 
-        if (elapsed > HEARTBEAT_TIMEOUT_MS)
+        // 调用连接回调
+        if (connect_handler_)
         {
-            spdlog::warn("心跳超时，断开连接");
-            client->disconnect();
-            return;
+            connect_handler_();
         }
+    }
 
-        // 发送心跳包
-        client->send_heartbeat();
+    std::shared_ptr<Session> Client::create_session(Transport transport)
+    {
+        auto session = std::make_shared<Session>(loop_, transport);
+        session->set_interceptor_manager(interceptor_manager_);
+        session->set_max_frame_size(max_frame_size_);
+        session->set_stream_window_size(stream_window_size_);
+        session->set_socket_options(socket_options_);
+
+        // 消息分发到客户端注册的处理器
+        session->set_default_packet_handler([this](std::shared_ptr<Packet> packet)
+                                            { dispatch_packet(std::move(packet)); });
+        chunk_handlers_.for_each([&session](PacketType type, const ChunkHandler &handler)
+                                 { session->set_chunk_handler(type, handler); });
+
+        session->set_close_handler([this]()
+                                   { on_session_closed(); });
+        return session;
     }
 
-    bool Client::init_socket()
+    void Client::on_heartbeat_timer(uv_timer_t *handle)
     {
-        // 检查套接字状态
-        if (uv_is_active((uv_handle_t *)&socket_))
+        auto client = static_cast<Client *>(handle->data);
+        if (client->session_)
         {
-            if (!uv_is_closing((uv_handle_t *)&socket_))
+            client->session_->check_heartbeat(std::chrono::steady_clock::now());
+
+            // 定期告知服务器本端的地址，保持 NAT 映射
+            if (client->datagram_)
             {
-                uv_close((uv_handle_t *)&socket_, nullptr);
+                client->datagram_->send_token(nullptr, client->session_->datagram_token());
             }
-            return false;
         }
+    }
 
-        // 初始化套接字
-        int result = uv_tcp_init(loop_, &socket_);
-        if (result)
+    void Client::on_session_closed()
+    {
+        uv_timer_stop(&heartbeat_timer_);
+        datagram_.reset();
+        is_connected_ = false;
+        is_connecting_ = false;
+
+        // 调用断开连接回调
+        if (disconnect_handler_)
         {
-            spdlog::error("初始化套接字失败: {}", uv_strerror(result));
-            return false;
+            disconnect_handler_();
         }
 
-        socket_.data = this;
-        return true;
+        // 意外断开时重连
+        schedule_reconnect();
     }
 
-    void Client::append_to_buffer(const char *data, size_t len)
+    void Client::dispatch_packet(std::shared_ptr<Packet> packet)
     {
-        buffer_.insert(buffer_.end(), data, data + len);
-
-        // 处理完整的消息
-        while (buffer_.size() >= sizeof(PacketHeader))
+        if (packet->type() == PacketType::DATAGRAM_BIND)
         {
-            const PacketHeader *header = reinterpret_cast<const PacketHeader *>(buffer_.data());
-            size_t message_size = sizeof(PacketHeader) + header->length;
-
-            if (buffer_.size() < message_size)
-            {
-                break;
-            }
-
-            // 解析消息
-            auto packet = std::make_shared<Packet>();
-            if (!packet->deserialize(buffer_.data(), message_size))
+            handle_datagram_bind(*packet);
+            return;
+        }
+        if (packet->type() == PacketType::ACK)
+        {
+            uint32_t sequence = 0;
+            if (journal_ && decode_ack(packet->data(), sequence))
             {
-                spdlog::error("消息解析失败");
-                buffer_.clear();
-                return;
+                journal_->acknowledge(sequence);
             }
+            return;
+        }
 
-            // 使用拦截器处理数据
-            auto interceptor = interceptor_manager_.get_interceptor(packet->type());
-            if (interceptor)
-            {
-                auto data = interceptor->deserialize(packet->data());
-                if (data.has_value())
-                {
-                    // 查找对应的处理器
-                    auto it = packet_handlers_.find(packet->type());
-                    if (it != packet_handlers_.end())
-                    {
-                        it->second(packet);
-                    }
-                    else if (default_packet_handler_)
-                    {
-                        default_packet_handler_(packet);
-                    }
-                }
-            }
-            else
-            {
-                // 查找对应的处理器
-                auto it = packet_handlers_.find(packet->type());
-                if (it != packet_handlers_.end())
-                {
-                    it->second(packet);
-                }
-                else if (default_packet_handler_)
-                {
-                    default_packet_handler_(packet);
-                }
-            }
+        // 登记了编解码器的类型先做解码校验
+        if (!codecs_.accepts(*packet))
+        {
+            spdlog::warn("消息解码失败，类型: {}", static_cast<int>(packet->type()));
+            return;
+        }
 
-            // 移除已处理的数据
-            buffer_.erase(buffer_.begin(), buffer_.begin() + message_size);
+        // 查找对应的处理器
+        if (auto handler = packet_handlers_.find(packet->type()))
+        {
+            (*handler)(packet);
+        }
+        else if (default_packet_handler_)
+        {
+            default_packet_handler_(packet);
         }
     }
 
-    void Client::start_heartbeat()
+    void Client::handle_datagram_bind(const Packet &packet)
     {
-        last_heartbeat_time_ = std::chrono::steady_clock::now();
-        uv_timer_start(&heartbeat_timer_, on_heartbeat_timer,
-                       HEARTBEAT_INTERVAL_MS, HEARTBEAT_INTERVAL_MS);
-    }
+        uint64_t token = 0;
+        uint16_t port = 0;
+        DatagramKey key;
+        if (datagram_ || !decode_datagram_bind(packet.data(), token, port, key))
+        {
+            spdlog::warn("服务器未提供数据报通道，不可靠消息经连接发送");
+            return;
+        }
 
-    void Client::stop_heartbeat()
-    {
-        uv_timer_stop(&heartbeat_timer_);
-    }
+        // 服务器的 UDP 地址：连接的对端地址加上答复的端口
+        struct sockaddr_storage server_addr;
+        int addr_len = sizeof(server_addr);
+        if (uv_tcp_getpeername(&session_->get_socket(), reinterpret_cast<struct sockaddr *>(&server_addr), &addr_len) != 0)
+        {
+            return;
+        }
+        struct sockaddr_storage local_addr;
+        if (server_addr.ss_family == AF_INET6)
+        {
+            reinterpret_cast<struct sockaddr_in6 *>(&server_addr)->sin6_port = htons(port);
+            uv_ip6_addr("::", 0, reinterpret_cast<struct sockaddr_in6 *>(&local_addr));
+        }
+        else
+        {
+            reinterpret_cast<struct sockaddr_in *>(&server_addr)->sin_port = htons(port);
+            uv_ip4_addr("0.0.0.0", 0, reinterpret_cast<struct sockaddr_in *>(&local_addr));
+        }
 
-    void Client::send_heartbeat()
-    {
-        auto packet = std::make_shared<Packet>(PacketType::HEARTBEAT, std::vector<uint8_t>());
-        send(packet);
+        auto socket = std::make_unique<DatagramSocket>(loop_);
+        int result = socket->bind(reinterpret_cast<const struct sockaddr *>(&local_addr));
+        if (!result)
+        {
+            result = socket->connect(reinterpret_cast<const struct sockaddr *>(&server_addr));
+        }
+        if (!result)
+        {
+            socket->add_token(token, key);
+            result = socket->start([this](const sockaddr *, uint64_t token, uint64_t, const uint8_t *data, size_t size)
+                                   {
+                                       if (session_ && token == session_->datagram_token())
+                                       {
+                                           session_->receive_datagram(data, size);
+                                       } });
+        }
+        if (result)
+        {
+            spdlog::error("创建数据报通道失败: {}", uv_strerror(result));
+            return;
+        }
+
+        // 先发一个只有令牌的数据报，服务器据此记录本端的地址
+        datagram_ = std::move(socket);
+        session_->attach_datagram(datagram_.get(), token);
+        datagram_->send_token(nullptr, token);
+        spdlog::info("数据报通道已建立，服务器 UDP 端口 {}", port);
     }
 
 } // namespace libuv_net
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "libuv_net/client_context.hpp"
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+namespace libuv_net
+{
+
+    // 一个事件循环及其线程和任务队列
+    struct ClientContext::Loop
+    {
+        uv_loop_t *loop;
+        uv_async_t async; // 唤醒循环执行排队的任务
+        ClientContext *context;
+        std::mutex mutex;
+        std::vector<Task> tasks; // 其他线程投递的任务
+        bool accepting = false;  // 是否接受投递，与任务队列一起由 mutex 保护
+        std::thread thread;
+        std::atomic<std::thread::id> thread_id{};
+
+        // 取出并执行排队的任务
+        void run_tasks()
+        {
+            std::vector<Task> batch;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                batch.swap(tasks);
+            }
+            for (auto &task : batch)
+            {
+                task();
+            }
+        }
+    };
+
+    ClientContext::ClientContext(size_t loops, size_t pool_threads) : thread_pool_(pool_threads)
+    {
+        if (loops == 0)
+        {
+            loops = 1;
+        }
+        for (size_t i = 0; i < loops; ++i)
+        {
+            auto entry = std::make_unique<Loop>();
+            entry->loop = uv_loop_new();
+            if (!entry->loop)
+            {
+                throw std::runtime_error("创建事件循环失败");
+            }
+            entry->context = this;
+            uv_async_init(entry->loop, &entry->async, on_async);
+            entry->async.data = entry.get();
+            loops_.push_back(std::move(entry));
+        }
+    }
+
+    ClientContext::~ClientContext()
+    {
+        stop();
+        for (auto &entry : loops_)
+        {
+            uv_close(reinterpret_cast<uv_handle_t *>(&entry->async), nullptr);
+
+            // 执行剩余的关闭回调，确保句柄在删除事件循环前全部关闭
+            uv_run(entry->loop, UV_RUN_DEFAULT);
+            uv_loop_delete(entry->loop);
+        }
+    }
+
+    bool ClientContext::start()
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (running_)
+        {
+            spdlog::warn("事件循环已经在运行");
+            return false;
+        }
+
+        // 事件循环阻塞在 I/O 上，停止时由 uv_async_t 唤醒，不需要定时检查停止标志
+        should_stop_ = false;
+        for (auto &entry : loops_)
+        {
+            Loop *loop = entry.get();
+            {
+                std::lock_guard<std::mutex> queue_lock(loop->mutex);
+                loop->accepting = true;
+            }
+            loop->thread = std::thread([this, loop]()
+                                       {
+                loop->thread_id = std::this_thread::get_id();
+                spdlog::info("事件循环线程启动");
+                while (!should_stop_)
+                {
+                    uv_run(loop->loop, UV_RUN_DEFAULT);
+                }
+                loop->thread_id = std::thread::id();
+                spdlog::info("事件循环线程退出"); });
+        }
+        running_ = true;
+        return true;
+    }
+
+    void ClientContext::stop()
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (!running_)
+        {
+            return;
+        }
+
+        should_stop_ = true;
+        for (auto &entry : loops_)
+        {
+            uv_async_send(&entry->async);
+        }
+        for (auto &entry : loops_)
+        {
+            entry->thread.join();
+        }
+        running_ = false;
+
+        // 停止接受投递，之前投递的任务在调用线程中执行完，run_sync() 的调用者不会一直等待；
+        // 之后投递的任务由 enqueue() 拒绝，调用者在自己的线程中执行
+        for (auto &entry : loops_)
+        {
+            {
+                std::lock_guard<std::mutex> queue_lock(entry->mutex);
+                entry->accepting = false;
+            }
+            entry->run_tasks();
+        }
+    }
+
+    uv_loop_t *ClientContext::acquire_loop()
+    {
+        return loops_[next_loop_++ % loops_.size()]->loop;
+    }
+
+    ClientContext::Loop &ClientContext::find(uv_loop_t *loop) const
+    {
+        for (auto &entry : loops_)
+        {
+            if (entry->loop == loop)
+            {
+                return *entry;
+            }
+        }
+        throw std::invalid_argument("事件循环不属于该运行时");
+    }
+
+    bool ClientContext::in_loop_thread(uv_loop_t *loop) const
+    {
+        return find(loop).thread_id == std::this_thread::get_id();
+    }
+
+    bool ClientContext::enqueue(uv_loop_t *loop, Task &task)
+    {
+        Loop &entry = find(loop);
+        {
+            // 检查和入队在同一把锁内，不会在 stop() 取走剩余任务之后入队
+            std::lock_guard<std::mutex> lock(entry.mutex);
+            if (!entry.accepting)
+            {
+                return false;
+            }
+            entry.tasks.push_back(std::move(task));
+        }
+        uv_async_send(&entry.async);
+        return true;
+    }
+
+    void ClientContext::on_async(uv_async_t *handle)
+    {
+        auto loop = static_cast<Loop *>(handle->data);
+        loop->run_tasks();
+        if (loop->context->should_stop_)
+        {
+            uv_stop(loop->loop);
+        }
+    }
+
+} // namespace libuv_net
@@ -0,0 +1,481 @@
+#include "libuv_net/client_pool.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <thread>
+
+namespace libuv_net
+{
+
+    // 未答复的请求
+    struct Request
+    {
+        std::chrono::steady_clock::time_point sent_at;
+        size_t depth; // 发送时端点上未答复的请求数，含本请求
+    };
+
+    // 连接池中的一个连接
+    struct ClientPool::Connection
+    {
+        std::unique_ptr<Client> client;
+        size_t endpoint;                                         // 所属端点的下标
+        bool spare;                                              // 备用连接只在没有活跃连接时参与选择
+        bool connected = false;
+        bool connecting = false;
+        std::deque<Request> in_flight;                           // 未答复的请求
+        double rtt_us = 0;                                       // 往返时间的指数加权平均，0 表示尚无样本
+        double service_us = 0;                                   // 每个请求占用的时间（往返时间 / 发送时端点的队列长度）
+        uint64_t sent = 0;
+    };
+
+    struct ClientPool::EndpointState
+    {
+        Endpoint endpoint;
+        std::deque<std::chrono::steady_clock::time_point> failures; // 时间窗口内失败的时间
+        size_t outstanding = 0;                            // 各连接上未答复的请求数之和
+        std::chrono::steady_clock::time_point ejected_until; // 摘除的截止时间
+    };
+
+    ClientPool::ClientPool(const ClientPoolOptions &options, std::shared_ptr<ClientContext> context)
+        : owns_context_(!context), context_(context ? std::move(context) : std::make_shared<ClientContext>()),
+          options_(options)
+    {
+        if (options_.connections_per_endpoint == 0)
+        {
+            options_.connections_per_endpoint = 1;
+        }
+
+        loop_ = context_->acquire_loop();
+        context_->run_sync(loop_, [this]()
+                           {
+                               uv_timer_init(loop_, &maintain_timer_);
+                               maintain_timer_.data = this; });
+    }
+
+    ClientPool::~ClientPool()
+    {
+        stop();
+
+        context_->run_sync(loop_, [this]()
+                           { uv_close(reinterpret_cast<uv_handle_t *>(&maintain_timer_), [](uv_handle_t *handle)
+                                      { static_cast<ClientPool *>(handle->data)->timer_closed_ = true; }); });
+        while (!timer_closed_)
+        {
+            if (context_->running())
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            else
+            {
+                uv_run(loop_, UV_RUN_NOWAIT);
+            }
+        }
+    }
+
+    bool ClientPool::start(const std::vector<Endpoint> &endpoints)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (running_)
+            {
+                spdlog::warn("连接池已经启动");
+                return false;
+            }
+            if (endpoints.empty())
+            {
+                spdlog::error("连接池没有端点");
+                return false;
+            }
+
+            size_t per_endpoint = options_.connections_per_endpoint + options_.warm_spares;
+            for (size_t i = 0; i < endpoints.size(); ++i)
+            {
+                auto state = std::make_unique<EndpointState>();
+                state->endpoint = endpoints[i];
+                endpoints_.push_back(std::move(state));
+
+                for (size_t j = 0; j < per_endpoint; ++j)
+                {
+                    auto connection = std::make_unique<Connection>();
+                    connection->endpoint = i;
+                    connection->spare = j >= options_.connections_per_endpoint;
+                    connection->client = std::make_unique<Client>(context_);
+
+                    // 回调中只持有连接的裸指针，连接在客户端销毁之后才释放
+                    Connection *raw = connection.get();
+                    Client &client = *connection->client;
+                    client.set_connect_handler([this, raw]()
+                                               { on_connected(raw); });
+                    client.set_disconnect_handler([this, raw]()
+                                                  { on_disconnected(raw); });
+                    client.set_connect_error_handler([this, raw](int)
+                                                     { on_connect_error(raw); });
+                    for (const auto &entry : handlers_)
+                    {
+                        client.set_packet_handler(entry.first, [this, raw, handler = entry.second](std::shared_ptr<Packet> packet)
+                                                  {
+                                                      on_reply(raw);
+                                                      handler(std::move(packet)); });
+                    }
+                    client.set_default_packet_handler([this, raw](std::shared_ptr<Packet> packet)
+                                                      {
+                                                          on_reply(raw);
+                                                          if (default_handler_)
+                                                          {
+                                                              default_handler_(std::move(packet));
+                                                          } });
+                    connections_.push_back(std::move(connection));
+                }
+            }
+            running_ = true;
+            ++generation_;
+        }
+
+        if (owns_context_ && !context_->running())
+        {
+            context_->start();
+        }
+
+        // 立即发起所有连接，之后定期重连断开的连接
+        maintain();
+        auto interval = static_cast<uint64_t>(options_.reconnect_interval.count());
+        context_->run_sync(loop_, [this, interval]()
+                           { uv_timer_start(&maintain_timer_, on_maintain_timer, interval, interval); });
+        return true;
+    }
+
+    void ClientPool::stop()
+    {
+        std::vector<std::unique_ptr<Connection>> connections;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_)
+            {
+                return;
+            }
+            running_ = false;
+            connections.swap(connections_);
+            endpoints_.clear();
+        }
+
+        context_->run_sync(loop_, [this]()
+                           { uv_timer_stop(&maintain_timer_); });
+
+        // 先销毁客户端，关闭过程中的回调看到 running_ 为 false 后不再访问连接。
+        // 定时器停止后 maintain() 不再投递；客户端在自己的事件循环中同步销毁，
+        // 之前投递到该循环的连接任务都已执行完，不会在连接池销毁后访问连接池
+        for (auto &connection : connections)
+        {
+            connection->client.reset();
+        }
+        if (owns_context_)
+        {
+            context_->stop();
+        }
+    }
+
+    bool ClientPool::send(std::shared_ptr<Packet> packet)
+    {
+        Client *client = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_)
+            {
+                return false;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            Connection *connection = select(now);
+            if (!connection)
+            {
+                spdlog::warn("连接池没有可用的连接，无法发送消息");
+                return false;
+            }
+            size_t depth = ++endpoints_[connection->endpoint]->outstanding;
+            connection->in_flight.push_back(Request{now, depth});
+            ++connection->sent;
+            client = connection->client.get();
+        }
+
+        client->send(std::move(packet));
+        return true;
+    }
+
+    ClientPool::Connection *ClientPool::select(std::chrono::steady_clock::time_point now)
+    {
+        // 依次放宽条件：未摘除端点的活跃连接、未摘除端点的备用连接、任意已连接的连接
+        auto &candidates = candidates_;
+        candidates.clear();
+        for (int pass = 0; pass < 3 && candidates.empty(); ++pass)
+        {
+            for (auto &connection : connections_)
+            {
+                bool ejected = endpoints_[connection->endpoint]->ejected_until > now;
+                if (connection->connected && (pass == 2 || (!ejected && (pass == 1 || !connection->spare))))
+                {
+                    candidates.push_back(connection.get());
+                }
+            }
+        }
+
+        if (candidates.empty())
+        {
+            return nullptr;
+        }
+        if (candidates.size() == 1)
+        {
+            return candidates.front();
+        }
+        return options_.policy == BalancePolicy::LEAST_OUTSTANDING ? least_outstanding(candidates)
+                                                                   : power_of_two_choices(candidates);
+    }
+
+    ClientPool::Connection *ClientPool::least_outstanding(const std::vector<Connection *> &candidates) const
+    {
+        return *std::min_element(candidates.begin(), candidates.end(), [](const Connection *a, const Connection *b)
+                                 {
+                                     if (a->in_flight.size() != b->in_flight.size())
+                                     {
+                                         return a->in_flight.size() < b->in_flight.size();
+                                     }
+                                     return a->rtt_us < b->rtt_us; });
+    }
+
+    ClientPool::Connection *ClientPool::power_of_two_choices(const std::vector<Connection *> &candidates)
+    {
+        std::uniform_int_distribution<size_t> pick(0, candidates.size() - 1);
+        size_t first = pick(random_);
+        size_t second = pick(random_);
+        if (second == first)
+        {
+            second = (first + 1) % candidates.size();
+        }
+
+        // 预计的等待时间。同一端点的连接在服务器上共用一个队列，按端点的未答复请求数计算；
+        // 往返时间已包含排队，按每个请求占用的时间计算，避免重复计入队列长度。
+        // 尚无样本的连接按 1 微秒计，优先获得请求以取得样本
+        auto cost = [this](const Connection *connection)
+        {
+            size_t depth = endpoints_[connection->endpoint]->outstanding;
+            return static_cast<double>(depth + 1) * std::max(connection->service_us, 1.0);
+        };
+        double first_cost = cost(candidates[first]);
+        double second_cost = cost(candidates[second]);
+        if (first_cost != second_cost)
+        {
+            return first_cost < second_cost ? candidates[first] : candidates[second];
+        }
+        return candidates[first]->in_flight.size() <= candidates[second]->in_flight.size() ? candidates[first]
+                                                                                             : candidates[second];
+    }
+
+    void ClientPool::promote_spares(size_t endpoint)
+    {
+        auto belongs = [endpoint](const std::unique_ptr<Connection> &connection)
+        {
+            return connection->endpoint == endpoint;
+        };
+        for (auto &active : connections_)
+        {
+            if (!belongs(active) || active->spare || active->connected)
+            {
+                continue;
+            }
+            auto spare = std::find_if(connections_.begin(), connections_.end(), [&](const std::unique_ptr<Connection> &c)
+                                      { return belongs(c) && c->spare && c->connected; });
+            if (spare == connections_.end())
+            {
+                return;
+            }
+            active->spare = true;
+            (*spare)->spare = false;
+        }
+    }
+
+    void ClientPool::record_failure(EndpointState &endpoint)
+    {
+        auto now = std::chrono::steady_clock::now();
+        endpoint.failures.push_back(now);
+        while (endpoint.failures.front() + options_.failure_window < now)
+        {
+            endpoint.failures.pop_front();
+        }
+        if (endpoint.failures.size() < options_.eject_after_failures)
+        {
+            return;
+        }
+        endpoint.failures.clear();
+        endpoint.ejected_until = now + options_.eject_duration;
+        spdlog::warn("端点 {}:{} 在 {} 毫秒内失败 {} 次，摘除 {} 毫秒", endpoint.endpoint.host, endpoint.endpoint.port,
+                     options_.failure_window.count(), options_.eject_after_failures, options_.eject_duration.count());
+    }
+
+    void ClientPool::on_connected(Connection *connection)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_)
+        {
+            return;
+        }
+        connection->connected = true;
+        connection->connecting = false;
+        promote_spares(connection->endpoint);
+    }
+
+    void ClientPool::on_disconnected(Connection *connection)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_)
+        {
+            return;
+        }
+        connection->connected = false;
+        connection->connecting = false;
+        endpoints_[connection->endpoint]->outstanding -= connection->in_flight.size();
+        connection->in_flight.clear();
+        record_failure(*endpoints_[connection->endpoint]);
+        promote_spares(connection->endpoint);
+    }
+
+    void ClientPool::on_connect_error(Connection *connection)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_)
+        {
+            return;
+        }
+        connection->connecting = false;
+        record_failure(*endpoints_[connection->endpoint]);
+    }
+
+    void ClientPool::on_reply(Connection *connection)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_ || connection->in_flight.empty())
+        {
+            return;
+        }
+        const Request &request = connection->in_flight.front();
+        double sample = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - request.sent_at).count();
+        double service = sample / static_cast<double>(request.depth);
+        connection->in_flight.pop_front();
+        --endpoints_[connection->endpoint]->outstanding;
+
+        auto update = [](double average, double value)
+        {
+            return average == 0 ? value : average * (1 - POOL_RTT_EWMA_WEIGHT) + value * POOL_RTT_EWMA_WEIGHT;
+        };
+        connection->rtt_us = update(connection->rtt_us, sample);
+        connection->service_us = update(connection->service_us, service);
+    }
+
+    void ClientPool::on_maintain_timer(uv_timer_t *handle)
+    {
+        static_cast<ClientPool *>(handle->data)->maintain();
+    }
+
+    void ClientPool::maintain()
+    {
+        // 在锁外投递，连接与连接池在同一个事件循环时任务直接执行，连接失败的回调会获取锁
+        struct Pending
+        {
+            Connection *connection;
+            uv_loop_t *loop;
+            Endpoint endpoint;
+        };
+        std::vector<Pending> pending;
+        uint64_t generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_)
+            {
+                return;
+            }
+            auto now = std::chrono::steady_clock::now();
+            for (auto &connection : connections_)
+            {
+                auto &endpoint = *endpoints_[connection->endpoint];
+                if (connection->connected || connection->connecting || endpoint.ejected_until > now)
+                {
+                    continue;
+                }
+                connection->connecting = true;
+                pending.push_back(Pending{connection.get(), connection->client->loop(), endpoint.endpoint});
+            }
+            generation = generation_;
+        }
+
+        // 定时器回调在连接池的事件循环线程中执行，不能同步等待其他循环，否则两个循环可能互相等待。
+        // 解锁后连接池可能已停止，这里不再访问连接
+        for (auto &entry : pending)
+        {
+            context_->post(entry.loop, [this, connection = entry.connection, generation, endpoint = entry.endpoint]()
+                           { start_connect(connection, generation, endpoint); });
+        }
+    }
+
+    void ClientPool::start_connect(Connection *connection, uint64_t generation, const Endpoint &endpoint)
+    {
+        // 投递之后连接池可能已停止，连接已销毁，先确认任务未过期再访问连接。
+        // 客户端在自己的事件循环中销毁，本任务执行期间不会被销毁
+        Client *client = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_ || generation != generation_)
+            {
+                return;
+            }
+            client = connection->client.get();
+        }
+
+        // 已在客户端的事件循环线程中，connect() 直接执行，不等待
+        if (!client->connect(endpoint.host, endpoint.port))
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (running_ && generation == generation_)
+            {
+                connection->connecting = false;
+            }
+        }
+    }
+
+    size_t ClientPool::active_count() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        return static_cast<size_t>(std::count_if(connections_.begin(), connections_.end(), [&](const std::unique_ptr<Connection> &c)
+                                                 { return c->connected && !c->spare && endpoints_[c->endpoint]->ejected_until <= now; }));
+    }
+
+    std::vector<EndpointStats> ClientPool::stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        std::vector<EndpointStats> result;
+        for (auto &endpoint : endpoints_)
+        {
+            result.push_back(EndpointStats{endpoint->endpoint, 0, endpoint->outstanding, 0, 0, endpoint->ejected_until > now});
+        }
+
+        std::vector<size_t> samples(endpoints_.size());
+        for (auto &connection : connections_)
+        {
+            auto &stats = result[connection->endpoint];
+            stats.connected += connection->connected ? 1 : 0;
+            stats.sent += connection->sent;
+            if (connection->rtt_us > 0)
+            {
+                stats.rtt_us += connection->rtt_us;
+                ++samples[connection->endpoint];
+            }
+        }
+        for (size_t i = 0; i < result.size(); ++i)
+        {
+            if (samples[i] > 0)
+            {
+                result[i].rtt_us /= static_cast<double>(samples[i]);
+            }
+        }
+        return result;
+    }
+
+} // namespace libuv_net
@@ -0,0 +1,357 @@
+#include "libuv_net/datagram.hpp"
+#include <spdlog/spdlog.h>
+#include <cstring>
+#include <memory>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netinet/in.h>
+#endif
+
+namespace libuv_net
+{
+
+    namespace
+    {
+        // 接收缓冲区大小，容纳最大的数据报
+        constexpr size_t RECV_BUFFER_SIZE = 64 * 1024;
+
+        // 每个事件循环线程一个接收缓冲区，接收回调中同步处理完毕
+        char *thread_recv_buffer()
+        {
+            thread_local std::unique_ptr<char[]> buffer(new char[RECV_BUFFER_SIZE]);
+            return buffer.get();
+        }
+
+        // 排队发送的数据报，持有数据直到发送完成
+        struct SendRequest
+        {
+            uv_udp_send_t req;
+            std::vector<uint8_t> data;
+        };
+
+        size_t address_length(const sockaddr *addr)
+        {
+            return addr->sa_family == AF_INET6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in);
+        }
+
+        // 按小端序读取 8 字节，与主机字节序无关
+        uint64_t load_le64(const uint8_t *data)
+        {
+            uint64_t value = 0;
+            for (int i = 7; i >= 0; --i)
+            {
+                value = (value << 8) | data[i];
+            }
+            return value;
+        }
+
+        uint64_t rotl(uint64_t value, int bits)
+        {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        void sip_round(uint64_t &v0, uint64_t &v1, uint64_t &v2, uint64_t &v3)
+        {
+            v0 += v1;
+            v1 = rotl(v1, 13);
+            v1 ^= v0;
+            v0 = rotl(v0, 32);
+            v2 += v3;
+            v3 = rotl(v3, 16);
+            v3 ^= v2;
+            v0 += v3;
+            v3 = rotl(v3, 21);
+            v3 ^= v0;
+            v2 += v1;
+            v1 = rotl(v1, 17);
+            v1 ^= v2;
+            v2 = rotl(v2, 32);
+        }
+
+        // 比较标签，耗时与不相同的位置无关
+        bool tags_equal(const uint8_t *a, const uint8_t *b)
+        {
+            uint8_t diff = 0;
+            for (size_t i = 0; i < DATAGRAM_TAG_SIZE; ++i)
+            {
+                diff |= a[i] ^ b[i];
+            }
+            return diff == 0;
+        }
+    }
+
+    uint64_t datagram_tag(const DatagramKey &key, const uint8_t *data, size_t size)
+    {
+        uint64_t k0 = load_le64(key.data());
+        uint64_t k1 = load_le64(key.data() + 8);
+        uint64_t v0 = k0 ^ 0x736f6d6570736575ULL;
+        uint64_t v1 = k1 ^ 0x646f72616e646f6dULL;
+        uint64_t v2 = k0 ^ 0x6c7967656e657261ULL;
+        uint64_t v3 = k1 ^ 0x7465646279746573ULL;
+
+        size_t full = size & ~static_cast<size_t>(7);
+        for (size_t offset = 0; offset < full; offset += 8)
+        {
+            uint64_t m = load_le64(data + offset);
+            v3 ^= m;
+            sip_round(v0, v1, v2, v3);
+            sip_round(v0, v1, v2, v3);
+            v0 ^= m;
+        }
+
+        // 最后一块：剩余字节加上长度的低 8 位
+        uint64_t last = static_cast<uint64_t>(size) << 56;
+        for (size_t i = 0; i < size - full; ++i)
+        {
+            last |= static_cast<uint64_t>(data[full + i]) << (8 * i);
+        }
+        v3 ^= last;
+        sip_round(v0, v1, v2, v3);
+        sip_round(v0, v1, v2, v3);
+        v0 ^= last;
+
+        v2 ^= 0xff;
+        for (int i = 0; i < 4; ++i)
+        {
+            sip_round(v0, v1, v2, v3);
+        }
+        return v0 ^ v1 ^ v2 ^ v3;
+    }
+
+    DatagramSocket::DatagramSocket(uv_loop_t *loop) : udp_(new uv_udp_t), prepare_(new uv_prepare_t)
+    {
+        uv_udp_init(loop, udp_);
+        udp_->data = this;
+        uv_prepare_init(loop, prepare_);
+        prepare_->data = this;
+    }
+
+    DatagramSocket::~DatagramSocket()
+    {
+        close();
+    }
+
+    int DatagramSocket::bind(const sockaddr *addr)
+    {
+        return uv_udp_bind(udp_, addr, UV_UDP_REUSEADDR);
+    }
+
+    int DatagramSocket::connect(const sockaddr *addr)
+    {
+        int result = uv_udp_connect(udp_, addr);
+        connected_ = result == 0;
+        return result;
+    }
+
+    int DatagramSocket::start(ReceiveHandler handler)
+    {
+        handler_ = std::move(handler);
+        return uv_udp_recv_start(udp_, on_alloc, on_recv);
+    }
+
+    void DatagramSocket::add_token(uint64_t token, const DatagramKey &key)
+    {
+        endpoints_[token] = Endpoint{key, 0};
+    }
+
+    void DatagramSocket::remove_token(uint64_t token)
+    {
+        endpoints_.erase(token);
+        batches_.erase(token);
+    }
+
+    DatagramSocket::Batch &DatagramSocket::batch_for(const sockaddr *addr, uint64_t token, size_t size)
+    {
+        constexpr size_t header_size = DATAGRAM_TOKEN_SIZE + DATAGRAM_COUNTER_SIZE;
+        auto [it, inserted] = batches_.try_emplace(token);
+        Batch &batch = it->second;
+        if (!inserted && batch.data.size() > header_size &&
+            batch.data.size() + size + DATAGRAM_TAG_SIZE > DATAGRAM_BATCH_SIZE)
+        {
+            send_datagram(token, batch);
+            batch.data.clear();
+        }
+        if (batch.data.empty())
+        {
+            // 发送计数在发出时写入
+            batch.data.reserve(DATAGRAM_BATCH_SIZE);
+            batch.data.resize(header_size);
+            std::memcpy(batch.data.data(), &token, DATAGRAM_TOKEN_SIZE);
+        }
+
+        // 对端地址可能变化，以最后一次发送时的地址为准
+        batch.has_addr = addr != nullptr;
+        if (addr)
+        {
+            std::memcpy(&batch.addr, addr, address_length(addr));
+        }
+
+        uv_prepare_start(prepare_, on_prepare);
+        return batch;
+    }
+
+    bool DatagramSocket::send(const sockaddr *addr, uint64_t token, PacketType type, uint32_t sequence,
+                              const uint8_t *data, size_t size)
+    {
+        size_t frame_size = sizeof(PacketHeader) + size;
+        if (!udp_ || DATAGRAM_OVERHEAD + frame_size > DATAGRAM_MAX_SIZE || !endpoints_.count(token))
+        {
+            return false;
+        }
+
+        Batch &batch = batch_for(addr, token, frame_size);
+        size_t offset = batch.data.size();
+        batch.data.resize(offset + frame_size);
+        write_packet_header(batch.data.data() + offset, type, static_cast<uint32_t>(size), sequence);
+        if (size > 0)
+        {
+            std::memcpy(batch.data.data() + offset + sizeof(PacketHeader), data, size);
+        }
+        return true;
+    }
+
+    void DatagramSocket::send_token(const sockaddr *addr, uint64_t token)
+    {
+        if (udp_ && endpoints_.count(token))
+        {
+            batch_for(addr, token, 0);
+        }
+    }
+
+    void DatagramSocket::send_datagram(uint64_t token, Batch &batch)
+    {
+        auto endpoint = endpoints_.find(token);
+        if (endpoint == endpoints_.end())
+        {
+            return;
+        }
+        uint64_t counter = ++endpoint->second.sent;
+        std::memcpy(batch.data.data() + DATAGRAM_TOKEN_SIZE, &counter, DATAGRAM_COUNTER_SIZE);
+        uint64_t tag = datagram_tag(endpoint->second.key, batch.data.data(), batch.data.size());
+        size_t offset = batch.data.size();
+        batch.data.resize(offset + DATAGRAM_TAG_SIZE);
+        std::memcpy(batch.data.data() + offset, &tag, DATAGRAM_TAG_SIZE);
+
+        const sockaddr *addr = batch.has_addr && !connected_ ? reinterpret_cast<const sockaddr *>(&batch.addr) : nullptr;
+        uv_buf_t buf = uv_buf_init(reinterpret_cast<char *>(batch.data.data()), static_cast<unsigned int>(batch.data.size()));
+        int result = uv_udp_try_send(udp_, &buf, 1, addr);
+        if (result == UV_EAGAIN)
+        {
+            // 内核缓冲区已满或已有排队的数据报，排队等待可写
+            auto request = new SendRequest{uv_udp_send_t{}, std::move(batch.data)};
+            buf = uv_buf_init(reinterpret_cast<char *>(request->data.data()), static_cast<unsigned int>(request->data.size()));
+            result = uv_udp_send(&request->req, udp_, &buf, 1, addr, [](uv_udp_send_t *req, int)
+                                 { delete reinterpret_cast<SendRequest *>(req); });
+            if (result)
+            {
+                delete request;
+            }
+        }
+        if (result < 0)
+        {
+            spdlog::debug("数据报发送失败，已丢弃: {}", uv_strerror(result));
+        }
+    }
+
+    void DatagramSocket::flush()
+    {
+        if (!udp_)
+        {
+            return;
+        }
+
+        for (auto &entry : batches_)
+        {
+            send_datagram(entry.first, entry.second);
+        }
+        batches_.clear();
+        uv_prepare_stop(prepare_);
+    }
+
+    void DatagramSocket::close()
+    {
+        if (!udp_)
+        {
+            return;
+        }
+
+        batches_.clear();
+        uv_close(reinterpret_cast<uv_handle_t *>(udp_), [](uv_handle_t *handle)
+                 { delete reinterpret_cast<uv_udp_t *>(handle); });
+        uv_close(reinterpret_cast<uv_handle_t *>(prepare_), [](uv_handle_t *handle)
+                 { delete reinterpret_cast<uv_prepare_t *>(handle); });
+        udp_ = nullptr;
+        prepare_ = nullptr;
+    }
+
+    int DatagramSocket::local_port() const
+    {
+        if (!udp_)
+        {
+            return 0;
+        }
+
+        sockaddr_storage addr;
+        int addr_len = sizeof(addr);
+        if (uv_udp_getsockname(udp_, reinterpret_cast<sockaddr *>(&addr), &addr_len) != 0)
+        {
+            return 0;
+        }
+        return addr.ss_family == AF_INET6 ? ntohs(reinterpret_cast<sockaddr_in6 *>(&addr)->sin6_port)
+                                          : ntohs(reinterpret_cast<sockaddr_in *>(&addr)->sin_port);
+    }
+
+    void DatagramSocket::on_alloc(uv_handle_t * /*handle*/, size_t /*suggested_size*/, uv_buf_t *buf)
+    {
+        *buf = uv_buf_init(thread_recv_buffer(), RECV_BUFFER_SIZE);
+    }
+
+    void DatagramSocket::on_recv(uv_udp_t *handle, ssize_t nread, const uv_buf_t *buf, const sockaddr *addr, unsigned flags)
+    {
+        auto self = static_cast<DatagramSocket *>(handle->data);
+        if (nread < 0)
+        {
+            spdlog::debug("数据报接收错误: {}", uv_strerror(static_cast<int>(nread)));
+            return;
+        }
+
+        // nread 为 0 且地址为空表示本轮没有更多数据；被截断的数据报无法分帧，直接丢弃
+        if (!addr || (flags & UV_UDP_PARTIAL) || static_cast<size_t>(nread) < DATAGRAM_OVERHEAD)
+        {
+            return;
+        }
+
+        // 未登记的令牌和标签不符的数据报不交给回调
+        const uint8_t *data = reinterpret_cast<const uint8_t *>(buf->base);
+        size_t size = static_cast<size_t>(nread);
+        uint64_t token;
+        std::memcpy(&token, data, DATAGRAM_TOKEN_SIZE);
+        auto endpoint = self->endpoints_.find(token);
+        if (endpoint == self->endpoints_.end())
+        {
+            return;
+        }
+        uint64_t tag = datagram_tag(endpoint->second.key, data, size - DATAGRAM_TAG_SIZE);
+        if (!tags_equal(reinterpret_cast<const uint8_t *>(&tag), data + size - DATAGRAM_TAG_SIZE))
+        {
+            spdlog::debug("丢弃认证失败的数据报");
+            return;
+        }
+
+        uint64_t counter;
+        std::memcpy(&counter, data + DATAGRAM_TOKEN_SIZE, DATAGRAM_COUNTER_SIZE);
+        if (self->handler_)
+        {
+            self->handler_(addr, token, counter, data + DATAGRAM_TOKEN_SIZE + DATAGRAM_COUNTER_SIZE,
+                           size - DATAGRAM_OVERHEAD);
+        }
+    }
+
+    void DatagramSocket::on_prepare(uv_prepare_t *handle)
+    {
+        static_cast<DatagramSocket *>(handle->data)->flush();
+    }
+
+} // namespace libuv_net
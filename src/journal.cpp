@@ -0,0 +1,585 @@
+#include "libuv_net/journal.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace libuv_net
+{
+
+    namespace
+    {
+        constexpr uint64_t ACK_MAGIC = 0x316b63615f76756cULL; // "luv_ack1"
+        constexpr size_t ACK_FILE_SIZE = 4096;
+        constexpr size_t SEGMENT_NAME_DIGITS = 20;
+        constexpr const char *SEGMENT_SUFFIX = ".seg";
+
+        // 按 8 字节处理的 FNV-1a，每步把高位折回低位
+        uint32_t checksum(const uint8_t *data, size_t size)
+        {
+            constexpr uint64_t PRIME = 1099511628211ULL;
+            uint64_t hash = 14695981039346656037ULL ^ size;
+            size_t i = 0;
+            for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+            {
+                uint64_t word;
+                std::memcpy(&word, data + i, sizeof(word));
+                hash = (hash ^ word) * PRIME;
+                hash ^= hash >> 32;
+            }
+            for (; i < size; ++i)
+            {
+                hash = (hash ^ data[i]) * PRIME;
+            }
+            // 再乘一次，最后一轮乘积的高 32 位才能影响结果
+            hash *= PRIME;
+            return static_cast<uint32_t>(hash ^ (hash >> 32));
+        }
+
+        // 下一个位置，跳过低 32 位为 0 的位置，序列号 0 表示不带序列号
+        uint64_t next_index(uint64_t index)
+        {
+            ++index;
+            if (static_cast<uint32_t>(index) == 0)
+            {
+                ++index;
+            }
+            return index;
+        }
+
+        // 段文件以第一条记录的位置命名，按文件名排序即按序列号排序
+        std::string segment_name(uint64_t first_index)
+        {
+            char name[32];
+            std::snprintf(name, sizeof(name), "%020llu%s", static_cast<unsigned long long>(first_index), SEGMENT_SUFFIX);
+            return name;
+        }
+
+        bool parse_segment_name(const std::string &name, uint64_t &first_index)
+        {
+            if (name.size() != SEGMENT_NAME_DIGITS + std::strlen(SEGMENT_SUFFIX) ||
+                name.compare(SEGMENT_NAME_DIGITS, std::string::npos, SEGMENT_SUFFIX) != 0 ||
+                !std::all_of(name.begin(), name.begin() + SEGMENT_NAME_DIGITS, [](char c)
+                             { return c >= '0' && c <= '9'; }))
+            {
+                return false;
+            }
+            first_index = std::strtoull(name.c_str(), nullptr, 10);
+            return first_index != 0;
+        }
+    }
+
+    // 一个映射的文件：段文件或 ack 文件
+    struct Journal::Segment
+    {
+        std::string path;
+        int fd = -1;
+        uint8_t *base = nullptr;
+        size_t size = 0;
+        uint64_t first_index = 0; // 第一条记录的位置
+        uint64_t last_index = 0;  // 最后一条记录的位置，没有记录时为 0
+        size_t written = 0;       // 已写入映射区的字节数
+        size_t synced = 0;        // 已写入磁盘的字节数
+
+#ifndef _WIN32
+        ~Segment()
+        {
+            if (base)
+            {
+                munmap(base, size);
+            }
+            if (fd >= 0)
+            {
+                ::close(fd);
+            }
+        }
+#endif
+    };
+
+    // 一次组提交，由线程池执行 msync
+    struct Journal::Commit
+    {
+        struct Range
+        {
+            std::shared_ptr<Segment> segment; // 提交期间保持映射有效
+            size_t begin;
+            size_t end;
+        };
+
+        uv_work_t req;
+        Journal *journal;         // 日志在提交完成前销毁时置空
+        std::vector<Range> ranges;
+        int directory_fd = -1;    // 需要同步目录项时为目录描述符的副本
+        uint64_t index = 0;       // 提交完成后已写入磁盘的位置
+        bool ack = false;         // 是否包含确认位置
+        int error = 0;
+    };
+
+#ifndef _WIN32
+    std::unique_ptr<Journal> Journal::open(uv_loop_t *loop, const JournalOptions &options)
+    {
+        std::unique_ptr<Journal> journal(new Journal());
+        journal->loop_ = loop;
+        journal->options_ = options;
+        const std::string &directory = options.directory;
+        if (directory.empty() || options.segment_size <= JOURNAL_RECORD_HEADER + sizeof(PacketHeader))
+        {
+            spdlog::error("日志的目录或段文件大小无效");
+            return nullptr;
+        }
+
+        if (mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST)
+        {
+            spdlog::error("创建日志目录 {} 失败: {}", directory, std::strerror(errno));
+            return nullptr;
+        }
+        journal->directory_fd_ = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (journal->directory_fd_ < 0)
+        {
+            spdlog::error("打开日志目录 {} 失败: {}", directory, std::strerror(errno));
+            return nullptr;
+        }
+
+        // 确认位置
+        journal->ack_file_ = map_file(directory + "/ack", ACK_FILE_SIZE, O_RDWR | O_CREAT);
+        if (!journal->ack_file_)
+        {
+            return nullptr;
+        }
+        auto ack = reinterpret_cast<uint64_t *>(journal->ack_file_->base);
+        if (ack[0] != ACK_MAGIC)
+        {
+            ack[0] = ACK_MAGIC;
+            ack[1] = 0;
+            journal->ack_dirty_ = true;
+            journal->directory_dirty_ = true;
+        }
+        journal->acked_index_ = ack[1];
+        journal->last_index_ = ack[1];
+
+        // 按序列号顺序恢复段文件
+        std::vector<std::pair<uint64_t, std::string>> names;
+        if (DIR *dir = opendir(directory.c_str()))
+        {
+            while (dirent *entry = readdir(dir))
+            {
+                uint64_t first_index = 0;
+                if (parse_segment_name(entry->d_name, first_index))
+                {
+                    names.emplace_back(first_index, entry->d_name);
+                }
+            }
+            closedir(dir);
+        }
+        std::sort(names.begin(), names.end());
+
+        for (const auto &[first_index, name] : names)
+        {
+            std::string path = directory + "/" + name;
+            auto segment = map_file(path, 0, O_RDWR);
+            if (!segment)
+            {
+                // 创建后未来得及预分配的空文件
+                spdlog::warn("删除无法使用的段文件 {}", path);
+                unlink(path.c_str());
+                continue;
+            }
+            segment->first_index = first_index;
+            if (!journal->segments_.empty() && journal->segments_.back()->last_index != 0 &&
+                first_index != next_index(journal->segments_.back()->last_index))
+            {
+                spdlog::warn("段文件 {} 与之前的段文件不连续", path);
+            }
+            journal->recover(segment);
+            journal->last_index_ = std::max(journal->last_index_, segment->last_index);
+            journal->segments_.push_back(std::move(segment));
+        }
+
+        // 没有记录的最后一个段文件只能从下一个位置开始追加
+        if (!journal->segments_.empty() && journal->segments_.back()->last_index == 0 &&
+            journal->segments_.back()->first_index != next_index(journal->last_index_))
+        {
+            unlink(journal->segments_.back()->path.c_str());
+            journal->segments_.pop_back();
+        }
+        journal->release_segments();
+
+        // 上次运行留在页缓存中的数据在第一次提交时写入磁盘
+        journal->durable_index_ = journal->acked_index_;
+        journal->schedule_commit();
+        if (!journal->pending_.empty())
+        {
+            spdlog::info("日志 {} 中有 {} 个未确认的消息，序列号 {} 到 {}", directory, journal->pending_.size(),
+                         static_cast<uint32_t>(journal->pending_.front().index), journal->last_sequence());
+        }
+        return journal;
+    }
+
+    Journal::~Journal()
+    {
+        if (commit_)
+        {
+            commit_->journal = nullptr;
+        }
+        sync();
+        if (directory_fd_ >= 0)
+        {
+            ::close(directory_fd_);
+        }
+    }
+
+    std::shared_ptr<Journal::Segment> Journal::map_file(const std::string &path, size_t size, int flags)
+    {
+        auto segment = std::make_shared<Segment>();
+        segment->path = path;
+        segment->fd = ::open(path.c_str(), flags | O_CLOEXEC, 0600);
+        if (segment->fd < 0)
+        {
+            spdlog::error("打开日志文件 {} 失败: {}", path, std::strerror(errno));
+            return nullptr;
+        }
+
+        struct stat st;
+        if (fstat(segment->fd, &st) != 0)
+        {
+            return nullptr;
+        }
+        segment->size = std::max(static_cast<size_t>(st.st_size), size);
+        if (segment->size == 0)
+        {
+            return nullptr;
+        }
+
+        // 预分配磁盘块，写入映射区时不会因空间不足收到 SIGBUS
+        if (static_cast<size_t>(st.st_size) < segment->size)
+        {
+            int result = posix_fallocate(segment->fd, 0, static_cast<off_t>(segment->size));
+            if (result == EINVAL || result == EOPNOTSUPP)
+            {
+                result = ftruncate(segment->fd, static_cast<off_t>(segment->size)) == 0 ? 0 : errno;
+            }
+            if (result != 0)
+            {
+                spdlog::error("预分配日志文件 {} 失败: {}", path, std::strerror(result));
+                return nullptr;
+            }
+        }
+
+        void *base = mmap(nullptr, segment->size, PROT_READ | PROT_WRITE, MAP_SHARED, segment->fd, 0);
+        if (base == MAP_FAILED)
+        {
+            spdlog::error("映射日志文件 {} 失败: {}", path, std::strerror(errno));
+            return nullptr;
+        }
+        segment->base = static_cast<uint8_t *>(base);
+        return segment;
+    }
+
+    bool Journal::roll(uint64_t first_index)
+    {
+        auto segment = map_file(options_.directory + "/" + segment_name(first_index), options_.segment_size,
+                                O_RDWR | O_CREAT | O_EXCL);
+        if (!segment)
+        {
+            return false;
+        }
+        segment->first_index = first_index;
+        segments_.push_back(std::move(segment));
+        directory_dirty_ = true;
+        return true;
+    }
+
+    bool Journal::sync()
+    {
+        bool ok = true;
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        for (const auto &segment : segments_)
+        {
+            if (segment->synced < segment->written)
+            {
+                size_t begin = segment->synced & ~(page - 1);
+                if (msync(segment->base + begin, segment->written - begin, MS_SYNC) == 0)
+                {
+                    segment->synced = segment->written;
+                }
+                else
+                {
+                    ok = false;
+                }
+            }
+        }
+        if (ack_dirty_)
+        {
+            ack_dirty_ = msync(ack_file_->base, ACK_FILE_SIZE, MS_SYNC) != 0;
+            ok = ok && !ack_dirty_;
+        }
+        if (directory_dirty_)
+        {
+            directory_dirty_ = fsync(directory_fd_) != 0;
+            ok = ok && !directory_dirty_;
+        }
+        if (ok)
+        {
+            durable_index_ = last_index_;
+        }
+        return ok;
+    }
+
+    void Journal::on_commit(uv_work_t *req)
+    {
+        auto commit = static_cast<Commit *>(req->data);
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        for (const auto &range : commit->ranges)
+        {
+            size_t begin = range.begin & ~(page - 1);
+            if (msync(range.segment->base + begin, range.end - begin, MS_SYNC) != 0)
+            {
+                commit->error = errno;
+            }
+        }
+        if (commit->directory_fd >= 0)
+        {
+            if (fsync(commit->directory_fd) != 0)
+            {
+                commit->error = errno;
+            }
+            ::close(commit->directory_fd);
+        }
+    }
+    void Journal::recover(const std::shared_ptr<Segment> &segment)
+    {
+        uint64_t index = segment->first_index;
+        size_t offset = 0;
+        while (offset + JOURNAL_RECORD_HEADER <= segment->size)
+        {
+            uint32_t header[2];
+            std::memcpy(header, segment->base + offset, sizeof(header));
+            if (header[0] == 0)
+            {
+                break;
+            }
+
+            // 长度、校验和、序列号和消息长度都一致的记录才是完整的
+            const uint8_t *frame = segment->base + offset + JOURNAL_RECORD_HEADER;
+            size_t frame_size = header[0];
+            bool valid = frame_size >= sizeof(PacketHeader) &&
+                         frame_size <= segment->size - offset - JOURNAL_RECORD_HEADER &&
+                         checksum(frame, frame_size) == header[1];
+            if (valid)
+            {
+                PacketHeader packet_header;
+                std::memcpy(&packet_header, frame, sizeof(packet_header));
+                valid = packet_header.version == PROTOCOL_VERSION &&
+                        packet_header.sequence == static_cast<uint32_t>(index) &&
+                        sizeof(PacketHeader) + packet_header.length == frame_size;
+            }
+            if (!valid)
+            {
+                spdlog::warn("段文件 {} 在偏移 {} 处的记录不完整，丢弃之后的内容", segment->path, offset);
+                std::memset(segment->base + offset, 0, segment->size - offset);
+                msync(segment->base, segment->size, MS_SYNC);
+                break;
+            }
+
+            segment->last_index = index;
+            if (index > acked_index_)
+            {
+                pending_.push_back(Entry{index, frame, frame_size});
+                pending_bytes_ += frame_size;
+            }
+            index = next_index(index);
+            offset += JOURNAL_RECORD_HEADER + frame_size;
+        }
+
+        // 之后从 offset 继续追加；已有的记录可能还在页缓存中，由第一次提交写入磁盘
+        segment->written = offset;
+        segment->synced = 0;
+    }
+#else
+    std::unique_ptr<Journal> Journal::open(uv_loop_t *, const JournalOptions &)
+    {
+        spdlog::error("当前平台不支持日志");
+        return nullptr;
+    }
+
+    Journal::~Journal() = default;
+
+    std::shared_ptr<Journal::Segment> Journal::map_file(const std::string &, size_t, int) { return nullptr; }
+    bool Journal::roll(uint64_t) { return false; }
+    bool Journal::sync() { return false; }
+    void Journal::recover(const std::shared_ptr<Segment> &) {}
+    void Journal::on_commit(uv_work_t *) {}
+#endif
+
+    uint32_t Journal::append(PacketType type, const uint8_t *data, size_t size)
+    {
+        size_t frame_size = sizeof(PacketHeader) + size;
+        size_t record_size = JOURNAL_RECORD_HEADER + frame_size;
+        if (record_size > options_.segment_size)
+        {
+            spdlog::error("消息长度 {} 超过日志段文件的大小 {}", size, options_.segment_size);
+            return 0;
+        }
+
+        uint64_t index = next_index(last_index_);
+        if (segments_.empty() || segments_.back()->written + record_size > segments_.back()->size)
+        {
+            if (!roll(index))
+            {
+                return 0;
+            }
+        }
+        Segment &segment = *segments_.back();
+
+        // 先写帧再写记录头，进程在中途崩溃时长度仍为 0，恢复时视为日志的末尾
+        uint8_t *record = segment.base + segment.written;
+        uint8_t *frame = record + JOURNAL_RECORD_HEADER;
+        write_packet_header(frame, type, static_cast<uint32_t>(size), static_cast<uint32_t>(index), PACKET_FLAG_DURABLE);
+        if (size > 0)
+        {
+            std::memcpy(frame + sizeof(PacketHeader), data, size);
+        }
+        uint32_t header[2] = {static_cast<uint32_t>(frame_size), checksum(frame, frame_size)};
+        std::memcpy(record, header, sizeof(header));
+
+        segment.written += record_size;
+        segment.last_index = index;
+        last_index_ = index;
+        pending_.push_back(Entry{index, frame, frame_size});
+        pending_bytes_ += frame_size;
+        schedule_commit();
+        return static_cast<uint32_t>(index);
+    }
+
+    void Journal::acknowledge(uint32_t sequence)
+    {
+        uint64_t acked = acked_index_;
+        while (!pending_.empty() &&
+               static_cast<int32_t>(static_cast<uint32_t>(pending_.front().index) - sequence) <= 0)
+        {
+            acked = pending_.front().index;
+            pending_bytes_ -= pending_.front().size;
+            pending_.pop_front();
+        }
+        if (acked == acked_index_)
+        {
+            return;
+        }
+
+        acked_index_ = acked;
+        reinterpret_cast<uint64_t *>(ack_file_->base)[1] = acked;
+        ack_dirty_ = true;
+        release_segments();
+        schedule_commit();
+    }
+
+    void Journal::release_segments()
+    {
+        // 映射区由进行中的提交持有，删除文件后仍然有效
+        while (segments_.size() > 1 && segments_.front()->last_index <= acked_index_)
+        {
+#ifndef _WIN32
+            unlink(segments_.front()->path.c_str());
+#endif
+            segments_.pop_front();
+        }
+    }
+
+    bool Journal::dirty() const
+    {
+        return ack_dirty_ || directory_dirty_ ||
+               std::any_of(segments_.begin(), segments_.end(), [](const std::shared_ptr<Segment> &segment)
+                           { return segment->synced < segment->written; });
+    }
+
+    void Journal::schedule_commit()
+    {
+        if (commit_ || !dirty())
+        {
+            return;
+        }
+
+        auto commit = new Commit();
+        commit->req.data = commit;
+        commit->journal = this;
+        commit->index = last_index_;
+        for (const auto &segment : segments_)
+        {
+            if (segment->synced < segment->written)
+            {
+                commit->ranges.push_back(Commit::Range{segment, segment->synced, segment->written});
+            }
+        }
+        if (ack_dirty_)
+        {
+            commit->ranges.push_back(Commit::Range{ack_file_, 0, 2 * sizeof(uint64_t)});
+            commit->ack = true;
+        }
+#ifndef _WIN32
+        if (directory_dirty_)
+        {
+            commit->directory_fd = dup(directory_fd_);
+        }
+#endif
+
+        int result = uv_queue_work(loop_, &commit->req, on_commit, on_commit_done);
+        if (result)
+        {
+            spdlog::error("提交日志失败: {}", uv_strerror(result));
+#ifndef _WIN32
+            if (commit->directory_fd >= 0)
+            {
+                ::close(commit->directory_fd);
+            }
+#endif
+            delete commit;
+            return;
+        }
+        ack_dirty_ = false;
+        directory_dirty_ = false;
+        commit_ = commit;
+    }
+
+    void Journal::on_commit_done(uv_work_t *req, int)
+    {
+        std::unique_ptr<Commit> commit(static_cast<Commit *>(req->data));
+        Journal *journal = commit->journal;
+        if (!journal)
+        {
+            return;
+        }
+        journal->commit_ = nullptr;
+
+        if (commit->error)
+        {
+            // 留待下一次追加或确认时重试
+            spdlog::error("日志写入磁盘失败: {}", std::strerror(commit->error));
+            journal->ack_dirty_ = journal->ack_dirty_ || commit->ack;
+            journal->directory_dirty_ = journal->directory_dirty_ || commit->directory_fd >= 0;
+            return;
+        }
+
+        for (const auto &range : commit->ranges)
+        {
+            range.segment->synced = std::max(range.segment->synced, range.end);
+        }
+        journal->durable_index_ = std::max(journal->durable_index_, commit->index);
+        if (journal->durable_handler_)
+        {
+            journal->durable_handler_(static_cast<uint32_t>(commit->index));
+        }
+
+        // 提交期间追加的记录合并为下一次提交
+        journal->schedule_commit();
+    }
+
+} // namespace libuv_net
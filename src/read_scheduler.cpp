@@ -0,0 +1,66 @@
+#include "libuv_net/read_scheduler.hpp"
+#include "libuv_net/session.hpp"
+
+namespace libuv_net
+{
+
+    ReadScheduler::ReadScheduler(uv_loop_t *loop) : idle_(new uv_idle_t)
+    {
+        uv_idle_init(loop, idle_);
+        idle_->data = this;
+    }
+
+    ReadScheduler::~ReadScheduler()
+    {
+        close();
+    }
+
+    void ReadScheduler::defer(std::weak_ptr<Session> session)
+    {
+        if (!idle_)
+        {
+            return;
+        }
+
+        if (queue_.empty())
+        {
+            uv_idle_start(idle_, on_idle);
+        }
+        queue_.push_back(std::move(session));
+    }
+
+    void ReadScheduler::close()
+    {
+        if (!idle_)
+        {
+            return;
+        }
+
+        uv_close(reinterpret_cast<uv_handle_t *>(idle_), [](uv_handle_t *handle)
+                 { delete reinterpret_cast<uv_idle_t *>(handle); });
+        idle_ = nullptr;
+        queue_.clear();
+    }
+
+    void ReadScheduler::on_idle(uv_idle_t *handle)
+    {
+        auto self = static_cast<ReadScheduler *>(handle->data);
+
+        // 本轮只处理此前排队的会话，处理中再次超出预算的会话排到下一轮
+        self->turn_.swap(self->queue_);
+        for (const auto &weak_session : self->turn_)
+        {
+            if (auto session = weak_session.lock())
+            {
+                session->resume_reading(Session::PAUSE_BUDGET);
+            }
+        }
+        self->turn_.clear();
+
+        if (self->queue_.empty() && self->idle_)
+        {
+            uv_idle_stop(self->idle_);
+        }
+    }
+
+} // namespace libuv_net
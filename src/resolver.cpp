@@ -0,0 +1,284 @@
+#include "libuv_net/resolver.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#endif
+
+namespace libuv_net
+{
+
+    // 进行中的 uv_getaddrinfo 请求，取消后 resolver 为空，完成回调中只释放请求
+    struct Resolver::Query
+    {
+        uv_getaddrinfo_t req;
+        Resolver *resolver;
+        std::string host;
+    };
+
+    namespace
+    {
+        void set_port(sockaddr_storage &addr, uint16_t port)
+        {
+            if (addr.ss_family == AF_INET6)
+            {
+                reinterpret_cast<sockaddr_in6 *>(&addr)->sin6_port = htons(port);
+            }
+            else
+            {
+                reinterpret_cast<sockaddr_in *>(&addr)->sin_port = htons(port);
+            }
+        }
+
+        bool same_address(const sockaddr_storage &a, const sockaddr_storage &b)
+        {
+            if (a.ss_family != b.ss_family)
+            {
+                return false;
+            }
+            if (a.ss_family == AF_INET6)
+            {
+                return std::memcmp(&reinterpret_cast<const sockaddr_in6 *>(&a)->sin6_addr,
+                                   &reinterpret_cast<const sockaddr_in6 *>(&b)->sin6_addr, sizeof(in6_addr)) == 0;
+            }
+            return reinterpret_cast<const sockaddr_in *>(&a)->sin_addr.s_addr ==
+                   reinterpret_cast<const sockaddr_in *>(&b)->sin_addr.s_addr;
+        }
+
+        // 取出 getaddrinfo 结果中的 IPv4 和 IPv6 地址，去掉重复项
+        std::vector<sockaddr_storage> collect_addresses(const addrinfo *res)
+        {
+            std::vector<sockaddr_storage> addresses;
+            for (const addrinfo *ai = res; ai; ai = ai->ai_next)
+            {
+                if (ai->ai_family != AF_INET && ai->ai_family != AF_INET6)
+                {
+                    continue;
+                }
+                sockaddr_storage addr{};
+                std::memcpy(&addr, ai->ai_addr, ai->ai_addrlen);
+                if (std::none_of(addresses.begin(), addresses.end(), [&addr](const sockaddr_storage &other)
+                                 { return same_address(addr, other); }))
+                {
+                    addresses.push_back(addr);
+                }
+            }
+            return addresses;
+        }
+
+        addrinfo stream_hints()
+        {
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            return hints;
+        }
+    }
+
+    int parse_ip_address(const std::string &host, int port, sockaddr_storage &addr)
+    {
+        std::memset(&addr, 0, sizeof(addr));
+        if (uv_ip4_addr(host.c_str(), port, reinterpret_cast<sockaddr_in *>(&addr)) == 0)
+        {
+            return 0;
+        }
+
+        // IPv6 地址可以带方括号
+        std::string ip = host;
+        if (ip.size() > 2 && ip.front() == '[' && ip.back() == ']')
+        {
+            ip = ip.substr(1, ip.size() - 2);
+        }
+        std::memset(&addr, 0, sizeof(addr));
+        return uv_ip6_addr(ip.c_str(), port, reinterpret_cast<sockaddr_in6 *>(&addr));
+    }
+
+    int resolve_address(uv_loop_t *loop, const std::string &host, int port, sockaddr_storage &addr)
+    {
+        if (parse_ip_address(host, port, addr) == 0)
+        {
+            return 0;
+        }
+
+        // 不传回调时 uv_getaddrinfo 同步执行
+        uv_getaddrinfo_t req;
+        addrinfo hints = stream_hints();
+        int result = uv_getaddrinfo(loop, &req, nullptr, host.c_str(), nullptr, &hints);
+        if (result)
+        {
+            return result;
+        }
+        auto addresses = collect_addresses(req.addrinfo);
+        uv_freeaddrinfo(req.addrinfo);
+        if (addresses.empty())
+        {
+            return UV_EAI_NONAME;
+        }
+        addr = addresses.front();
+        set_port(addr, static_cast<uint16_t>(port));
+        return 0;
+    }
+
+    std::vector<sockaddr_storage> interleave_addresses(const std::vector<sockaddr_storage> &addresses)
+    {
+        if (addresses.empty())
+        {
+            return {};
+        }
+
+        std::vector<sockaddr_storage> first, second;
+        sa_family_t first_family = addresses.front().ss_family;
+        for (const auto &addr : addresses)
+        {
+            (addr.ss_family == first_family ? first : second).push_back(addr);
+        }
+
+        std::vector<sockaddr_storage> ordered;
+        ordered.reserve(addresses.size());
+        for (size_t i = 0; i < std::max(first.size(), second.size()); ++i)
+        {
+            if (i < first.size())
+            {
+                ordered.push_back(first[i]);
+            }
+            if (i < second.size())
+            {
+                ordered.push_back(second[i]);
+            }
+        }
+        return ordered;
+    }
+
+    Resolver::Resolver(uv_loop_t *loop) : loop_(loop)
+    {
+    }
+
+    Resolver::~Resolver()
+    {
+        cancel();
+    }
+
+    void Resolver::resolve(const std::string &host, uint16_t port, Callback callback)
+    {
+        // 数字地址不需要查询
+        sockaddr_storage addr;
+        if (parse_ip_address(host, port, addr) == 0)
+        {
+            callback(0, {addr});
+            return;
+        }
+
+        auto cached = cache_.find(host);
+        if (cached != cache_.end())
+        {
+            if (std::chrono::steady_clock::now() < cached->second.expires)
+            {
+                auto addresses = cached->second.addresses;
+                for (auto &address : addresses)
+                {
+                    set_port(address, port);
+                }
+                callback(0, std::move(addresses));
+                return;
+            }
+            cache_.erase(cached);
+        }
+
+        // 同一主机名的查询进行中时只登记回调
+        auto &waiters = waiting_[host];
+        waiters.push_back(Waiter{port, std::move(callback)});
+        if (waiters.size() > 1)
+        {
+            return;
+        }
+
+        if (lookup_)
+        {
+            std::weak_ptr<Resolver *> token = token_;
+            lookup_(host, [token, host](int status, std::vector<sockaddr_storage> addresses)
+                    {
+                        if (auto self = token.lock())
+                        {
+                            (*self)->complete(host, status, std::move(addresses));
+                        } });
+            return;
+        }
+
+        auto query = new Query{uv_getaddrinfo_t{}, this, host};
+        addrinfo hints = stream_hints();
+        int result = uv_getaddrinfo(loop_, &query->req, on_getaddrinfo, host.c_str(), nullptr, &hints);
+        if (result)
+        {
+            delete query;
+            complete(host, result, {});
+            return;
+        }
+        queries_.push_back(query);
+    }
+
+    void Resolver::cancel()
+    {
+        for (Query *query : queries_)
+        {
+            uv_cancel(reinterpret_cast<uv_req_t *>(&query->req));
+            query->resolver = nullptr;
+        }
+        queries_.clear();
+        waiting_.clear();
+        token_ = std::make_shared<Resolver *>(this);
+    }
+
+    void Resolver::on_getaddrinfo(uv_getaddrinfo_t *req, int status, addrinfo *res)
+    {
+        std::unique_ptr<Query> query(reinterpret_cast<Query *>(req));
+        auto addresses = status == 0 ? collect_addresses(res) : std::vector<sockaddr_storage>();
+        uv_freeaddrinfo(res);
+
+        Resolver *self = query->resolver;
+        if (!self)
+        {
+            return;
+        }
+        self->queries_.erase(std::find(self->queries_.begin(), self->queries_.end(), query.get()));
+        self->complete(query->host, status, std::move(addresses));
+    }
+
+    void Resolver::complete(const std::string &host, int status, std::vector<sockaddr_storage> addresses)
+    {
+        if (status == 0 && addresses.empty())
+        {
+            status = UV_EAI_NONAME;
+        }
+        if (status == 0 && ttl_.count() > 0)
+        {
+            cache_[host] = CacheEntry{addresses, std::chrono::steady_clock::now() + ttl_};
+        }
+        if (status != 0)
+        {
+            spdlog::warn("解析 {} 失败: {}", host, uv_strerror(status));
+        }
+
+        auto it = waiting_.find(host);
+        if (it == waiting_.end())
+        {
+            return;
+        }
+        auto waiters = std::move(it->second);
+        waiting_.erase(it);
+        for (auto &waiter : waiters)
+        {
+            auto result = addresses;
+            for (auto &address : result)
+            {
+                set_port(address, waiter.port);
+            }
+            waiter.callback(status, std::move(result));
+        }
+    }
+
+} // namespace libuv_net
@@ -0,0 +1,72 @@
+#include "libuv_net/secure_random.hpp"
+#include <cerrno>
+#include <cstdint>
+#ifdef _WIN32
+#include <windows.h>
+#include <bcrypt.h>
+#elif defined(__linux__)
+#include <sys/random.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace libuv_net
+{
+
+#ifdef _WIN32
+    bool fill_secure_random(void *out, size_t size)
+    {
+        return BCRYPT_SUCCESS(BCryptGenRandom(nullptr, static_cast<PUCHAR>(out), static_cast<ULONG>(size),
+                                              BCRYPT_USE_SYSTEM_PREFERRED_RNG));
+    }
+#elif defined(__linux__)
+    bool fill_secure_random(void *out, size_t size)
+    {
+        auto bytes = static_cast<uint8_t *>(out);
+        while (size > 0)
+        {
+            ssize_t n = getrandom(bytes, size, 0);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            bytes += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+#else
+    bool fill_secure_random(void *out, size_t size)
+    {
+        int fd = ::open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return false;
+        }
+        auto bytes = static_cast<uint8_t *>(out);
+        while (size > 0)
+        {
+            ssize_t n = ::read(fd, bytes, size);
+            if (n <= 0)
+            {
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                ::close(fd);
+                return false;
+            }
+            bytes += n;
+            size -= static_cast<size_t>(n);
+        }
+        ::close(fd);
+        return true;
+    }
+#endif
+
+} // namespace libuv_net
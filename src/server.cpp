@@ -1,9 +1,10 @@
 #include "libuv_net/server.hpp"
 #include "libuv_net/session.hpp"
+#include "libuv_net/secure_random.hpp"
 #include <spdlog/spdlog.h>
 #include <cstring>
-#include <sstream>
-#include <iomanip>
+#include <charconv>
+#include <algorithm>
 #ifdef _WIN32
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -21,17 +22,66 @@ namespace libuv_net
         {
             throw std::runtime_error("创建事件循环失败");
         }
-        thread_pool_ = std::make_unique<ThreadPool>();
 
         // 初始化服务器套接字
         uv_tcp_init(loop_, &server_);
         server_.data = this;
+
+        // 初始化 Unix 域套接字服务器
+        uv_pipe_init(loop_, &pipe_server_, 0);
+        pipe_server_.data = this;
+
+        // 初始化唤醒定时器
+        uv_timer_init(loop_, &wakeup_timer_);
+
+        // 初始化心跳定时器
+        uv_timer_init(loop_, &heartbeat_timer_);
+        heartbeat_timer_.data = this;
+
+        // 初始化准入控制的采样定时器
+        uv_timer_init(loop_, &admission_timer_);
+        admission_timer_.data = this;
+
+        // 读取的轮转调度器
+        read_scheduler_ = std::make_unique<ReadScheduler>(loop_);
+
+        // 会话共享的配置，关闭时从会话表中移除
+        session_config_ = std::make_shared<SessionConfig>();
+        session_config_->read_scheduler = read_scheduler_.get();
+        session_config_->close_handler = [this](Session &session)
+        {
+            on_session_closed(session.shared_from_this());
+        };
     }
 
     Server::~Server()
     {
         stop_listening();
         stop();
+
+        // 关闭所有句柄并执行剩余的关闭回调，析构期间不再通知用户
+        close_handler_ = nullptr;
+        for (const auto &entry : sessions_)
+        {
+            entry.second->close();
+        }
+        uv_close(reinterpret_cast<uv_handle_t *>(&heartbeat_timer_), nullptr);
+        uv_close(reinterpret_cast<uv_handle_t *>(&admission_timer_), nullptr);
+        uv_close(reinterpret_cast<uv_handle_t *>(&wakeup_timer_), nullptr);
+        read_scheduler_->close();
+        if (datagram_)
+        {
+            datagram_->close();
+        }
+        if (!uv_is_closing(reinterpret_cast<uv_handle_t *>(&server_)))
+        {
+            uv_close(reinterpret_cast<uv_handle_t *>(&server_), nullptr);
+        }
+        if (!uv_is_closing(reinterpret_cast<uv_handle_t *>(&pipe_server_)))
+        {
+            uv_close(reinterpret_cast<uv_handle_t *>(&pipe_server_), nullptr);
+        }
+        uv_run(loop_, UV_RUN_DEFAULT);
         uv_loop_delete(loop_);
     }
 
@@ -43,14 +93,15 @@ namespace libuv_net
             return false;
         }
 
+        // 事件循环阻塞在 I/O 上，有数据到达时立即处理；唤醒定时器保证定期检查停止标志
         should_stop_ = false;
+        uv_timer_start(&wakeup_timer_, on_wakeup_timer, LOOP_WAKEUP_INTERVAL_MS, LOOP_WAKEUP_INTERVAL_MS);
         loop_thread_ = std::thread([this]()
                                    {
             spdlog::info("事件循环线程启动");
             while (!should_stop_)
             {
-                uv_run(loop_, UV_RUN_NOWAIT);
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                uv_run(loop_, UV_RUN_ONCE);
             }
             spdlog::info("事件循环线程退出"); });
 
@@ -66,43 +117,179 @@ namespace libuv_net
 
         should_stop_ = true;
         loop_thread_.join();
+        uv_timer_stop(&wakeup_timer_);
     }
 
-    void Server::listen(const std::string &host, int port)
+    bool Server::listen(const std::string &host, int port)
     {
         if (is_listening_)
         {
             spdlog::warn("服务器已经在监听");
-            return;
+            return false;
         }
 
         // 解析地址
-        struct sockaddr_in addr;
-        uv_ip4_addr(host.c_str(), port, &addr);
+        struct sockaddr_storage addr;
+        int result = resolve_address(loop_, host, port, addr);
+        if (result)
+        {
+            spdlog::error("解析地址 {} 失败: {}", host, uv_strerror(result));
+            return false;
+        }
 
         // 绑定地址
-        int result = uv_tcp_bind(&server_, reinterpret_cast<const struct sockaddr *>(&addr), 0);
+        result = uv_tcp_bind(&server_, reinterpret_cast<const struct sockaddr *>(&addr), 0);
         if (result)
         {
             spdlog::error("绑定地址失败: {}", uv_strerror(result));
-            return;
+            return false;
         }
 
+        // 收发缓冲区在 listen 之前设置，接受的连接继承监听套接字的缓冲区大小和窗口缩放
+        SocketOptions buffers;
+        buffers.send_buffer_size = session_config_->socket_options.send_buffer_size;
+        buffers.recv_buffer_size = session_config_->socket_options.recv_buffer_size;
+        apply_socket_options(&server_, buffers);
+
         // 开始监听
         result = uv_listen(reinterpret_cast<uv_stream_t *>(&server_), SOMAXCONN, on_connection);
         if (result)
         {
             spdlog::error("监听失败: {}", uv_strerror(result));
-            return;
+            return false;
         }
 
+        // 启动心跳定时器
+        uv_timer_start(&heartbeat_timer_, on_heartbeat_timer, HEARTBEAT_INTERVAL_MS, HEARTBEAT_INTERVAL_MS);
+
         is_listening_ = true;
         spdlog::info("服务器已启动，监听 {}:{}", host, port);
+        return true;
+    }
+
+    bool Server::listen_unix(const std::string &path)
+    {
+        if (!unix_path_.empty())
+        {
+            spdlog::warn("服务器已经在监听 Unix 域套接字 {}", unix_path_);
+            return false;
+        }
+
+        // 绑定地址，抽象命名空间的地址由 unix_socket 直接创建套接字
+        int result = is_abstract_socket_path(path) ? bind_abstract_socket(&pipe_server_, path)
+                                                   : uv_pipe_bind(&pipe_server_, path.c_str());
+        if (result)
+        {
+            spdlog::error("绑定 Unix 域套接字 {} 失败: {}", path, uv_strerror(result));
+            return false;
+        }
+
+        // 开始监听
+        result = uv_listen(reinterpret_cast<uv_stream_t *>(&pipe_server_), SOMAXCONN, on_connection);
+        if (result)
+        {
+            spdlog::error("监听失败: {}", uv_strerror(result));
+            return false;
+        }
+
+        // 启动心跳定时器
+        uv_timer_start(&heartbeat_timer_, on_heartbeat_timer, HEARTBEAT_INTERVAL_MS, HEARTBEAT_INTERVAL_MS);
+
+        unix_path_ = path;
+        spdlog::info("服务器已启动，监听 Unix 域套接字 {}", path);
+        return true;
+    }
+
+    bool Server::listen_udp(const std::string &host, int port)
+    {
+        if (datagram_)
+        {
+            spdlog::warn("服务器已经在监听 UDP 端口 {}", datagram_->local_port());
+            return false;
+        }
+
+        // 解析地址
+        struct sockaddr_storage addr;
+        int result = resolve_address(loop_, host, port, addr);
+        if (result)
+        {
+            spdlog::error("解析地址 {} 失败: {}", host, uv_strerror(result));
+            return false;
+        }
+
+        auto socket = std::make_unique<DatagramSocket>(loop_);
+        result = socket->bind(reinterpret_cast<const struct sockaddr *>(&addr));
+        if (!result)
+        {
+            result = socket->start([this](const sockaddr *from, uint64_t token, uint64_t counter, const uint8_t *data, size_t size)
+                                   { on_datagram(from, token, counter, data, size); });
+        }
+        if (result)
+        {
+            spdlog::error("监听 UDP 端口失败: {}", uv_strerror(result));
+            return false;
+        }
+        datagram_ = std::move(socket);
+
+        // 客户端经连接请求数据报通道
+        session_config_->set_packet_handler(PacketType::DATAGRAM_BIND, [this](Session &session, std::shared_ptr<Packet>)
+                                            { bind_datagram(session); });
+
+        spdlog::info("服务器已启动，监听 UDP {}:{}", host, datagram_->local_port());
+        return true;
+    }
+
+    void Server::bind_datagram(Session &session)
+    {
+        // 只有 TCP 会话可以关联数据报通道，每个会话只分配一次令牌和密钥
+        std::vector<uint8_t> payload;
+        if (session.transport() == Transport::TCP && session.datagram_token() == 0)
+        {
+            // 令牌和密钥都取自操作系统的密码学安全随机数，无法由之前分配的值推测
+            uint64_t token = 0;
+            DatagramKey key;
+            bool generated = fill_secure_random(key.data(), key.size());
+            while (generated && (token == 0 || datagram_sessions_.count(token)))
+            {
+                generated = fill_secure_random(&token, sizeof(token));
+            }
+            if (generated)
+            {
+                datagram_sessions_.emplace(token, session.id());
+                datagram_->add_token(token, key);
+                session.attach_datagram(datagram_.get(), token);
+                payload = encode_datagram_bind(token, static_cast<uint16_t>(datagram_->local_port()), key);
+            }
+            else
+            {
+                spdlog::error("生成数据报令牌失败，会话 {} 不使用数据报通道", session.id());
+            }
+        }
+        session.send(std::make_shared<Packet>(PacketType::DATAGRAM_BIND, std::move(payload)));
+    }
+
+    void Server::on_datagram(const sockaddr *addr, uint64_t token, uint64_t counter, const uint8_t *data, size_t size)
+    {
+        auto it = datagram_sessions_.find(token);
+        if (it == datagram_sessions_.end())
+        {
+            return;
+        }
+        auto session = find_session(it->second);
+        if (!session)
+        {
+            return;
+        }
+
+        // 数据报已通过认证；以发送计数最大的数据报的来源为对端地址，
+        // 客户端的地址变化（如 NAT 重新映射）后仍能送达，重放的旧数据报不能改变对端地址
+        session->set_datagram_peer(addr, counter);
+        session->receive_datagram(data, size);
     }
 
     void Server::stop_listening()
     {
-        if (!is_listening_)
+        if (!is_listening_ && unix_path_.empty())
         {
             return;
         }
@@ -111,30 +298,117 @@ namespace libuv_net
         {
             uv_close(reinterpret_cast<uv_handle_t *>(&server_), on_close);
         }
+        if (!uv_is_closing(reinterpret_cast<uv_handle_t *>(&pipe_server_)))
+        {
+            uv_close(reinterpret_cast<uv_handle_t *>(&pipe_server_), on_close);
+        }
+        uv_timer_stop(&heartbeat_timer_);
 
+#ifndef _WIN32
+        // 删除文件系统中的套接字文件
+        if (!unix_path_.empty() && !is_abstract_socket_path(unix_path_))
+        {
+            uv_fs_t req;
+            uv_fs_unlink(nullptr, &req, unix_path_.c_str(), nullptr);
+            uv_fs_req_cleanup(&req);
+        }
+#endif
+
+        // 未接受的连接随监听句柄一起关闭
+        pending_accepts_.clear();
+        admission_.set_accept_paused(false);
         is_listening_ = false;
+        unix_path_.clear();
         spdlog::info("服务器已停止监听");
     }
 
+    void Server::set_admission_control(const AdmissionLimits &limits)
+    {
+        admission_.configure(limits);
+        session_config_->admission = limits.enabled() ? &admission_ : nullptr;
+
+        uv_timer_stop(&admission_timer_);
+        last_admission_sample_ = 0;
+        if (limits.enabled())
+        {
+            uint64_t interval = static_cast<uint64_t>(std::max<int64_t>(1, limits.sample_interval.count()));
+            uv_timer_start(&admission_timer_, on_admission_timer, interval, interval);
+        }
+    }
+
     void Server::broadcast(std::shared_ptr<Packet> packet)
     {
-        for (const auto &session : sessions_)
+        // 只编码一次，所有会话共享同一个帧
+        const auto &data = packet->data();
+        auto frame = make_shared_frame(packet->type(), data.data(), data.size(), packet->sequence());
+        for (const auto &entry : sessions_)
+        {
+            entry.second->send_frame(frame);
+        }
+    }
+
+    bool Server::subscribe(const std::shared_ptr<Session> &session, const std::string &topic)
+    {
+        // 只接受仍在会话表中的会话，关闭时由 on_session_closed 清理
+        if (!session || session->is_closed() || !sessions_.count(session->id()))
+        {
+            return false;
+        }
+        return topics_.subscribe(session.get(), topic);
+    }
+
+    bool Server::unsubscribe(const std::shared_ptr<Session> &session, const std::string &topic)
+    {
+        return session && topics_.unsubscribe(session.get(), topic);
+    }
+
+    size_t Server::publish(const std::string &topic, std::shared_ptr<Packet> packet)
+    {
+        if (topics_.subscriber_count(topic) == 0)
         {
-            session->send(packet);
+            return 0;
         }
+
+        const auto &data = packet->data();
+        return publish_frame(topic, make_shared_frame(packet->type(), data.data(), data.size(), packet->sequence()));
+    }
+
+    size_t Server::publish_frame(const std::string &topic, const SharedFrame &frame)
+    {
+        size_t count = 0;
+        topics_.for_each_subscriber(topic, [&frame, &count](Session &session)
+                                    {
+            session.send_frame(frame);
+            ++count; });
+        return count;
+    }
+
+    bool Server::send_to(uint64_t session_id, std::shared_ptr<Packet> packet)
+    {
+        auto it = sessions_.find(session_id);
+        if (it == sessions_.end())
+        {
+            return false;
+        }
+        it->second->send(std::move(packet));
+        return true;
     }
 
-    void Server::send_to(const std::string &session_id, std::shared_ptr<Packet> packet)
+    bool Server::send_to(const std::string &session_id, std::shared_ptr<Packet> packet)
     {
-        auto it = std::find_if(sessions_.begin(), sessions_.end(),
-                               [&session_id](const auto &session)
-                               {
-                                   return session->id() == session_id;
-                               });
-        if (it != sessions_.end())
+        uint64_t id = 0;
+        auto result = std::from_chars(session_id.data(), session_id.data() + session_id.size(), id);
+        if (result.ec != std::errc() || result.ptr != session_id.data() + session_id.size())
         {
-            (*it)->send(packet);
+            return false;
         }
+        return send_to(id, std::move(packet));
+    }
+
+    std::shared_ptr<Session> Server::find_session(uint64_t session_id) const
+    {
+        auto it = sessions_.find(session_id);
+        return it == sessions_.end() ? nullptr : it->second;
     }
 
     void Server::on_connection(uv_stream_t *server, int status)
@@ -146,49 +420,103 @@ namespace libuv_net
             return;
         }
 
-        // 创建新的会话
-        auto session = std::make_shared<Session>(self->loop_, reinterpret_cast<uv_tcp_t *>(server));
-        self->sessions_.push_back(session);
+        if (self->session_config_->admission && !self->admission_.accepts(self->sessions_.size()))
+        {
+            self->refuse_connection(server);
+            return;
+        }
+
+        self->handle_new_session(server);
+    }
 
-        // 设置消息处理回调
-        session->set_packet_handler(PacketType::HEARTBEAT, [](std::shared_ptr<Packet> /*packet*/)
-                                    {
-                                        // 心跳包由 Session 类内部处理
-                                    });
-
-        // 设置默认消息处理回调
-        session->set_default_packet_handler([self, session](std::shared_ptr<Packet> packet)
-                                            {
-            // 查找对应的处理器
-            auto it = self->packet_handlers_.find(packet->type());
-            if (it != self->packet_handlers_.end())
+    void Server::refuse_connection(uv_stream_t *listener)
+    {
+        if (admission_.limits().action == OverloadAction::REJECT)
+        {
+            auto client = new uv_any_handle;
+            if (listener->type == UV_NAMED_PIPE)
             {
-                it->second(session, packet);
+                uv_pipe_init(loop_, &client->pipe, 0);
             }
-            else if (self->default_packet_handler_)
+            else
             {
-                self->default_packet_handler_(session, packet);
-            } });
+                uv_tcp_init(loop_, &client->tcp);
+            }
+            if (uv_accept(listener, reinterpret_cast<uv_stream_t *>(client)) == 0)
+            {
+                admission_.record_rejected();
+            }
+            uv_close(reinterpret_cast<uv_handle_t *>(client), [](uv_handle_t *handle)
+                     { delete reinterpret_cast<uv_any_handle *>(handle); });
+            return;
+        }
 
-        // 设置关闭处理回调
-        session->set_close_handler([self, session]()
-                                   {
-            self->sessions_.erase(
-                std::remove(self->sessions_.begin(), self->sessions_.end(), session),
-                self->sessions_.end()
-            );
-            if (self->close_handler_) {
-                self->close_handler_(session);
-            } });
+        // 不调用 uv_accept 时 libuv 停止监听套接字的可读事件，之后的连接留在内核的监听队列中
+        pending_accepts_.push_back(listener);
+        admission_.set_accept_paused(true);
+    }
 
-        // 启动会话
-        session->start();
+    void Server::resume_accepting()
+    {
+        if (pending_accepts_.empty() || !admission_.accepts(sessions_.size()))
+        {
+            return;
+        }
 
-        // 调用连接处理回调
-        if (self->connect_handler_)
+        // uv_accept 之后 libuv 恢复监听
+        std::vector<uv_stream_t *> listeners;
+        listeners.swap(pending_accepts_);
+        admission_.set_accept_paused(false);
+        for (uv_stream_t *listener : listeners)
+        {
+            handle_new_session(listener);
+        }
+    }
+
+    void Server::on_admission_timer(uv_timer_t *handle)
+    {
+        auto self = static_cast<Server *>(handle->data);
+        const auto &limits = self->admission_.limits();
+
+        // 事件循环延迟：定时器实际触发的间隔超出设定间隔的部分
+        uint64_t now = uv_hrtime();
+        uint64_t interval = uv_timer_get_repeat(handle) * 1000000;
+        std::chrono::microseconds lag{0};
+        if (self->last_admission_sample_ != 0 && now - self->last_admission_sample_ > interval)
+        {
+            lag = std::chrono::microseconds((now - self->last_admission_sample_ - interval) / 1000);
+        }
+        self->last_admission_sample_ = now;
+
+        size_t buffered = 0;
+        if (limits.max_buffered_bytes > 0)
+        {
+            for (const auto &entry : self->sessions_)
+            {
+                buffered += entry.second->buffered_bytes();
+            }
+        }
+
+        bool was_overloaded = self->admission_.overloaded();
+        bool overloaded = self->admission_.update(lag, buffered);
+        if (overloaded != was_overloaded)
         {
-            self->connect_handler_(session);
+            if (overloaded)
+            {
+                spdlog::warn("服务器过载，事件循环延迟 {} us，缓冲 {} 字节", lag.count(), buffered);
+            }
+            else
+            {
+                spdlog::info("服务器恢复，事件循环延迟 {} us，缓冲 {} 字节", lag.count(), buffered);
+            }
         }
+
+        self->resume_accepting();
+    }
+
+    void Server::on_wakeup_timer(uv_timer_t * /*handle*/)
+    {
+        // 只用于让 uv_run 返回，由事件循环线程检查停止标志
     }
 
     void Server::on_close(uv_handle_t * /*handle*/)
@@ -197,35 +525,26 @@ namespace libuv_net
         // 如果需要通知服务器关闭，可以添加一个新的回调类型
     }
 
-    void Server::handle_new_session(uv_tcp_t *client)
+    void Server::on_heartbeat_timer(uv_timer_t *handle)
     {
-        // 创建新的会话
-        auto session = std::make_shared<Session>(loop_, client);
-        sessions_.push_back(session);
+        auto self = static_cast<Server *>(handle->data);
 
-        // 设置消息处理回调
-        session->set_packet_handler(PacketType::HEARTBEAT, [](std::shared_ptr<Packet> /*packet*/)
-                                    {
-                                        // 心跳包由 Session 类内部处理
-                                    });
-
-        // 设置默认消息处理回调
-        session->set_default_packet_handler([this, session](std::shared_ptr<Packet> packet)
-                                            {
-            // 查找对应的处理器
-            auto it = packet_handlers_.find(packet->type());
-            if (it != packet_handlers_.end())
-            {
-                it->second(session, packet);
-            }
-            else if (default_packet_handler_)
-            {
-                default_packet_handler_(session, packet);
-            } });
+        // 一个定时器检查所有会话，超时的会话关闭后在关闭回调中移除
+        auto now = std::chrono::steady_clock::now();
+        for (const auto &entry : self->sessions_)
+        {
+            entry.second->check_heartbeat(now);
+        }
+    }
 
-        // 设置关闭处理回调
-        session->set_close_handler([this, session]()
-                                   { on_session_closed(session); });
+    void Server::handle_new_session(uv_stream_t *listener)
+    {
+        // 从对象池创建新的会话，处理器表等配置由所有会话共享
+        auto session = listener->type == UV_NAMED_PIPE
+                           ? session_pool_.create(loop_, reinterpret_cast<uv_pipe_t *>(listener), session_config_)
+                           : session_pool_.create(loop_, reinterpret_cast<uv_tcp_t *>(listener), session_config_);
+        sessions_.emplace(session->id(), session);
+        session->apply_socket_options();
 
         // 启动会话
         session->start();
@@ -239,16 +558,26 @@ namespace libuv_net
 
     void Server::on_session_closed(std::shared_ptr<Session> session)
     {
-        // 从会话列表中移除
-        sessions_.erase(
-            std::remove(sessions_.begin(), sessions_.end(), session),
-            sessions_.end());
+        // 从会话列表和订阅索引中移除
+        sessions_.erase(session->id());
+        topics_.remove(session.get());
+        if (uint64_t token = session->datagram_token())
+        {
+            datagram_sessions_.erase(token);
+            if (datagram_)
+            {
+                datagram_->remove_token(token);
+            }
+        }
 
         // 调用关闭处理回调
         if (close_handler_)
         {
             close_handler_(session);
         }
+
+        // 会话数回落到上限以下时接受等待中的连接
+        resume_accepting();
     }
 
     void Server::on_read(std::shared_ptr<Session> session, ssize_t nread, const uv_buf_t *buf)
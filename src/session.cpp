@@ -1,8 +1,10 @@
 #include "libuv_net/session.hpp"
+#include "libuv_net/read_scheduler.hpp"
+#include "libuv_net/unix_socket.hpp"
 #include <spdlog/spdlog.h>
 #include <cstring>
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
+#include <deque>
 #ifdef _WIN32
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -13,44 +15,140 @@
 namespace libuv_net
 {
 
-    Session::Session(uv_loop_t *loop) : loop_(loop)
+    // 写请求，持有待写出的数据直到写入完成
+    struct Session::WriteRequest
     {
-        // 初始化套接字
-        uv_tcp_init(loop_, &socket_);
-        socket_.data = this;
+        uv_write_t req;
+        Session *session;
+        std::vector<uint8_t> data;
+        SharedFrame shared;              // 共享的消息帧，非空时写出它而不是 data
+        bool stream_chunk;
+        std::shared_ptr<FramePool> pool; // data 所属的池，写入完成后归还
+    };
+
+    // 排队中的待发送项：普通消息帧或流
+    struct Session::OutboundItem
+    {
+        std::vector<uint8_t> frame;      // 已序列化的消息帧（普通消息）或分块缓冲区（流）
+        SharedFrame shared;              // 共享的消息帧
+        std::shared_ptr<FramePool> pool; // frame 所属的池
+        PacketHeader header{};           // 流的消息头
+        uint32_t remaining{0};           // 流剩余待发送的字节数
+        bool header_sent{false};         // 流的消息头是否已发送
+        ChunkSource source;              // 流的数据源，为空表示普通消息
+    };
+
+    // 会话的限流状态
+    struct Session::RateState
+    {
+        RateBuckets session;              // 每个会话的令牌桶
+        DispatchTable<RateBuckets> types; // 按消息类型的令牌桶
+        uv_timer_t *timer = nullptr;      // 恢复读取的定时器，关闭时由关闭回调释放
+    };
+
+    // 会话的共享内存传输状态
+    struct Session::ShmState
+    {
+        std::unique_ptr<ShmChannel> channel;
+        bool active = false;   // 已改用共享内存收发
+        bool switched = false; // 刚在本次解析中切换，流中剩余的数据都是通知
+        bool polling = false;  // 轮询模式，不等待通知
+        bool flushing = false; // 正在写入环形缓冲区，防止完成回调中重入
+        std::deque<std::unique_ptr<WriteRequest>> pending; // 等待写入环形缓冲区的请求（协商中或缓冲区已满）
+        size_t pending_offset = 0;                          // 第一个请求已写入的字节数
+        uv_idle_t *idle = nullptr;                          // 轮询模式的 idle 句柄，关闭时由关闭回调释放
+    };
+
+    // 会话的数据报通道状态
+    struct Session::DatagramState
+    {
+        DatagramSocket *socket = nullptr;  // 服务器或客户端持有的数据报套接字
+        uint64_t token = 0;                // 连接令牌
+        sockaddr_storage peer{};           // 对端地址
+        bool has_peer = false;             // 是否已知对端地址
+        uint64_t peer_counter = 0;         // 对端地址所在数据报的发送计数
+        DispatchTable<uint32_t> sent;      // 每个类型最后发送的序列号
+        DispatchTable<uint32_t> received;  // 每个类型最后收到的序列号
+    };
+
+    namespace
+    {
+        // 下一个会话ID
+        std::atomic<uint64_t> next_session_id{1};
+
+        // 读取缓冲区大小
+        constexpr size_t READ_BUFFER_SIZE = 64 * 1024;
 
-        // 生成会话ID
-        std::stringstream ss;
-        ss << std::hex << std::setw(8) << std::setfill('0')
-           << reinterpret_cast<uintptr_t>(this);
-        id_ = ss.str();
+        // 共享内存协商消息的操作：1 字节操作 + 4 字节环形缓冲区大小（小端）+ 共享内存段名称
+        enum ShmOp : uint8_t
+        {
+            SHM_OFFER = 0,  // 发起方提议
+            SHM_ACCEPT = 1, // 接受方同意，之后双方都使用共享内存
+            SHM_REJECT = 2  // 接受方拒绝，继续使用套接字
+        };
+        constexpr size_t SHM_HANDSHAKE_HEADER = 5;
 
-        // 初始化心跳定时器
-        uv_timer_init(loop_, &heartbeat_timer_);
-        heartbeat_timer_.data = this;
+        // 每个事件循环线程一个读取缓冲区，读取回调中同步处理完毕，空闲会话不占用读取缓冲区
+        char *thread_read_buffer()
+        {
+            thread_local std::unique_ptr<char[]> buffer(new char[READ_BUFFER_SIZE]);
+            return buffer.get();
+        }
     }
 
-    Session::Session(uv_loop_t *loop, uv_tcp_t *client)
-        : loop_(loop)
+    Session::Session(uv_loop_t *loop, std::shared_ptr<SessionConfig> config)
+        : Session(loop, Transport::TCP, std::move(config))
+    {
+    }
+
+    Session::Session(uv_loop_t *loop, Transport transport, std::shared_ptr<SessionConfig> config)
+        : loop_(loop), transport_(transport), id_(next_session_id.fetch_add(1, std::memory_order_relaxed)),
+          config_(config ? std::move(config) : std::make_shared<SessionConfig>())
     {
         // 初始化套接字
-        uv_tcp_init(loop_, &socket_);
-        socket_.data = this;
+        if (transport_ == Transport::PIPE)
+        {
+            uv_pipe_init(loop_, &socket_.pipe, 0);
+            socket_.pipe.data = this;
+        }
+        else
+        {
+            uv_tcp_init(loop_, &socket_.tcp);
+            socket_.tcp.data = this;
+        }
+    }
 
-        // 生成会话ID
-        std::stringstream ss;
-        ss << std::hex << std::setw(8) << std::setfill('0')
-           << reinterpret_cast<uintptr_t>(this);
-        id_ = ss.str();
+    Session::Session(uv_loop_t *loop, uv_pipe_t *client, std::shared_ptr<SessionConfig> config)
+        : Session(loop, Transport::PIPE, std::move(config))
+    {
+        // 接受客户端连接
+        uv_accept(reinterpret_cast<uv_stream_t *>(client), get_stream());
+
+        // 对端通常是未命名的套接字，以监听的路径作为远程地址，抽象命名空间的地址以 @ 开头
+        char path[256];
+        size_t path_len = sizeof(path);
+        if (uv_pipe_getsockname(client, path, &path_len) == 0)
+        {
+            remote_address_.assign(path, path_len);
+            if (!remote_address_.empty() && remote_address_[0] == '\0')
+            {
+                remote_address_[0] = '@';
+            }
+        }
 
+        spdlog::info("新会话已创建: {} ({})", id_, remote_address_);
+    }
+
+    Session::Session(uv_loop_t *loop, uv_tcp_t *client, std::shared_ptr<SessionConfig> config)
+        : Session(loop, Transport::TCP, std::move(config))
+    {
         // 接受客户端连接
-        uv_accept(reinterpret_cast<uv_stream_t *>(client),
-                  reinterpret_cast<uv_stream_t *>(&socket_));
+        uv_accept(reinterpret_cast<uv_stream_t *>(client), get_stream());
 
         // 获取远程地址信息
         struct sockaddr_storage addr;
         int addr_len = sizeof(addr);
-        uv_tcp_getpeername(&socket_, reinterpret_cast<struct sockaddr *>(&addr), &addr_len);
+        uv_tcp_getpeername(&socket_.tcp, reinterpret_cast<struct sockaddr *>(&addr), &addr_len);
 
         char ip[INET6_ADDRSTRLEN];
         if (addr.ss_family == AF_INET)
@@ -67,10 +165,6 @@ namespace libuv_net
         }
         remote_address_ = ip;
 
-        // 初始化心跳定时器
-        uv_timer_init(loop_, &heartbeat_timer_);
-        heartbeat_timer_.data = this;
-
         spdlog::info("新会话已创建: {} ({}:{})", id_, remote_address_, remote_port_);
     }
 
@@ -80,7 +174,15 @@ namespace libuv_net
         {
             close();
         }
-        stop_heartbeat();
+    }
+
+    SessionConfig &Session::mutable_config()
+    {
+        if (config_.use_count() > 1)
+        {
+            config_ = std::make_shared<SessionConfig>(*config_);
+        }
+        return *config_;
     }
 
     int Session::start_read()
@@ -90,20 +192,28 @@ namespace libuv_net
             return UV_EBUSY;
         }
 
+        // 仍因其他原因暂停时只清除 stop() 的暂停原因
+        read_pause_ &= ~PAUSE_STOPPED;
+        if (read_pause_ || is_reading_)
+        {
+            return 0;
+        }
+
         int result = uv_read_start(reinterpret_cast<uv_stream_t *>(&socket_),
                                    on_alloc,
                                    on_read);
         if (result)
         {
             spdlog::error("开始读取失败: {}", uv_strerror(result));
+            return result;
         }
-        return result;
+        is_reading_ = true;
+        return 0;
     }
 
     void Session::stop()
     {
-        uv_read_stop(reinterpret_cast<uv_stream_t *>(&socket_));
-        stop_heartbeat();
+        pause_reading(PAUSE_STOPPED);
     }
 
     void Session::close()
@@ -111,10 +221,133 @@ namespace libuv_net
         if (!is_closing_ && !uv_is_closing(reinterpret_cast<uv_handle_t *>(&socket_)))
         {
             is_closing_ = true;
+            if (rate_state_ && rate_state_->timer)
+            {
+                uv_close(reinterpret_cast<uv_handle_t *>(rate_state_->timer), [](uv_handle_t *handle)
+                         { delete reinterpret_cast<uv_timer_t *>(handle); });
+                rate_state_->timer = nullptr;
+            }
+            if (shm_ && shm_->idle)
+            {
+                uv_close(reinterpret_cast<uv_handle_t *>(shm_->idle), [](uv_handle_t *handle)
+                         { delete reinterpret_cast<uv_idle_t *>(handle); });
+                shm_->idle = nullptr;
+            }
             uv_close(reinterpret_cast<uv_handle_t *>(&socket_), on_close);
         }
     }
 
+    void Session::pause_reading(uint8_t reason)
+    {
+        read_pause_ |= reason;
+        if (is_reading_)
+        {
+            uv_read_stop(reinterpret_cast<uv_stream_t *>(&socket_));
+            is_reading_ = false;
+        }
+    }
+
+    void Session::resume_reading(uint8_t reason)
+    {
+        read_pause_ &= ~reason;
+        if (read_pause_ || is_closing_)
+        {
+            return;
+        }
+
+        // 先处理暂停期间留在暂存区和环形缓冲区中的数据，处理中可能再次暂停
+        process_pending();
+        drain_shm();
+        if (read_pause_ || is_closing_ || is_reading_)
+        {
+            return;
+        }
+
+        if (uv_read_start(reinterpret_cast<uv_stream_t *>(&socket_), on_alloc, on_read) == 0)
+        {
+            is_reading_ = true;
+        }
+    }
+
+    bool Session::admit(PacketType type, size_t packets, size_t bytes, bool pause)
+    {
+        const SessionConfig &config = *config_;
+        auto global_buckets = config.load_global_rate_limit();
+        if (!config.session_rate_limited() && !global_buckets)
+        {
+            return true;
+        }
+
+        auto now = RateBuckets::Clock::now();
+        if (!rate_state_)
+        {
+            rate_state_ = std::make_unique<RateState>();
+            rate_state_->session = RateBuckets(config.rate_limit, now);
+        }
+
+        // 按消息类型的令牌桶在该类型首次出现时创建
+        RateBuckets *type_buckets = nullptr;
+        if (auto limit = config.type_rate_limits.find(type))
+        {
+            type_buckets = rate_state_->types.find(type);
+            if (!type_buckets)
+            {
+                rate_state_->types.set(type, RateBuckets(*limit, now));
+                type_buckets = rate_state_->types.find(type);
+            }
+        }
+        RateBuckets *global = global_buckets.get();
+
+        bool available = rate_state_->session.available(now);
+        available = (!type_buckets || type_buckets->available(now)) && available;
+        available = (!global || global->available(now)) && available;
+        if (available)
+        {
+            rate_state_->session.consume(static_cast<double>(packets), static_cast<double>(bytes));
+            if (type_buckets)
+            {
+                type_buckets->consume(static_cast<double>(packets), static_cast<double>(bytes));
+            }
+            if (global)
+            {
+                global->consume(static_cast<double>(packets), static_cast<double>(bytes));
+            }
+            return true;
+        }
+        if (!pause)
+        {
+            return false;
+        }
+
+        // 超出限额：暂停读取，等令牌补足后恢复
+        auto wait = rate_state_->session.wait_time();
+        if (type_buckets)
+        {
+            wait = std::max(wait, type_buckets->wait_time());
+        }
+        if (global)
+        {
+            wait = std::max(wait, global->wait_time());
+        }
+
+        pause_reading(PAUSE_RATE_LIMIT);
+        if (!rate_state_->timer)
+        {
+            rate_state_->timer = new uv_timer_t;
+            uv_timer_init(loop_, rate_state_->timer);
+            rate_state_->timer->data = this;
+        }
+        auto wait_ms = std::chrono::duration_cast<std::chrono::milliseconds>(wait).count();
+        uv_timer_start(rate_state_->timer, on_rate_timer, static_cast<uint64_t>(std::max<int64_t>(wait_ms, 1)), 0);
+        return false;
+    }
+
+    void Session::on_rate_timer(uv_timer_t *handle)
+    {
+        auto session = static_cast<Session *>(handle->data);
+        session->resume_reading(PAUSE_RATE_LIMIT);
+    }
+
     void Session::send(std::shared_ptr<Packet> packet)
     {
         if (is_closing_)
@@ -122,35 +355,214 @@ namespace libuv_net
             return;
         }
 
-        // 序列化消息
-        auto data = packet->serialize();
-        auto write_req = new uv_write_t;
-        write_req->data = this;
+        // 拷贝到帧缓冲区
+        const auto &data = packet->data();
+        send_frame(packet->type(), data.size(), [&data](uint8_t *out, size_t size)
+                   {
+                       if (size > 0)
+                       {
+                           std::memcpy(out, data.data(), size);
+                       }
+                       return true; }, packet->sequence());
+    }
+
+    bool Session::send_stream(PacketType type, uint32_t length, ChunkSource source, uint32_t sequence)
+    {
+        if (is_closing_ || !source)
+        {
+            return false;
+        }
+
+        auto stream = std::make_unique<OutboundItem>();
+        stream->header = PacketHeader{PROTOCOL_VERSION, type, 0, 0, length, sequence};
+        stream->remaining = length;
+        stream->source = std::move(source);
+
+        // 已有流在发送时排队，保证帧不交错
+        if (outbound_stream_ || !outbound_queue_.empty())
+        {
+            outbound_queue_.push_back(std::move(stream));
+            return true;
+        }
+
+        start_stream(std::move(stream));
+        return true;
+    }
+
+    void Session::write_frame(std::vector<uint8_t> frame, std::shared_ptr<FramePool> pool)
+    {
+        // 流发送期间排队，保证帧不交错
+        if (outbound_stream_ || !outbound_queue_.empty())
+        {
+            auto item = std::make_unique<OutboundItem>();
+            item->frame = std::move(frame);
+            item->pool = std::move(pool);
+            outbound_queue_.push_back(std::move(item));
+            return;
+        }
+
+        submit_write(std::move(frame), false, std::move(pool));
+    }
+
+    void Session::send_frame(SharedFrame frame)
+    {
+        if (is_closing_ || !frame)
+        {
+            return;
+        }
+
+        // 流发送期间排队，保证帧不交错
+        if (outbound_stream_ || !outbound_queue_.empty())
+        {
+            auto item = std::make_unique<OutboundItem>();
+            item->shared = std::move(frame);
+            outbound_queue_.push_back(std::move(item));
+            return;
+        }
+
+        submit_write(std::move(frame));
+    }
+
+    bool Session::submit_write(std::vector<uint8_t> data, bool stream_chunk, std::shared_ptr<FramePool> pool)
+    {
+        auto request = new WriteRequest{uv_write_t{}, this, std::move(data), nullptr, stream_chunk, std::move(pool)};
+        return submit_request(request, request->data);
+    }
+
+    bool Session::submit_write(SharedFrame frame)
+    {
+        auto request = new WriteRequest{uv_write_t{}, this, {}, std::move(frame), false, nullptr};
+        return submit_request(request, *request->shared);
+    }
+
+    bool Session::submit_request(WriteRequest *request, const std::vector<uint8_t> &data)
+    {
+        request->req.data = request;
+
+        // 协商期间暂存，改用共享内存后写入环形缓冲区
+        if (shm_)
+        {
+            shm_->pending.emplace_back(request);
+            flush_shm();
+            return true;
+        }
 
         // 创建缓冲区
-        uv_buf_t buf = uv_buf_init(reinterpret_cast<char *>(data.data()), data.size());
+        uv_buf_t buf = uv_buf_init(reinterpret_cast<char *>(const_cast<uint8_t *>(data.data())),
+                                   static_cast<unsigned int>(data.size()));
 
         // 发送数据
-        int result = uv_write(write_req,
+        int result = uv_write(&request->req,
                               reinterpret_cast<uv_stream_t *>(&socket_),
                               &buf, 1, on_write);
         if (result)
         {
             spdlog::error("发送失败: {}", uv_strerror(result));
-            delete write_req;
+            delete request;
+            return false;
+        }
+        return true;
+    }
+
+    void Session::start_stream(std::unique_ptr<OutboundItem> stream)
+    {
+        outbound_stream_ = std::move(stream);
+        outbound_stream_->frame.reserve(sizeof(PacketHeader) + config_->stream_window_size);
+        pump_stream();
+    }
+
+    void Session::pump_stream()
+    {
+        auto &stream = *outbound_stream_;
+        std::vector<uint8_t> chunk = std::move(stream.frame);
+        chunk.clear();
+
+        // 第一块携带消息头
+        if (!stream.header_sent)
+        {
+            chunk.insert(chunk.end(),
+                         reinterpret_cast<const uint8_t *>(&stream.header),
+                         reinterpret_cast<const uint8_t *>(&stream.header) + sizeof(PacketHeader));
+            stream.header_sent = true;
+        }
+
+        // 从数据源拉取至多一个窗口的数据
+        size_t offset = chunk.size();
+        size_t wanted = std::min<size_t>(stream.remaining, config_->stream_window_size);
+        if (wanted > 0)
+        {
+            chunk.resize(offset + wanted);
+            size_t produced = std::min(stream.source(chunk.data() + offset, wanted), wanted);
+            if (produced == 0)
+            {
+                // 消息头已声明长度，数据源提前结束时对端无法再对齐帧边界
+                spdlog::error("流式数据源提前结束，剩余 {} 字节，关闭会话: {}", stream.remaining, id_);
+                outbound_stream_.reset();
+                close();
+                return;
+            }
+            chunk.resize(offset + produced);
+            stream.remaining -= static_cast<uint32_t>(produced);
+        }
+
+        if (!submit_write(std::move(chunk), true))
+        {
+            outbound_stream_.reset();
+            close();
+        }
+    }
+
+    void Session::on_stream_chunk_written(std::vector<uint8_t> buffer)
+    {
+        if (!outbound_stream_ || is_closing_)
+        {
+            return;
+        }
+
+        // 复用分块缓冲区
+        outbound_stream_->frame = std::move(buffer);
+        if (outbound_stream_->remaining > 0)
+        {
+            pump_stream();
+            return;
+        }
+
+        outbound_stream_.reset();
+        flush_outbound_queue();
+    }
+
+    void Session::flush_outbound_queue()
+    {
+        while (!outbound_stream_ && !outbound_queue_.empty() && !is_closing_)
+        {
+            auto item = std::move(outbound_queue_.front());
+            outbound_queue_.pop_front();
+            if (item->source)
+            {
+                start_stream(std::move(item));
+            }
+            else if (item->shared)
+            {
+                submit_write(std::move(item->shared));
+            }
+            else
+            {
+                submit_write(std::move(item->frame), false, std::move(item->pool));
+            }
         }
     }
 
     void Session::on_alloc(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf)
     {
         auto session = static_cast<Session *>(handle->data);
-        if (session->alloc_callback_)
+        if (session->config_->alloc_callback)
         {
-            *buf = session->alloc_callback_(suggested_size);
+            *buf = session->config_->alloc_callback(suggested_size);
         }
         else
         {
-            *buf = uv_buf_init(new char[suggested_size], suggested_size);
+            (void)suggested_size;
+            *buf = uv_buf_init(thread_read_buffer(), READ_BUFFER_SIZE);
         }
     }
 
@@ -158,6 +570,9 @@ namespace libuv_net
     {
         auto session = static_cast<Session *>(stream->data);
 
+        // 由分配回调提供的缓冲区在读取后释放
+        std::unique_ptr<char[]> owned(buf->base != thread_read_buffer() ? buf->base : nullptr);
+
         if (nread < 0)
         {
             if (nread != UV_EOF)
@@ -173,103 +588,326 @@ namespace libuv_net
             return;
         }
 
+        // 已改用共享内存：套接字上只有通知，检查两个方向的环形缓冲区
+        if (session->shm_ && session->shm_->active)
+        {
+            session->drain_shm();
+            session->flush_shm();
+            return;
+        }
+
+        // TCP_QUICKACK 在内核中不持久，每次读取后重新设置
+        if (session->config_->socket_options.quickack && session->transport_ == Transport::TCP)
+        {
+            rearm_quickack(&session->socket_.tcp);
+        }
+
         // 处理接收到的数据
-        if (session->read_handler_)
+        if (session->config_->read_handler)
         {
-            session->read_handler_(nread, buf);
+            session->config_->read_handler(nread, buf);
         }
         else
         {
             session->append_to_buffer(buf->base, nread);
-        }
 
-        delete[] buf->base;
+            // 本次读取中完成了协商，对端可能已经写入了环形缓冲区
+            if (session->shm_ && session->shm_->active && !session->is_closing_)
+            {
+                session->drain_shm();
+            }
+        }
     }
 
     void Session::on_write(uv_write_t *req, int status)
     {
-        auto session = static_cast<Session *>(req->data);
-        delete req;
+        std::unique_ptr<WriteRequest> request(static_cast<WriteRequest *>(req->data));
+        auto session = request->session;
 
         if (status < 0)
         {
-            spdlog::error("写入错误: {}", uv_strerror(status));
+            if (status != UV_ECANCELED)
+            {
+                spdlog::error("写入错误: {}", uv_strerror(status));
+            }
             session->close();
+            return;
+        }
+
+        session->complete_write(std::move(request));
+    }
+
+    void Session::complete_write(std::unique_ptr<WriteRequest> request)
+    {
+        if (request->stream_chunk)
+        {
+            on_stream_chunk_written(std::move(request->data));
+            return;
+        }
+
+        // 归还帧缓冲区到取出它的池，共享的帧随最后一个引用释放
+        if (request->pool)
+        {
+            request->pool->release(std::move(request->data));
         }
     }
 
     void Session::on_close(uv_handle_t *handle)
     {
         auto session = static_cast<Session *>(handle->data);
-        if (session->close_handler_)
+        session->is_closed_ = true;
+        session->outbound_stream_.reset();
+        session->outbound_queue_.clear();
+        session->shm_.reset();
+
+        // 关闭回调可能释放会话，先持有配置
+        auto config = session->config_;
+        if (config->close_handler)
         {
-            session->close_handler_();
+            config->close_handler(*session);
         }
     }
 
-    void Session::on_heartbeat_timer(uv_timer_t *handle)
+    bool Session::check_heartbeat(std::chrono::steady_clock::time_point now)
     {
-        auto session = static_cast<Session *>(handle->data);
+        if (is_closing_)
+        {
+            return false;
+        }
 
         // 检查心跳超时
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                           now - session->last_heartbeat_time_)
-                           .count();
-
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_heartbeat_time_).count();
         if (elapsed > HEARTBEAT_TIMEOUT_MS)
         {
-            spdlog::warn("心跳超时，关闭会话: {}", session->id_);
-            session->close();
-            return;
+            spdlog::warn("心跳超时，关闭会话: {}", id_);
+            close();
+            return false;
         }
 
         // 发送心跳包
-        session->send_heartbeat();
+        send_heartbeat();
+        return true;
     }
 
     void Session::append_to_buffer(const char *data, size_t len)
     {
-        read_buffer_.insert(read_buffer_.end(), data, data + len);
-        process_buffer();
+        auto bytes = reinterpret_cast<const uint8_t *>(data);
+
+        // 没有暂存的不完整消息时直接在读取缓冲区上解析，只暂存剩余的部分
+        if (read_buffer_.empty())
+        {
+            size_t consumed = process_data(bytes, len);
+            if (consumed < len && !is_closing_)
+            {
+                read_buffer_.assign(bytes + consumed, bytes + len);
+            }
+            flush_ack();
+            return;
+        }
+
+        read_buffer_.insert(read_buffer_.end(), bytes, bytes + len);
+        process_pending();
+    }
+
+    void Session::process_pending()
+    {
+        if (read_buffer_.empty())
+        {
+            return;
+        }
+
+        size_t consumed = process_data(read_buffer_.data(), read_buffer_.size());
+        if (consumed >= read_buffer_.size() || is_closing_)
+        {
+            // 释放暂存区，空闲会话不保留缓冲区
+            std::vector<uint8_t>().swap(read_buffer_);
+        }
+        else if (consumed > 0)
+        {
+            read_buffer_.erase(read_buffer_.begin(), read_buffer_.begin() + consumed);
+        }
+        flush_ack();
     }
 
-    void Session::process_buffer()
+    size_t Session::buffered_bytes() const
     {
-        while (!read_buffer_.empty())
+        size_t bytes = read_buffer_.size() +
+                       uv_stream_get_write_queue_size(reinterpret_cast<const uv_stream_t *>(&socket_));
+        for (const auto &item : outbound_queue_)
+        {
+            bytes += item->shared ? item->shared->size() : item->frame.size();
+        }
+        if (shm_)
+        {
+            for (const auto &request : shm_->pending)
+            {
+                bytes += request->shared ? request->shared->size() : request->data.size();
+            }
+            bytes -= shm_->pending_offset;
+        }
+        return bytes;
+    }
+
+    size_t Session::process_data(const uint8_t *buffer, size_t buffer_size)
+    {
+        // 处理器可能替换会话配置，解析期间保持原配置存活
+        auto config_guard = config_;
+        size_t offset = 0;
+
+        // 本轮的处理预算
+        size_t dispatched = 0;
+        bool budgeted = config_->read_scheduler &&
+                        (config_->read_budget_packets > 0 || config_->read_budget_time.count() > 0);
+        auto turn_start = budgeted && config_->read_budget_time.count() > 0 ? std::chrono::steady_clock::now()
+                                                                            : std::chrono::steady_clock::time_point{};
+        auto budget_exhausted = [&]()
+        {
+            ++dispatched;
+            if (!budgeted)
+            {
+                return false;
+            }
+            if (config_->read_budget_packets > 0 && dispatched >= config_->read_budget_packets)
+            {
+                return true;
+            }
+            return config_->read_budget_time.count() > 0 &&
+                   std::chrono::steady_clock::now() - turn_start >= config_->read_budget_time;
+        };
+        auto defer = [this]()
+        {
+            // 暂停读取，剩余数据由调度器在之后的迭代中轮转处理
+            pause_reading(PAUSE_BUDGET);
+            config_->read_scheduler->defer(weak_from_this());
+        };
+
+        // 除 stop() 外的暂停原因（如限流）都会中止处理，剩余数据留待恢复时处理
+        while (offset < buffer_size && !is_closing_ && (read_pause_ & ~PAUSE_STOPPED) == 0)
         {
+            const uint8_t *data = buffer + offset;
+            size_t available = buffer_size - offset;
+
+            // 正在接收流：按窗口大小交付已到达的数据
+            if (inbound_streaming_)
+            {
+                size_t size = std::min({available, static_cast<size_t>(inbound_remaining_), config_->stream_window_size});
+                if (!admit(inbound_header_.type, 0, size))
+                {
+                    break;
+                }
+                inbound_remaining_ -= static_cast<uint32_t>(size);
+                offset += size;
+
+                bool last = inbound_remaining_ == 0;
+                if (last)
+                {
+                    inbound_streaming_ = false;
+                }
+                if (auto handler = config_->chunk_handlers.find(inbound_header_.type))
+                {
+                    (*handler)(*this, inbound_header_, data, size, last);
+                }
+                if (last)
+                {
+                    record_durable(inbound_header_);
+                }
+                if (budget_exhausted() && offset < buffer_size)
+                {
+                    defer();
+                }
+                continue;
+            }
+
             // 检查是否有完整的消息头
-            if (read_buffer_.size() < sizeof(PacketHeader))
+            if (available < sizeof(PacketHeader))
             {
-                return;
+                break;
             }
 
             // 解析消息头
-            const PacketHeader *header = reinterpret_cast<const PacketHeader *>(read_buffer_.data());
+            PacketHeader header;
+            std::memcpy(&header, data, sizeof(PacketHeader));
+            if (header.version != PROTOCOL_VERSION)
+            {
+                spdlog::error("协议版本不匹配: {}，关闭会话: {}", header.version, id_);
+                close();
+                return offset;
+            }
+
+            // 注册了分块回调的类型按流接收，不整帧缓存
+            if (auto chunk_handler = config_->chunk_handlers.find(header.type))
+            {
+                if (!admit(header.type, 1, sizeof(PacketHeader)))
+                {
+                    break;
+                }
+                offset += sizeof(PacketHeader);
+                if (header.length == 0)
+                {
+                    (*chunk_handler)(*this, header, nullptr, 0, true);
+                    record_durable(header);
+                    continue;
+                }
+                inbound_streaming_ = true;
+                inbound_header_ = header;
+                inbound_remaining_ = header.length;
+                continue;
+            }
+
+            // 在分配内存之前拒绝超长的消息
+            if (header.length > config_->max_frame_size)
+            {
+                spdlog::error("消息长度 {} 超过上限 {}，关闭会话: {}", header.length, config_->max_frame_size, id_);
+                close();
+                return offset;
+            }
 
             // 检查消息体是否完整
-            if (read_buffer_.size() < sizeof(PacketHeader) + header->length)
+            size_t frame_size = sizeof(PacketHeader) + header.length;
+            if (available < frame_size)
             {
-                return;
+                break;
+            }
+
+            // 过载时直接丢弃低优先级类型的消息，不再解析和分发
+            if (config_->admission && config_->admission->shed(header.type))
+            {
+                offset += frame_size;
+                continue;
+            }
+
+            // 入站限流，超出时暂停读取，该消息留待恢复后处理
+            if (!admit(header.type, 1, frame_size))
+            {
+                break;
             }
 
             // 创建消息对象
             auto packet = std::make_shared<Packet>();
-            if (!packet->deserialize(read_buffer_.data(), sizeof(PacketHeader) + header->length))
+            if (!packet->deserialize(data, frame_size))
             {
                 spdlog::error("消息解析失败");
-                read_buffer_.clear();
-                return;
+                return buffer_size;
             }
+            offset += frame_size;
 
             // 处理消息
             handle_packet(packet);
+            record_durable(header);
 
-            // 移除已处理的数据
-            read_buffer_.erase(
-                read_buffer_.begin(),
-                read_buffer_.begin() + sizeof(PacketHeader) + header->length);
+            // 协商完成后改用共享内存，流中剩余的数据都是通知
+            if (shm_ && shm_->switched)
+            {
+                shm_->switched = false;
+                return buffer_size;
+            }
+            if (budget_exhausted() && offset < buffer_size)
+            {
+                defer();
+            }
         }
+
+        return offset;
     }
 
     void Session::handle_packet(std::shared_ptr<Packet> packet)
@@ -281,49 +919,63 @@ namespace libuv_net
             return;
         }
 
-        // 使用拦截器处理数据
-        auto interceptor = interceptor_manager_.get_interceptor(packet->type());
-        if (interceptor)
+        if (packet->type() == PacketType::SHM_HANDSHAKE)
         {
-            auto data = interceptor->deserialize(packet->data());
-            if (data.has_value())
+            handle_shm_handshake(*packet);
+            return;
+        }
+
+        // 附加拦截器并丢弃无法解码的消息，结果缓存在数据包上，处理器经 decoded() / as<T>() 取出时不再解析
+        if (auto interceptor = config_->interceptors.share_interceptor(packet->type()))
+        {
+            packet->set_interceptor(std::move(interceptor));
+            if (!packet->decoded().has_value())
             {
-                // 查找对应的处理器
-                auto it = packet_handlers_.find(packet->type());
-                if (it != packet_handlers_.end())
-                {
-                    it->second(packet);
-                }
-                else if (default_packet_handler_)
-                {
-                    default_packet_handler_(packet);
-                }
+                spdlog::warn("拦截器解码失败，类型: {}", static_cast<int>(packet->type()));
+                return;
             }
+        }
+
+        // 登记了编解码器的类型先做解码校验
+        if (!config_->codecs.accepts(*packet))
+        {
+            spdlog::warn("消息解码失败，类型: {}", static_cast<int>(packet->type()));
             return;
         }
 
         // 查找对应的处理器
-        auto it = packet_handlers_.find(packet->type());
-        if (it != packet_handlers_.end())
+        if (auto handler = config_->packet_handlers.find(packet->type()))
         {
-            it->second(packet);
+            (*handler)(*this, packet);
         }
-        else if (default_packet_handler_)
+        else if (config_->default_packet_handler)
         {
-            default_packet_handler_(packet);
+            config_->default_packet_handler(*this, packet);
         }
     }
 
-    void Session::start_heartbeat()
+    void Session::record_durable(const PacketHeader &header)
     {
-        last_heartbeat_time_ = std::chrono::steady_clock::now();
-        uv_timer_start(&heartbeat_timer_, on_heartbeat_timer,
-                       HEARTBEAT_INTERVAL_MS, HEARTBEAT_INTERVAL_MS);
+        if (!config_->acknowledge || !(header.flags & PACKET_FLAG_DURABLE) || header.sequence == 0)
+        {
+            return;
+        }
+        // 序列号按 32 位回绕比较，重发的旧消息不使已答复的序列号后退
+        if (ack_sequence_ == 0 || static_cast<int32_t>(header.sequence - ack_sequence_) > 0)
+        {
+            ack_sequence_ = header.sequence;
+            ack_pending_ = true;
+        }
     }
 
-    void Session::stop_heartbeat()
+    void Session::flush_ack()
     {
-        uv_timer_stop(&heartbeat_timer_);
+        if (!ack_pending_ || is_closing_)
+        {
+            return;
+        }
+        ack_pending_ = false;
+        send(std::make_shared<Packet>(PacketType::ACK, encode_ack(ack_sequence_)));
     }
 
     void Session::send_heartbeat()
@@ -332,4 +984,394 @@ namespace libuv_net
         send(packet);
     }
 
+    bool Session::offer_shared_memory(const ShmOptions &options)
+    {
+        // 提议必须是套接字上的最后一条消息，流发送期间不切换
+        if (is_closing_ || shm_ || transport_ != Transport::PIPE || !options.enabled ||
+            outbound_stream_ || !outbound_queue_.empty())
+        {
+            return false;
+        }
+
+        auto channel = ShmChannel::create(options.ring_size);
+        if (!channel)
+        {
+            return false;
+        }
+        send_shm_handshake(SHM_OFFER, channel->ring_size(), channel->name());
+
+        shm_ = std::make_unique<ShmState>();
+        shm_->channel = std::move(channel);
+        shm_->polling = options.polling;
+        return true;
+    }
+
+    bool Session::is_shared_memory() const
+    {
+        return shm_ && shm_->active;
+    }
+
+    void Session::send_shm_handshake(uint8_t op, size_t ring_size, const std::string &name)
+    {
+        uint32_t size = static_cast<uint32_t>(ring_size);
+        std::vector<uint8_t> payload(SHM_HANDSHAKE_HEADER + name.size());
+        payload[0] = op;
+        for (int i = 0; i < 4; ++i)
+        {
+            payload[1 + i] = static_cast<uint8_t>(size >> (8 * i));
+        }
+        std::memcpy(payload.data() + SHM_HANDSHAKE_HEADER, name.data(), name.size());
+        send(std::make_shared<Packet>(PacketType::SHM_HANDSHAKE, std::move(payload)));
+    }
+
+    void Session::handle_shm_handshake(const Packet &packet)
+    {
+        const auto &payload = packet.data();
+        if (payload.size() < SHM_HANDSHAKE_HEADER)
+        {
+            spdlog::error("共享内存协商消息格式错误，关闭会话: {}", id_);
+            close();
+            return;
+        }
+        uint32_t ring_size = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            ring_size |= static_cast<uint32_t>(payload[1 + i]) << (8 * i);
+        }
+
+        switch (payload[0])
+        {
+        case SHM_OFFER:
+        {
+            std::string name(payload.begin() + SHM_HANDSHAKE_HEADER, payload.end());
+            // 答复之后双方都不再用套接字发送消息，流发送期间无法切换
+            const ShmOptions &options = config_->shared_memory;
+            std::unique_ptr<ShmChannel> channel;
+            if (options.enabled && !shm_ && transport_ == Transport::PIPE && !outbound_stream_ && outbound_queue_.empty())
+            {
+                // 只映射套接字对端进程创建的段
+                PeerCredentials peer;
+                int result = get_peer_credentials(&socket_.pipe, peer);
+                if (result == 0)
+                {
+                    channel = ShmChannel::open(name, ring_size, peer.pid, peer.uid);
+                }
+                else
+                {
+                    spdlog::error("获取对端进程凭据失败，拒绝共享内存传输: {}", uv_strerror(result));
+                }
+            }
+            if (!channel)
+            {
+                send_shm_handshake(SHM_REJECT, ring_size, std::string());
+                return;
+            }
+            send_shm_handshake(SHM_ACCEPT, ring_size, std::string());
+
+            shm_ = std::make_unique<ShmState>();
+            shm_->channel = std::move(channel);
+            shm_->polling = options.polling;
+            activate_shm();
+            return;
+        }
+        case SHM_ACCEPT:
+            if (shm_ && !shm_->active)
+            {
+                // 双方都已映射，不再需要名称
+                shm_->channel->unlink();
+                activate_shm();
+                flush_shm();
+                return;
+            }
+            break;
+        case SHM_REJECT:
+            if (shm_ && !shm_->active)
+            {
+                // 继续使用套接字，按顺序发出暂存的消息
+                spdlog::info("对端拒绝共享内存传输: {}", id_);
+                auto pending = std::move(shm_->pending);
+                shm_.reset();
+                for (auto &request : pending)
+                {
+                    auto raw = request.release();
+                    submit_request(raw, raw->shared ? *raw->shared : raw->data);
+                }
+                return;
+            }
+            break;
+        }
+
+        spdlog::error("意外的共享内存协商消息，关闭会话: {}", id_);
+        close();
+    }
+
+    void Session::activate_shm()
+    {
+        shm_->active = true;
+        shm_->switched = true;
+        spdlog::info("会话改用共享内存传输: {}", id_);
+
+        if (shm_->polling)
+        {
+            shm_->idle = new uv_idle_t;
+            uv_idle_init(loop_, shm_->idle);
+            shm_->idle->data = this;
+            uv_idle_start(shm_->idle, on_shm_idle);
+        }
+    }
+
+    void Session::on_shm_idle(uv_idle_t *handle)
+    {
+        auto session = static_cast<Session *>(handle->data);
+        session->drain_shm();
+        session->flush_shm();
+    }
+
+    void Session::drain_shm()
+    {
+        if (!shm_ || !shm_->active)
+        {
+            return;
+        }
+
+        ShmRing &rx = shm_->channel->rx();
+        while (!is_closing_ && read_pause_ == 0)
+        {
+            auto [data, size] = rx.peek();
+            if (size == 0)
+            {
+                if (shm_->polling)
+                {
+                    break;
+                }
+                // 设置等待标志后再检查一次，避免错过对端在此期间写入的数据
+                rx.set_reader_waiting(true);
+                if (rx.empty())
+                {
+                    break;
+                }
+                rx.set_reader_waiting(false);
+                continue;
+            }
+
+            append_to_buffer(reinterpret_cast<const char *>(data), size);
+            rx.consume(size);
+
+            // 对端因缓冲区已满在等待
+            if (rx.take_writer_waiting())
+            {
+                ring_doorbell();
+            }
+        }
+    }
+
+    void Session::flush_shm()
+    {
+        if (!shm_ || !shm_->active || shm_->flushing || is_closing_)
+        {
+            return;
+        }
+
+        shm_->flushing = true;
+        ShmRing &tx = shm_->channel->tx();
+        bool waiting = false;
+        while (!shm_->pending.empty() && !is_closing_)
+        {
+            auto &request = shm_->pending.front();
+            const auto &data = request->shared ? *request->shared : request->data;
+            shm_->pending_offset += tx.write(data.data() + shm_->pending_offset, data.size() - shm_->pending_offset);
+            if (shm_->pending_offset < data.size())
+            {
+                // 缓冲区已满：设置等待标志后再试一次，之后等对端读取后通知
+                if (waiting)
+                {
+                    break;
+                }
+                tx.set_writer_waiting(true);
+                waiting = true;
+                continue;
+            }
+
+            auto done = std::move(shm_->pending.front());
+            shm_->pending.pop_front();
+            shm_->pending_offset = 0;
+            complete_write(std::move(done));
+        }
+        if (shm_)
+        {
+            shm_->flushing = false;
+        }
+
+        // 对端在等待数据
+        if (tx.take_reader_waiting())
+        {
+            ring_doorbell();
+        }
+    }
+
+    void Session::ring_doorbell()
+    {
+        static char bell = 0;
+        uv_buf_t buf = uv_buf_init(&bell, 1);
+        int result = uv_try_write(get_stream(), &buf, 1);
+        if (result == UV_EAGAIN)
+        {
+            // 套接字缓冲区已满，排队写出，对端读到任意一个通知都会检查环形缓冲区
+            auto req = new uv_write_t;
+            result = uv_write(req, get_stream(), &buf, 1, [](uv_write_t *req, int)
+                              { delete req; });
+            if (result)
+            {
+                delete req;
+            }
+        }
+        if (result < 0 && !is_closing_)
+        {
+            spdlog::error("发送通知失败: {}", uv_strerror(result));
+            close();
+        }
+    }
+
+    bool Session::send_unreliable(std::shared_ptr<Packet> packet)
+    {
+        if (is_closing_ || !packet)
+        {
+            return false;
+        }
+
+        // 按类型分配序列号，经流发送时也使用，保持编号连续
+        uint32_t sequence = 1;
+        if (!datagram_)
+        {
+            datagram_ = std::make_unique<DatagramState>();
+        }
+        if (uint32_t *last = datagram_->sent.find(packet->type()))
+        {
+            sequence = ++*last;
+        }
+        else
+        {
+            datagram_->sent.set(packet->type(), sequence);
+        }
+
+        const auto &data = packet->data();
+        if (has_datagram())
+        {
+            const sockaddr *peer = datagram_->has_peer ? reinterpret_cast<const sockaddr *>(&datagram_->peer) : nullptr;
+            if (datagram_->socket->send(peer, datagram_->token, packet->type(), sequence, data.data(), data.size()))
+            {
+                return true;
+            }
+        }
+
+        // 数据报通道不可用或消息超出数据报的上限
+        send_frame(packet->type(), data.size(), [&data](uint8_t *out, size_t size)
+                   {
+                       if (size > 0)
+                       {
+                           std::memcpy(out, data.data(), size);
+                       }
+                       return true; }, sequence);
+        return true;
+    }
+
+    void Session::attach_datagram(DatagramSocket *socket, uint64_t token)
+    {
+        if (!datagram_)
+        {
+            datagram_ = std::make_unique<DatagramState>();
+        }
+        datagram_->socket = socket;
+        datagram_->token = token;
+    }
+
+    void Session::set_datagram_peer(const sockaddr *addr, uint64_t counter)
+    {
+        if (!datagram_ || (datagram_->has_peer && counter <= datagram_->peer_counter))
+        {
+            return;
+        }
+        datagram_->peer_counter = counter;
+        std::memcpy(&datagram_->peer, addr, addr->sa_family == AF_INET6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in));
+        datagram_->has_peer = true;
+    }
+
+    uint64_t Session::datagram_token() const
+    {
+        return datagram_ ? datagram_->token : 0;
+    }
+
+    bool Session::has_datagram() const
+    {
+        // 套接字已连接对端（客户端）或已收到对端的数据报（服务器）
+        return datagram_ && datagram_->socket && (datagram_->has_peer || datagram_->socket->connected());
+    }
+
+    void Session::receive_datagram(const uint8_t *data, size_t size)
+    {
+        if (!datagram_ || is_closing_)
+        {
+            return;
+        }
+
+        // 处理器可能替换会话配置，解析期间保持原配置存活
+        auto config_guard = config_;
+        size_t offset = 0;
+        while (size - offset >= sizeof(PacketHeader) && !is_closing_)
+        {
+            PacketHeader header;
+            std::memcpy(&header, data + offset, sizeof(PacketHeader));
+            if (header.version != PROTOCOL_VERSION || header.length > size - offset - sizeof(PacketHeader))
+            {
+                spdlog::debug("丢弃格式错误的数据报: {}", id_);
+                return;
+            }
+            const uint8_t *frame = data + offset;
+            size_t frame_size = sizeof(PacketHeader) + header.length;
+            offset += frame_size;
+
+            // 协商和确认消息只经由连接传递
+            if (header.type == PacketType::SHM_HANDSHAKE || header.type == PacketType::DATAGRAM_BIND ||
+                header.type == PacketType::ACK)
+            {
+                continue;
+            }
+
+            // 丢弃已被更新的同类型消息取代的消息，序列号回绕时按差值的符号比较
+            if (uint32_t *last = datagram_->received.find(header.type))
+            {
+                if (static_cast<int32_t>(header.sequence - *last) <= 0)
+                {
+                    continue;
+                }
+                *last = header.sequence;
+            }
+            else
+            {
+                datagram_->received.set(header.type, header.sequence);
+            }
+
+            // 与流上的消息相同的长度上限和限流，超出时只丢弃数据报中的消息，不暂停连接的读取
+            if (header.length > config_->max_frame_size)
+            {
+                spdlog::debug("丢弃超过长度上限的数据报消息: {}", id_);
+                continue;
+            }
+            if (config_->admission && config_->admission->shed(header.type))
+            {
+                continue;
+            }
+            if (!admit(header.type, 1, frame_size, false))
+            {
+                continue;
+            }
+
+            auto packet = std::make_shared<Packet>();
+            if (packet->deserialize(frame, frame_size))
+            {
+                handle_packet(packet);
+            }
+        }
+    }
+
 } // namespace libuv_net
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "libuv_net/shm_channel.hpp"
+#include "libuv_net/secure_random.hpp"
+#include <spdlog/spdlog.h>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace libuv_net
+{
+
+    namespace
+    {
+        constexpr uint64_t SEGMENT_MAGIC = 0x31726e5f76756c6cULL; // "llvu_nr1"
+
+        // 共享内存段的头部，接受方据此校验段的格式
+        struct SegmentHeader
+        {
+            uint64_t magic;
+            uint64_t ring_size;
+        };
+
+        constexpr size_t HEADER_SIZE = 64;
+        static_assert(sizeof(SegmentHeader) <= HEADER_SIZE, "段头部超出预留空间");
+
+        // 向上取整为 2 的幂
+        size_t round_up_pow2(size_t size)
+        {
+            size_t result = 4096;
+            while (result < size)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        size_t segment_size(size_t ring_size)
+        {
+            return HEADER_SIZE + 2 * sizeof(ShmRingHeader) + 2 * ring_size;
+        }
+
+#ifndef _WIN32
+        constexpr const char *NAME_PREFIX = "/libuv_net-";
+
+        // 段名称的前缀：固定前缀加创建者的进程 ID
+        std::string name_prefix(int64_t pid)
+        {
+            return NAME_PREFIX + std::to_string(pid) + "-";
+        }
+
+        // 发起方的段名称：前缀加 128 位随机数的十六进制
+        bool random_name(std::string &name)
+        {
+            uint8_t bytes[16];
+            if (!fill_secure_random(bytes, sizeof(bytes)))
+            {
+                return false;
+            }
+            char hex[2 * sizeof(bytes) + 1];
+            for (size_t i = 0; i < sizeof(bytes); ++i)
+            {
+                std::snprintf(hex + 2 * i, 3, "%02x", bytes[i]);
+            }
+            name = name_prefix(getpid()) + hex;
+            return true;
+        }
+#endif
+    }
+
+    ShmChannel::~ShmChannel()
+    {
+        unlink();
+#ifndef _WIN32
+        if (memory_)
+        {
+            munmap(memory_, mapped_size_);
+        }
+#endif
+    }
+
+    void ShmChannel::unlink()
+    {
+#ifndef _WIN32
+        if (owns_name_)
+        {
+            shm_unlink(name_.c_str());
+            owns_name_ = false;
+        }
+#endif
+    }
+
+#ifndef _WIN32
+    std::unique_ptr<ShmChannel> ShmChannel::create(size_t ring_size)
+    {
+        ring_size = round_up_pow2(ring_size);
+        std::unique_ptr<ShmChannel> channel(new ShmChannel());
+        if (!random_name(channel->name_))
+        {
+            spdlog::error("生成共享内存段名称失败: {}", std::strerror(errno));
+            return nullptr;
+        }
+
+        int fd = shm_open(channel->name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0)
+        {
+            spdlog::error("创建共享内存段 {} 失败: {}", channel->name_, std::strerror(errno));
+            return nullptr;
+        }
+        channel->owns_name_ = true;
+
+        bool mapped = ftruncate(fd, static_cast<off_t>(segment_size(ring_size))) == 0 &&
+                      channel->map(fd, ring_size, true, true);
+        ::close(fd);
+        return mapped ? std::move(channel) : nullptr;
+    }
+
+    std::unique_ptr<ShmChannel> ShmChannel::open(const std::string &name, size_t ring_size,
+                                                 int64_t creator_pid, uint32_t creator_uid)
+    {
+        // 名称必须由对端进程按 create() 的格式生成，不含其他路径成分
+        std::string prefix = name_prefix(creator_pid);
+        if (name.size() != prefix.size() + 32 || name.compare(0, prefix.size(), prefix) != 0 ||
+            name.find('/', 1) != std::string::npos)
+        {
+            spdlog::error("共享内存段 {} 不是对端进程 {} 创建的", name, creator_pid);
+            return nullptr;
+        }
+
+        std::unique_ptr<ShmChannel> channel(new ShmChannel());
+        channel->name_ = name;
+
+        int fd = shm_open(name.c_str(), O_RDWR | O_NOFOLLOW, 0);
+        if (fd < 0)
+        {
+            spdlog::error("打开共享内存段 {} 失败: {}", name, std::strerror(errno));
+            return nullptr;
+        }
+
+        // 段的所有者必须是对端用户，且其他用户无权访问
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_uid != creator_uid || (st.st_mode & 077) != 0)
+        {
+            spdlog::error("共享内存段 {} 的所有者或权限与对端不符", name);
+            ::close(fd);
+            return nullptr;
+        }
+
+        // 校验段的大小，避免映射超出文件的范围
+        bool mapped = ring_size == round_up_pow2(ring_size) &&
+                      static_cast<size_t>(st.st_size) == segment_size(ring_size) &&
+                      channel->map(fd, ring_size, false, false);
+        ::close(fd);
+        if (!mapped)
+        {
+            spdlog::error("共享内存段 {} 的格式不匹配", name);
+            return nullptr;
+        }
+        return channel;
+    }
+
+    bool ShmChannel::map(int fd, size_t ring_size, bool initiator, bool initialize)
+    {
+        size_t size = segment_size(ring_size);
+        void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (memory == MAP_FAILED)
+        {
+            spdlog::error("映射共享内存段失败: {}", std::strerror(errno));
+            return false;
+        }
+        memory_ = memory;
+        mapped_size_ = size;
+        ring_size_ = ring_size;
+
+        auto base = static_cast<uint8_t *>(memory);
+        auto segment = reinterpret_cast<SegmentHeader *>(base);
+        auto headers = reinterpret_cast<ShmRingHeader *>(base + HEADER_SIZE);
+        uint8_t *data = base + HEADER_SIZE + 2 * sizeof(ShmRingHeader);
+
+        if (initialize)
+        {
+            for (int i = 0; i < 2; ++i)
+            {
+                new (&headers[i]) ShmRingHeader();
+                headers[i].tail.store(0, std::memory_order_relaxed);
+                headers[i].head.store(0, std::memory_order_relaxed);
+                headers[i].reader_waiting.store(0, std::memory_order_relaxed);
+                headers[i].writer_waiting.store(0, std::memory_order_relaxed);
+            }
+            segment->ring_size = ring_size;
+            std::atomic_thread_fence(std::memory_order_release);
+            segment->magic = SEGMENT_MAGIC;
+        }
+        else if (segment->magic != SEGMENT_MAGIC || segment->ring_size != ring_size)
+        {
+            return false;
+        }
+
+        // 发起方写第一个环形缓冲区、读第二个，接受方相反
+        ShmRing first(&headers[0], data, ring_size);
+        ShmRing second(&headers[1], data + ring_size, ring_size);
+        tx_ = initiator ? first : second;
+        rx_ = initiator ? second : first;
+        return true;
+    }
+#else
+    std::unique_ptr<ShmChannel> ShmChannel::create(size_t)
+    {
+        spdlog::error("当前平台不支持共享内存传输");
+        return nullptr;
+    }
+
+    std::unique_ptr<ShmChannel> ShmChannel::open(const std::string &, size_t, int64_t, uint32_t)
+    {
+        spdlog::error("当前平台不支持共享内存传输");
+        return nullptr;
+    }
+
+    bool ShmChannel::map(int, size_t, bool, bool)
+    {
+        return false;
+    }
+#endif
+
+} // namespace libuv_net
@@ -0,0 +1,101 @@
+#include "libuv_net/socket_options.hpp"
+#include <spdlog/spdlog.h>
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <cerrno>
+#endif
+
+namespace libuv_net
+{
+
+    namespace
+    {
+#ifndef _WIN32
+        // 设置整数类型的套接字选项
+        int set_int_option(uv_tcp_t *handle, int level, int name, int value)
+        {
+            uv_os_fd_t fd;
+            int result = uv_fileno(reinterpret_cast<uv_handle_t *>(handle), &fd);
+            if (result)
+            {
+                return result;
+            }
+            if (setsockopt(fd, level, name, &value, sizeof(value)) != 0)
+            {
+                return uv_translate_sys_error(errno);
+            }
+            return 0;
+        }
+#endif
+
+        // 记录失败项，保留第一个错误码
+        void check(int result, const char *option, int &first_error)
+        {
+            if (result)
+            {
+                spdlog::warn("设置套接字选项 {} 失败: {}", option, uv_strerror(result));
+                if (!first_error)
+                {
+                    first_error = result;
+                }
+            }
+        }
+    }
+
+    int apply_socket_options(uv_tcp_t *handle, const SocketOptions &options)
+    {
+        int first_error = 0;
+
+        if (options.nodelay)
+        {
+            check(uv_tcp_nodelay(handle, 1), "TCP_NODELAY", first_error);
+        }
+        if (options.keepalive)
+        {
+            check(uv_tcp_keepalive(handle, 1, options.keepalive_delay), "SO_KEEPALIVE", first_error);
+        }
+        if (options.send_buffer_size > 0)
+        {
+            int size = options.send_buffer_size;
+            check(uv_send_buffer_size(reinterpret_cast<uv_handle_t *>(handle), &size), "SO_SNDBUF", first_error);
+        }
+        if (options.recv_buffer_size > 0)
+        {
+            int size = options.recv_buffer_size;
+            check(uv_recv_buffer_size(reinterpret_cast<uv_handle_t *>(handle), &size), "SO_RCVBUF", first_error);
+        }
+
+#if !defined(_WIN32) && defined(SO_BUSY_POLL)
+        if (options.busy_poll_us > 0)
+        {
+            check(set_int_option(handle, SOL_SOCKET, SO_BUSY_POLL, options.busy_poll_us), "SO_BUSY_POLL", first_error);
+        }
+#endif
+#if !defined(_WIN32) && defined(TCP_QUICKACK)
+        if (options.quickack)
+        {
+            check(set_int_option(handle, IPPROTO_TCP, TCP_QUICKACK, 1), "TCP_QUICKACK", first_error);
+        }
+#endif
+#if !defined(_WIN32) && defined(TCP_NOTSENT_LOWAT)
+        if (options.notsent_lowat > 0)
+        {
+            check(set_int_option(handle, IPPROTO_TCP, TCP_NOTSENT_LOWAT, options.notsent_lowat), "TCP_NOTSENT_LOWAT", first_error);
+        }
+#endif
+
+        return first_error;
+    }
+
+    void rearm_quickack(uv_tcp_t *handle)
+    {
+#if !defined(_WIN32) && defined(TCP_QUICKACK)
+        set_int_option(handle, IPPROTO_TCP, TCP_QUICKACK, 1);
+#else
+        (void)handle;
+#endif
+    }
+
+} // namespace libuv_net
@@ -0,0 +1,124 @@
+#include "libuv_net/unix_socket.hpp"
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#endif
+
+namespace libuv_net
+{
+
+#ifdef __linux__
+    namespace
+    {
+        // 构造抽象命名空间的地址：sun_path 以 \0 开头，长度不含结尾的 \0
+        int make_abstract_address(const std::string &path, sockaddr_un &addr, socklen_t &addr_len)
+        {
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            if (!is_abstract_socket_path(path) || path.size() > sizeof(addr.sun_path))
+            {
+                return UV_EINVAL;
+            }
+            std::memcpy(addr.sun_path + 1, path.data() + 1, path.size() - 1);
+            addr_len = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size());
+            return 0;
+        }
+
+        // 将套接字交给管道句柄，失败时关闭套接字
+        int open_pipe(uv_pipe_t *handle, int fd)
+        {
+            int result = uv_pipe_open(handle, fd);
+            if (result)
+            {
+                ::close(fd);
+            }
+            return result;
+        }
+    }
+
+    int bind_abstract_socket(uv_pipe_t *handle, const std::string &path)
+    {
+        sockaddr_un addr;
+        socklen_t addr_len;
+        if (int result = make_abstract_address(path, addr, addr_len))
+        {
+            return result;
+        }
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            return uv_translate_sys_error(errno);
+        }
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), addr_len) != 0)
+        {
+            int result = uv_translate_sys_error(errno);
+            ::close(fd);
+            return result;
+        }
+        return open_pipe(handle, fd);
+    }
+
+    int connect_abstract_socket(uv_pipe_t *handle, const std::string &path)
+    {
+        sockaddr_un addr;
+        socklen_t addr_len;
+        if (int result = make_abstract_address(path, addr, addr_len))
+        {
+            return result;
+        }
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+        if (fd < 0)
+        {
+            return uv_translate_sys_error(errno);
+        }
+        if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), addr_len) != 0)
+        {
+            int result = uv_translate_sys_error(errno);
+            ::close(fd);
+            return result;
+        }
+        return open_pipe(handle, fd);
+    }
+
+    int get_peer_credentials(const uv_pipe_t *handle, PeerCredentials &credentials)
+    {
+        uv_os_fd_t fd;
+        int result = uv_fileno(reinterpret_cast<const uv_handle_t *>(handle), &fd);
+        if (result)
+        {
+            return result;
+        }
+        ucred cred{};
+        socklen_t len = sizeof(cred);
+        if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0)
+        {
+            return uv_translate_sys_error(errno);
+        }
+        credentials.pid = cred.pid;
+        credentials.uid = cred.uid;
+        return 0;
+    }
+#else
+    int bind_abstract_socket(uv_pipe_t *, const std::string &)
+    {
+        return UV_ENOTSUP;
+    }
+
+    int connect_abstract_socket(uv_pipe_t *, const std::string &)
+    {
+        return UV_ENOTSUP;
+    }
+
+    int get_peer_credentials(const uv_pipe_t *, PeerCredentials &)
+    {
+        return UV_ENOTSUP;
+    }
+#endif
+
+} // namespace libuv_net
@@ -0,0 +1,106 @@
+#include "libuv_net/client_context.hpp"
+#include "test_util.hpp"
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <future>
+#include <thread>
+
+using namespace libuv_net;
+using test_util::expect;
+using test_util::wait_for;
+
+namespace
+{
+    // 运行中投递的任务在循环线程中执行，停止后在调用线程中直接执行
+    void test_post()
+    {
+        ClientContext context;
+        uv_loop_t *loop = context.acquire_loop();
+        context.start();
+
+        std::thread::id ran_on;
+        context.run_sync(loop, [&ran_on]()
+                         { ran_on = std::this_thread::get_id(); });
+        expect(ran_on != std::this_thread::get_id(), "运行中的任务在循环线程中执行");
+
+        std::atomic<bool> posted{false};
+        context.post(loop, [&posted]()
+                     { posted = true; });
+        expect(wait_for([&posted]()
+                        { return posted.load(); }),
+               "投递的任务由循环线程执行");
+
+        context.stop();
+        bool inline_run = false;
+        context.post(loop, [&inline_run]()
+                     { inline_run = true; });
+        expect(inline_run, "停止后投递的任务在调用线程中直接执行");
+        context.run_sync(loop, [&ran_on]()
+                         { ran_on = std::this_thread::get_id(); });
+        expect(ran_on == std::this_thread::get_id(), "停止后 run_sync() 直接执行，不等待");
+    }
+
+    // 拷贝构造时停下等待的任务：post() 在检查运行状态之后才把任务拷贝进队列
+    struct GatedTask
+    {
+        struct State
+        {
+            std::atomic<bool> copying{false};
+            std::atomic<bool> release{false};
+            std::atomic<bool> ran{false};
+        };
+        std::shared_ptr<State> state;
+
+        explicit GatedTask(std::shared_ptr<State> s) : state(std::move(s)) {}
+        GatedTask(const GatedTask &other) : state(other.state)
+        {
+            if (!state->copying.exchange(true))
+            {
+                wait_for([this]()
+                         { return state->release.load(); });
+            }
+        }
+        void operator()() const { state->ran = true; }
+    };
+
+    /**
+     * post() 检查运行状态之后、入队之前，另一个线程停止了运行时。
+     * 检查与入队不在同一把锁内时，任务进入已停止的循环的队列，永远不会执行；
+     * 同样的时序下 run_sync() 会一直等待。
+     */
+    void test_stop_during_post()
+    {
+        ClientContext context;
+        uv_loop_t *loop = context.acquire_loop();
+        context.start();
+
+        auto state = std::make_shared<GatedTask::State>();
+        GatedTask task(state);
+        std::thread poster([&context, loop, &task]()
+                           { context.post(loop, task); });
+        expect(wait_for([&state]()
+                        { return state->copying.load(); }),
+               "post() 已检查运行状态，正在拷贝任务");
+        context.stop();
+        state->release = true;
+        poster.join();
+        expect(state->ran, "停止期间投递的任务仍然执行");
+
+        // 停止后的 run_sync() 不等待
+        auto finished = std::async(std::launch::async, [&context, loop]()
+                                   { context.run_sync(loop, []() {}); });
+        expect(finished.wait_for(std::chrono::seconds(3)) == std::future_status::ready, "停止后 run_sync() 返回");
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::info);
+
+    test_post();
+    test_stop_during_post();
+
+    return test_util::finish();
+}
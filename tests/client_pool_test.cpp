@@ -0,0 +1,141 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client_pool.hpp"
+#include "test_util.hpp"
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace libuv_net;
+using test_util::expect;
+using test_util::wait_for;
+
+namespace
+{
+    constexpr uint16_t PORT = 19166;
+    constexpr uint16_t FLAPPING_PORT = 19167;
+
+    std::unique_ptr<Server> echo_server(uint16_t port)
+    {
+        auto server = std::make_unique<Server>();
+        server->set_packet_handler(PacketType::BINARY, [](std::shared_ptr<Session> session, std::shared_ptr<Packet> packet)
+                                   { session->send(packet); });
+        server->listen("127.0.0.1", port);
+        server->start();
+        return server;
+    }
+
+    /**
+     * 连接池和连接分布在两个事件循环上。服务器重启后由定时器重连，
+     * 连接所在的循环被占用时，连接池的循环不等待它，仍能及时处理其他任务。
+     */
+    void test_reconnect_across_loops()
+    {
+        auto context = std::make_shared<ClientContext>(2);
+        // 按轮询分配：连接池的定时器在 pool_loop，三个连接依次在 other_loop、pool_loop、other_loop
+        uv_loop_t *pool_loop = context->acquire_loop();
+        uv_loop_t *other_loop = context->acquire_loop();
+        context->start();
+
+        ClientPoolOptions options;
+        options.connections_per_endpoint = 2;
+        options.warm_spares = 1;
+        options.eject_after_failures = 100;
+        options.reconnect_interval = std::chrono::milliseconds(50);
+        std::atomic<int> replies{0};
+        ClientPool pool(options, context);
+        pool.set_packet_handler(PacketType::BINARY, [&replies](std::shared_ptr<Packet>)
+                                { ++replies; });
+
+        auto server = echo_server(PORT);
+        pool.start({Endpoint{"127.0.0.1", PORT}});
+        expect(wait_for([&pool]()
+                        { return pool.active_count() == 2; }),
+               "建立两个活跃连接");
+        for (int i = 0; i < 10; ++i)
+        {
+            pool.send(std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(8)));
+        }
+        expect(wait_for([&replies]()
+                        { return replies == 10; }),
+               "请求全部得到答复");
+
+        server.reset();
+        expect(wait_for([&pool]()
+                        { return pool.stats()[0].connected == 0; }),
+               "服务器停止后连接全部断开");
+
+        // 占用连接所在的循环，期间定时器多次触发重连
+        std::atomic<bool> blocked{false};
+        context->post(other_loop, [&blocked]()
+                      {
+                          blocked = true;
+                          std::this_thread::sleep_for(std::chrono::milliseconds(1000)); });
+        wait_for([&blocked]()
+                 { return blocked.load(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        auto begin = std::chrono::steady_clock::now();
+        context->run_sync(pool_loop, []() {});
+        auto waited = std::chrono::steady_clock::now() - begin;
+        expect(waited < std::chrono::milliseconds(300), "重连不同步等待其他事件循环");
+
+        server = echo_server(PORT);
+        expect(wait_for([&pool]()
+                        { return pool.active_count() == 2 && pool.stats()[0].connected == 3; }),
+               "服务器恢复后定时器重连全部连接");
+        pool.send(std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(8)));
+        expect(wait_for([&replies]()
+                        { return replies == 11; }),
+               "重连后请求得到答复");
+
+        pool.stop();
+        server.reset();
+        context->stop();
+    }
+
+    // 连上即断的端点：连接成功不清零失败计数，时间窗口内失败次数达到阈值后摘除
+    void test_flapping_ejected()
+    {
+        Server server;
+        server.set_connect_handler([](std::shared_ptr<Session> session)
+                                   { session->close(); });
+        server.listen("127.0.0.1", FLAPPING_PORT);
+        server.start();
+
+        ClientPoolOptions options;
+        options.connections_per_endpoint = 1;
+        options.warm_spares = 0;
+        options.eject_after_failures = 3;
+        options.failure_window = std::chrono::milliseconds(5000);
+        options.eject_duration = std::chrono::milliseconds(10000);
+        options.reconnect_interval = std::chrono::milliseconds(50);
+        ClientPool pool(options);
+        pool.start({Endpoint{"127.0.0.1", FLAPPING_PORT}});
+        expect(wait_for([&pool]()
+                        { return pool.stats()[0].ejected; }),
+               "反复连上即断的端点被摘除");
+        pool.stop();
+
+        // 失败间隔超过时间窗口时不累计
+        options.failure_window = std::chrono::milliseconds(100);
+        options.reconnect_interval = std::chrono::milliseconds(250);
+        ClientPool slow(options);
+        slow.start({Endpoint{"127.0.0.1", FLAPPING_PORT}});
+        std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+        expect(!slow.stats()[0].ejected, "时间窗口之外的失败不计入");
+        slow.stop();
+
+        server.stop();
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::info);
+
+    test_reconnect_across_loops();
+    test_flapping_ejected();
+
+    return test_util::finish();
+}
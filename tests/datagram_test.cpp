@@ -0,0 +1,295 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include "libuv_net/datagram.hpp"
+#include "test_util.hpp"
+#include <spdlog/spdlog.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace libuv_net;
+using test_util::expect;
+using test_util::wait_for;
+
+namespace
+{
+    constexpr int PORT = 19164;
+    constexpr int UDP_PORT = 19165;
+
+    // 不经过库的 UDP 套接字，模拟只能收发 UDP 流量的第三方
+    class RawSocket
+    {
+    public:
+        RawSocket()
+        {
+            fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+            sockaddr_in addr = loopback(0);
+            bind(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+            timeval timeout{1, 0};
+            setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        }
+
+        ~RawSocket() { ::close(fd_); }
+
+        static sockaddr_in loopback(int port)
+        {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(static_cast<uint16_t>(port));
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            return addr;
+        }
+
+        int port() const
+        {
+            sockaddr_in addr{};
+            socklen_t len = sizeof(addr);
+            getsockname(fd_, reinterpret_cast<sockaddr *>(&addr), &len);
+            return ntohs(addr.sin_port);
+        }
+
+        void send_to(int port, const std::vector<uint8_t> &data)
+        {
+            sockaddr_in addr = loopback(port);
+            sendto(fd_, data.data(), data.size(), 0, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        }
+
+        // 超时时返回空
+        std::vector<uint8_t> receive()
+        {
+            std::vector<uint8_t> data(DATAGRAM_MAX_SIZE);
+            ssize_t size = recv(fd_, data.data(), data.size(), 0);
+            data.resize(size > 0 ? static_cast<size_t>(size) : 0);
+            return data;
+        }
+
+    private:
+        int fd_;
+    };
+
+    // 令牌、计数和一个消息帧，标签由调用方决定
+    std::vector<uint8_t> forge_datagram(uint64_t token, uint64_t counter, const std::string &text, uint64_t tag)
+    {
+        std::vector<uint8_t> data(DATAGRAM_TOKEN_SIZE + DATAGRAM_COUNTER_SIZE + sizeof(PacketHeader) + text.size());
+        std::memcpy(data.data(), &token, sizeof(token));
+        std::memcpy(data.data() + DATAGRAM_TOKEN_SIZE, &counter, sizeof(counter));
+        write_packet_header(data.data() + DATAGRAM_TOKEN_SIZE + DATAGRAM_COUNTER_SIZE, PacketType::TEXT,
+                            static_cast<uint32_t>(text.size()), static_cast<uint32_t>(counter));
+        std::memcpy(data.data() + data.size() - text.size(), text.data(), text.size());
+        data.resize(data.size() + DATAGRAM_TAG_SIZE);
+        std::memcpy(data.data() + data.size() - DATAGRAM_TAG_SIZE, &tag, sizeof(tag));
+        return data;
+    }
+
+    // SipHash-2-4 的参考测试向量：密钥 00..0f，消息 00..(n-1)
+    void test_tag()
+    {
+        DatagramKey key;
+        for (size_t i = 0; i < key.size(); ++i)
+        {
+            key[i] = static_cast<uint8_t>(i);
+        }
+        uint8_t message[15];
+        for (size_t i = 0; i < sizeof(message); ++i)
+        {
+            message[i] = static_cast<uint8_t>(i);
+        }
+        expect(datagram_tag(key, message, 0) == 0x726fdb47dd0e0e31ULL, "空消息的标签与参考值一致");
+        expect(datagram_tag(key, message, 15) == 0xa129ca6149be45e5ULL, "15 字节消息的标签与参考值一致");
+    }
+
+    /**
+     * 数据报套接字之间收发：发送方发往第三方，第三方原样转发或篡改后转发给接收方。
+     * 原样转发的数据报通过认证，计数不变，由接收方按计数识别重放；篡改过的数据报被丢弃。
+     */
+    void test_socket_replay()
+    {
+        uv_loop_t loop;
+        uv_loop_init(&loop);
+        DatagramKey key{};
+        key[0] = 1;
+        constexpr uint64_t TOKEN = 0x1234;
+
+        sockaddr_in any = RawSocket::loopback(0);
+        DatagramSocket receiver(&loop);
+        receiver.bind(reinterpret_cast<const sockaddr *>(&any));
+        receiver.add_token(TOKEN, key);
+        std::vector<uint64_t> counters;
+        receiver.start([&counters](const sockaddr *, uint64_t token, uint64_t counter, const uint8_t *, size_t)
+                       {
+                           if (token == TOKEN)
+                           {
+                               counters.push_back(counter);
+                           } });
+
+        DatagramSocket sender(&loop);
+        sender.bind(reinterpret_cast<const sockaddr *>(&any));
+        RawSocket relay;
+        sockaddr_in relay_addr = RawSocket::loopback(relay.port());
+        std::vector<uint8_t> payload = {1, 2, 3};
+        expect(!sender.send(reinterpret_cast<const sockaddr *>(&relay_addr), TOKEN, PacketType::BINARY, 1,
+                            payload.data(), payload.size()),
+               "未登记的令牌不能发送");
+        sender.add_token(TOKEN, key);
+        sender.send(reinterpret_cast<const sockaddr *>(&relay_addr), TOKEN, PacketType::BINARY, 1, payload.data(), payload.size());
+        sender.flush();
+        sender.send(reinterpret_cast<const sockaddr *>(&relay_addr), TOKEN, PacketType::BINARY, 2, payload.data(), payload.size());
+        sender.flush();
+        auto first = relay.receive();
+        auto second = relay.receive();
+        expect(first.size() == DATAGRAM_OVERHEAD + sizeof(PacketHeader) + payload.size() && second.size() == first.size(),
+               "数据报含令牌、计数、消息帧和标签");
+
+        auto tampered = second;
+        tampered[DATAGRAM_TOKEN_SIZE + DATAGRAM_COUNTER_SIZE + sizeof(PacketHeader)] ^= 0xff;
+        int port = receiver.local_port();
+        relay.send_to(port, second);
+        relay.send_to(port, tampered);
+        relay.send_to(port, first);
+        relay.send_to(port, forge_datagram(0x9999, 5, "x", 0));
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (counters.size() < 2 && std::chrono::steady_clock::now() < deadline)
+        {
+            uv_run(&loop, UV_RUN_NOWAIT);
+        }
+        // 等待可能迟到的篡改数据报
+        for (int i = 0; i < 20; ++i)
+        {
+            uv_run(&loop, UV_RUN_NOWAIT);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        expect(counters == std::vector<uint64_t>({2, 1}), "篡改和未登记令牌的数据报被丢弃，重放的数据报保留原计数");
+
+        receiver.close();
+        sender.close();
+        uv_run(&loop, UV_RUN_DEFAULT);
+        uv_loop_close(&loop);
+    }
+
+    // 回环连接上的数据报通道：伪造的数据报不交付、不改变对端地址，长度上限和限流同样生效
+    void test_loopback()
+    {
+        std::mutex mutex;
+        std::vector<std::string> texts;
+        std::atomic<int> binaries{0};
+        std::atomic<uint64_t> token{0};
+        std::atomic<bool> via_datagram{false};
+        Server server;
+        server.set_max_frame_size(256);
+        RateLimit limit;
+        limit.packets_per_second = 10;
+        limit.packet_burst = 5;
+        server.set_rate_limit(PacketType::BINARY, limit);
+        server.set_packet_handler(PacketType::TEXT, [&](std::shared_ptr<Session> session, std::shared_ptr<Packet> packet)
+                                  {
+                                      token = session->datagram_token();
+                                      via_datagram = session->has_datagram();
+                                      std::lock_guard<std::mutex> lock(mutex);
+                                      texts.emplace_back(packet->data().begin(), packet->data().end());
+                                      if (texts.back() == "echo")
+                                      {
+                                          session->send_unreliable(std::make_shared<Packet>(PacketType::TEXT, packet->data()));
+                                      } });
+        server.set_packet_handler(PacketType::BINARY, [&binaries](std::shared_ptr<Session>, std::shared_ptr<Packet>)
+                                  { ++binaries; });
+        server.listen("127.0.0.1", PORT);
+        expect(server.listen_udp("127.0.0.1", UDP_PORT), "监听 UDP 端口");
+        server.start();
+
+        std::atomic<int> echoes{0};
+        Client client;
+        client.enable_datagrams();
+        client.set_packet_handler(PacketType::TEXT, [&echoes](std::shared_ptr<Packet>)
+                                  { ++echoes; });
+        client.start();
+        client.connect("127.0.0.1", PORT);
+        expect(wait_for([&client]()
+                        { return client.is_connected() && client.has_datagram(); }),
+               "建立数据报通道");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        auto text = [](const std::string &value)
+        {
+            return std::make_shared<Packet>(PacketType::TEXT, std::vector<uint8_t>(value.begin(), value.end()));
+        };
+        client.send_unreliable(text("echo"));
+        expect(wait_for([&echoes]()
+                        { return echoes == 1; }),
+               "经数据报通道往返");
+        expect(via_datagram && token != 0, "服务器经认证的数据报记录了客户端地址");
+
+        // 知道令牌但没有密钥的第三方：伪造的数据报不交付，对端地址不变
+        RawSocket attacker;
+        for (uint64_t counter = 1; counter <= 3; ++counter)
+        {
+            attacker.send_to(UDP_PORT, forge_datagram(token, 1000 + counter, "forged", counter));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        client.send_unreliable(text("echo"));
+        expect(wait_for([&echoes]()
+                        { return echoes == 2; }),
+               "伪造的数据报之后服务器仍发往客户端的地址");
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bool forged = false;
+            for (const auto &value : texts)
+            {
+                forged = forged || value == "forged";
+            }
+            expect(!forged, "伪造的数据报不交付");
+        }
+
+        // 超过长度上限的消息丢弃，会话不关闭
+        client.send_unreliable(text(std::string(1000, 'x')));
+        client.send_unreliable(text("small"));
+        expect(wait_for([&]()
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            return !texts.empty() && texts.back() == "small"; }),
+               "长度上限内的消息交付");
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            expect(texts.size() == 3, "超过长度上限的数据报消息被丢弃");
+        }
+
+        // 超出限流的数据报消息丢弃，连接的读取不暂停
+        for (int i = 0; i < 40; ++i)
+        {
+            client.send_unreliable(std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(8)));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        client.send(text("reliable"));
+        expect(wait_for([&]()
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            return texts.back() == "reliable"; },
+                        std::chrono::milliseconds(500)),
+               "数据报限流不暂停连接的读取");
+        expect(binaries >= 5 && binaries <= 8, "超出限流的数据报消息被丢弃");
+        expect(client.is_connected(), "连接保持");
+
+        client.stop();
+        server.stop();
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::info);
+
+    test_tag();
+    test_socket_replay();
+    test_loopback();
+
+    return test_util::finish();
+}
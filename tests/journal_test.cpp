@@ -0,0 +1,327 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include "libuv_net/journal.hpp"
+#include "test_util.hpp"
+#include <spdlog/spdlog.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace libuv_net;
+using test_util::expect;
+using test_util::wait_for;
+
+namespace
+{
+    constexpr int PORT = 19168;
+    constexpr size_t MESSAGE_SIZE = 100;
+    constexpr size_t RECORD_SIZE = JOURNAL_RECORD_HEADER + sizeof(PacketHeader) + MESSAGE_SIZE;
+
+    std::string test_directory(const char *name)
+    {
+        auto path = std::filesystem::temp_directory_path() /
+                    ("libuv_net-journal-test-" + std::to_string(getpid()) + "-" + name);
+        std::filesystem::remove_all(path);
+        return path.string();
+    }
+
+    // 在本线程的事件循环上打开日志，f 返回后销毁日志并等待进行中的提交完成，模拟一次进程运行
+    template <typename F>
+    void with_journal(const JournalOptions &options, F &&f)
+    {
+        uv_loop_t loop;
+        uv_loop_init(&loop);
+        {
+            auto journal = Journal::open(&loop, options);
+            expect(journal != nullptr, "打开日志");
+            if (journal)
+            {
+                f(*journal);
+            }
+        }
+        uv_run(&loop, UV_RUN_DEFAULT);
+        uv_loop_close(&loop);
+    }
+
+    uint32_t append_message(Journal &journal, uint8_t fill)
+    {
+        std::vector<uint8_t> data(MESSAGE_SIZE, fill);
+        return journal.append(PacketType::BINARY, data.data(), data.size());
+    }
+
+    // 未确认消息的序列号，同时检查消息头带持久化标志、消息体完整
+    std::vector<uint32_t> pending_sequences(const Journal &journal, bool &intact)
+    {
+        std::vector<uint32_t> sequences;
+        intact = true;
+        journal.for_each_pending([&](const uint8_t *frame, size_t size)
+                                 {
+                                     PacketHeader header;
+                                     std::memcpy(&header, frame, sizeof(header));
+                                     sequences.push_back(header.sequence);
+                                     intact = intact && size == sizeof(PacketHeader) + MESSAGE_SIZE &&
+                                              (header.flags & PACKET_FLAG_DURABLE) &&
+                                              frame[sizeof(PacketHeader)] == static_cast<uint8_t>(header.sequence); });
+        return sequences;
+    }
+
+    // 未确认就退出的消息在重新打开后仍然待发，序列号接着分配
+    void test_crash_recovery()
+    {
+        JournalOptions options{test_directory("recovery"), 4096};
+        with_journal(options, [](Journal &journal)
+                     {
+                         for (uint8_t i = 1; i <= 3; ++i)
+                         {
+                             append_message(journal, i);
+                         }
+                         journal.acknowledge(1); });
+
+        with_journal(options, [](Journal &journal)
+                     {
+                         bool intact = false;
+                         expect(pending_sequences(journal, intact) == std::vector<uint32_t>({2, 3}) && intact,
+                                "重新打开后保留未确认的消息，已确认的不再重发");
+                         expect(append_message(journal, 4) == 4, "序列号接着上次运行分配"); });
+
+        std::filesystem::remove_all(options.directory);
+    }
+
+    // 最后一条记录只写了一部分：校验和不符的记录及其之后的内容被丢弃，空出的位置重新追加
+    void test_torn_tail()
+    {
+        JournalOptions options{test_directory("torn"), 4096};
+        with_journal(options, [](Journal &journal)
+                     {
+                         for (uint8_t i = 1; i <= 3; ++i)
+                         {
+                             append_message(journal, i);
+                         } });
+
+        std::string segment;
+        for (const auto &entry : std::filesystem::directory_iterator(options.directory))
+        {
+            if (entry.path().extension() == ".seg")
+            {
+                segment = entry.path().string();
+            }
+        }
+        {
+            // 破坏第三条记录的消息体末尾
+            std::fstream file(segment, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(static_cast<std::streamoff>(3 * RECORD_SIZE - 1));
+            file.put(static_cast<char>(0xee));
+        }
+
+        with_journal(options, [](Journal &journal)
+                     {
+                         bool intact = false;
+                         expect(pending_sequences(journal, intact) == std::vector<uint32_t>({1, 2}) && intact,
+                                "丢弃写了一半的末尾记录");
+                         expect(journal.last_sequence() == 2 && append_message(journal, 3) == 3,
+                                "从被丢弃的记录处重新追加"); });
+
+        with_journal(options, [](Journal &journal)
+                     {
+                         bool intact = false;
+                         expect(pending_sequences(journal, intact) == std::vector<uint32_t>({1, 2, 3}) && intact,
+                                "重新追加的记录可以恢复"); });
+
+        std::filesystem::remove_all(options.directory);
+    }
+
+    // 确认截断日志：全部记录都已确认的段文件被删除，过期的确认不回退
+    void test_ack_truncation()
+    {
+        // 每个段文件放 4 条记录
+        JournalOptions options{test_directory("truncate"), 4 * RECORD_SIZE};
+        with_journal(options, [](Journal &journal)
+                     {
+                         for (uint8_t i = 1; i <= 10; ++i)
+                         {
+                             append_message(journal, i);
+                         }
+                         expect(journal.segment_count() == 3, "追加时滚动段文件");
+
+                         journal.acknowledge(5);
+                         bool intact = false;
+                         expect(pending_sequences(journal, intact) == std::vector<uint32_t>({6, 7, 8, 9, 10}),
+                                "确认移除不大于该序列号的消息");
+                         expect(journal.segment_count() == 2, "全部确认的段文件被删除");
+
+                         journal.acknowledge(3);
+                         expect(journal.pending_count() == 5, "过期的确认不回退");
+
+                         journal.acknowledge(8);
+                         expect(journal.pending_count() == 2 && journal.segment_count() == 1, "继续截断");
+                         journal.sync(); });
+
+        size_t segments = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(options.directory))
+        {
+            segments += entry.path().extension() == ".seg";
+        }
+        expect(segments == 1, "删除的段文件不在目录中");
+
+        with_journal(options, [](Journal &journal)
+                     {
+                         bool intact = false;
+                         expect(pending_sequences(journal, intact) == std::vector<uint32_t>({9, 10}) && intact,
+                                "确认位置在重新打开后保留");
+                         journal.acknowledge(10);
+                         expect(journal.pending_count() == 0, "全部确认"); });
+
+        std::filesystem::remove_all(options.directory);
+    }
+
+    // 直接读写帧的 TCP 连接，观察服务器答复的 ACK
+    class RawConnection
+    {
+    public:
+        RawConnection()
+        {
+            fd_ = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(PORT);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            connected_ = ::connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+            timeval timeout{0, 300000};
+            setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        }
+
+        ~RawConnection() { ::close(fd_); }
+
+        bool connected() const { return connected_; }
+
+        void send_frame(uint32_t sequence, uint8_t flags)
+        {
+            uint8_t frame[sizeof(PacketHeader) + 1] = {};
+            write_packet_header(frame, PacketType::BINARY, 1, sequence, flags);
+            ::send(fd_, frame, sizeof(frame), 0);
+        }
+
+        // 读到超时为止，返回其间收到的 ACK 携带的序列号
+        std::vector<uint32_t> receive_acks()
+        {
+            std::vector<uint32_t> acks;
+            uint8_t chunk[1024];
+            ssize_t size;
+            while ((size = recv(fd_, chunk, sizeof(chunk), 0)) > 0)
+            {
+                buffer_.insert(buffer_.end(), chunk, chunk + size);
+            }
+            size_t offset = 0;
+            while (buffer_.size() - offset >= sizeof(PacketHeader))
+            {
+                PacketHeader header;
+                std::memcpy(&header, buffer_.data() + offset, sizeof(header));
+                if (buffer_.size() - offset < sizeof(PacketHeader) + header.length)
+                {
+                    break;
+                }
+                uint32_t sequence = 0;
+                std::vector<uint8_t> payload(buffer_.begin() + offset + sizeof(PacketHeader),
+                                             buffer_.begin() + offset + sizeof(PacketHeader) + header.length);
+                if (header.type == PacketType::ACK && decode_ack(payload, sequence))
+                {
+                    acks.push_back(sequence);
+                }
+                offset += sizeof(PacketHeader) + header.length;
+            }
+            buffer_.erase(buffer_.begin(), buffer_.begin() + offset);
+            return acks;
+        }
+
+    private:
+        int fd_;
+        bool connected_;
+        std::vector<uint8_t> buffer_;
+    };
+
+    /**
+     * 服务器只确认带持久化标志的消息，答复收到过的最大序列号。
+     * 其他带序列号的消息（自带序列号的 send()、send_unreliable() 的回退、重连后重发的消息）
+     * 若也被确认，客户端会按更大的序列号截断尚未送达的持久化消息。
+     */
+    void test_durable_acks()
+    {
+        std::atomic<int> received{0};
+        Server server;
+        server.enable_acknowledgements();
+        server.set_packet_handler(PacketType::BINARY, [&received](std::shared_ptr<Session>, std::shared_ptr<Packet>)
+                                  { ++received; });
+        server.listen("127.0.0.1", PORT);
+        server.start();
+
+        {
+            RawConnection connection;
+            expect(connection.connected(), "连接服务器");
+            connection.send_frame(1000, 0);
+            expect(wait_for([&received]()
+                            { return received == 1; }),
+                   "服务器收到自带序列号的消息");
+            expect(connection.receive_acks().empty(), "不确认没有持久化标志的消息");
+
+            connection.send_frame(5, PACKET_FLAG_DURABLE);
+            expect(connection.receive_acks() == std::vector<uint32_t>({5}), "确认持久化消息");
+
+            connection.send_frame(2000, 0);
+            connection.send_frame(3, PACKET_FLAG_DURABLE);
+            expect(connection.receive_acks().empty(), "重发的旧持久化消息不使确认后退");
+
+            connection.send_frame(7, PACKET_FLAG_DURABLE);
+            expect(connection.receive_acks() == std::vector<uint32_t>({7}), "确认新的持久化消息");
+        }
+
+        // 客户端：上次运行留下的消息先重发，之后持久化发送的消息同样得到确认，自带序列号的消息不截断日志
+        JournalOptions options{test_directory("client"), 4096};
+        with_journal(options, [](Journal &journal)
+                     {
+                         for (uint8_t i = 1; i <= 3; ++i)
+                         {
+                             append_message(journal, i);
+                         } });
+
+        received = 0;
+        Client client;
+        expect(client.enable_journal(options), "客户端启用日志");
+        client.start();
+        client.connect("127.0.0.1", PORT);
+        expect(wait_for([&client, &received]()
+                        { return received == 3 && client.unacknowledged_count() == 0; }),
+               "重发上次运行未确认的消息并得到确认");
+
+        client.send(std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(8), 1000));
+        client.send_durable(std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(8)));
+        expect(wait_for([&client, &received]()
+                        { return received == 5 && client.unacknowledged_count() == 0; }),
+               "持久化发送的消息得到确认");
+
+        client.stop();
+        server.stop();
+        std::filesystem::remove_all(options.directory);
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::info);
+
+    test_crash_recovery();
+    test_torn_tail();
+    test_ack_truncation();
+    test_durable_acks();
+
+    return test_util::finish();
+}
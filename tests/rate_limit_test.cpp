@@ -0,0 +1,203 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include "libuv_net/rate_limit.hpp"
+#include "test_util.hpp"
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace libuv_net;
+using test_util::expect;
+using test_util::wait_for;
+
+namespace
+{
+    constexpr int PORT = 19162;
+    using Clock = TokenBucket::Clock;
+
+    // 令牌桶的补充、透支和等待时间，时间点由测试给定
+    void test_token_bucket()
+    {
+        auto start = Clock::now();
+
+        TokenBucket unlimited;
+        unlimited.consume(1e9);
+        expect(!unlimited.limited() && unlimited.available() && unlimited.wait_time() == Clock::duration::zero(),
+               "速率为 0 时不限制");
+
+        // 突发容量为 0 时取一秒的速率
+        TokenBucket bucket(10, 0, start);
+        int admitted = 0;
+        while (bucket.available())
+        {
+            bucket.consume(1);
+            ++admitted;
+        }
+        expect(admitted == 10, "初始令牌数为一秒的速率");
+
+        // 透支：剩余 1 个令牌时一次消耗 5 个，之后要等令牌补回正数
+        TokenBucket overdraft(10, 1, start);
+        overdraft.refill(start);
+        overdraft.consume(5);
+        expect(!overdraft.available(), "透支后不再放行");
+        auto wait = overdraft.wait_time();
+        expect(wait > std::chrono::milliseconds(400) && wait <= std::chrono::milliseconds(402), "等待时间按透支量和速率计算");
+        overdraft.refill(start + std::chrono::milliseconds(390));
+        expect(!overdraft.available(), "令牌补回正数前仍不放行");
+        overdraft.refill(start + std::chrono::milliseconds(410));
+        expect(overdraft.available(), "令牌补回正数后放行");
+
+        // 补充不超过突发容量
+        TokenBucket capped(100, 3, start);
+        capped.refill(start + std::chrono::seconds(10));
+        int burst = 0;
+        while (capped.available())
+        {
+            capped.consume(1);
+            ++burst;
+        }
+        expect(burst == 3, "补充的令牌不超过突发容量");
+    }
+
+    // 消息数和字节数任一超限都不放行
+    void test_rate_buckets()
+    {
+        auto start = Clock::now();
+        RateLimit limit;
+        limit.packets_per_second = 100;
+        limit.bytes_per_second = 1000;
+        limit.byte_burst = 1000;
+        RateBuckets buckets(limit, start);
+
+        expect(buckets.available(start), "初始时放行");
+        buckets.consume(1, 1500);
+        expect(!buckets.available(start), "字节数透支后不放行，即使消息数还有余量");
+        auto wait = buckets.wait_time();
+        expect(wait > std::chrono::milliseconds(500) && wait <= std::chrono::milliseconds(502), "等待时间取各桶中最长的");
+        expect(buckets.available(start + std::chrono::milliseconds(502)), "字节数令牌补回后放行");
+    }
+
+    // 超出限额的会话暂停读取，消息不丢失，只是延后到令牌补足后处理
+    void test_session_limit()
+    {
+        std::atomic<int> received{0};
+        Server server;
+        RateLimit limit;
+        limit.packets_per_second = 20;
+        limit.packet_burst = 5;
+        server.set_rate_limit(limit);
+        server.set_packet_handler(PacketType::BINARY, [&received](std::shared_ptr<Session>, std::shared_ptr<Packet>)
+                                  { ++received; });
+        server.listen("127.0.0.1", PORT);
+        server.start();
+
+        Client client;
+        client.start();
+        client.connect("127.0.0.1", PORT);
+        expect(wait_for([&client]()
+                        { return client.is_connected(); }),
+               "连接服务器");
+
+        constexpr int MESSAGES = 25;
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < MESSAGES; ++i)
+        {
+            client.send(std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(16)));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        int early = received;
+        expect(early >= 5 && early <= 13, "300 毫秒内只处理突发容量加补充的令牌数");
+
+        bool all = wait_for([&received]()
+                            { return received == MESSAGES; },
+                            std::chrono::milliseconds(5000));
+        auto elapsed = std::chrono::steady_clock::now() - begin;
+        expect(all, "暂停读取的消息在令牌补足后全部处理，不丢失");
+        expect(elapsed >= std::chrono::milliseconds(900), "全部处理的时间不短于限额允许的速率");
+
+        client.stop();
+        server.stop();
+    }
+
+    // 服务器运行期间从其他线程设置、替换和取消共享的限流
+    void test_global_limit_at_runtime()
+    {
+        std::atomic<int> received{0};
+        Server server;
+        server.set_packet_handler(PacketType::BINARY, [&received](std::shared_ptr<Session>, std::shared_ptr<Packet>)
+                                  { ++received; });
+        server.listen("127.0.0.1", PORT + 1);
+        server.start();
+
+        std::vector<std::unique_ptr<Client>> clients;
+        for (int i = 0; i < 2; ++i)
+        {
+            clients.push_back(std::make_unique<Client>());
+            clients.back()->start();
+            clients.back()->connect("127.0.0.1", PORT + 1);
+        }
+        expect(wait_for([&clients]()
+                        { return clients[0]->is_connected() && clients[1]->is_connected(); }),
+               "两个客户端连接服务器");
+
+        // 事件循环线程处理消息期间，另一个线程不断设置和取消共享的限流
+        RateLimit limit;
+        limit.packets_per_second = 10;
+        limit.packet_burst = 4;
+        std::atomic<bool> replacing{true};
+        std::thread replacer([&server, &replacing, limit]()
+                             {
+                                 for (int i = 0; replacing; ++i)
+                                 {
+                                     server.set_global_rate_limit(i % 2 ? limit : RateLimit{});
+                                 } });
+        for (int i = 0; i < 20; ++i)
+        {
+            clients[i % 2]->send(std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(16)));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        replacing = false;
+        replacer.join();
+        server.set_global_rate_limit(RateLimit{});
+        expect(wait_for([&received]()
+                        { return received == 20; }),
+               "运行期间替换共享的限流，取消后消息全部处理");
+
+        // 共享的令牌桶对两个会话合计生效：各自限流时 300 毫秒内可处理约 2 * (4 + 3) 个
+        server.set_global_rate_limit(limit);
+        for (int i = 0; i < 20; ++i)
+        {
+            clients[i % 2]->send(std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(16)));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        int limited = received - 20;
+        expect(limited >= 4 && limited <= 10, "共享的限流对所有会话合计生效");
+
+        // 取消限流后暂停的会话在定时器到期时恢复
+        server.set_global_rate_limit(RateLimit{});
+        expect(wait_for([&received]()
+                        { return received == 40; }),
+               "取消共享的限流后剩余消息全部处理");
+
+        for (auto &client : clients)
+        {
+            client->stop();
+        }
+        server.stop();
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::info);
+
+    test_token_bucket();
+    test_rate_buckets();
+    test_session_limit();
+    test_global_limit_at_runtime();
+
+    return test_util::finish();
+}
@@ -0,0 +1,244 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include "libuv_net/reconnect.hpp"
+#include "test_util.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace libuv_net;
+using test_util::expect;
+using test_util::wait_for;
+
+namespace
+{
+    constexpr uint16_t PORT = 19169;
+
+    std::shared_ptr<Packet> sequenced(uint32_t sequence, size_t size = 8)
+    {
+        return std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(size, static_cast<uint8_t>(sequence)),
+                                        sequence);
+    }
+
+    std::vector<uint32_t> queued_sequences(const ReplayQueue &queue)
+    {
+        std::vector<uint32_t> sequences;
+        queue.for_each([&sequences](const std::shared_ptr<Packet> &packet)
+                       { sequences.push_back(packet->sequence()); });
+        return sequences;
+    }
+
+    // 不加抖动时等待时间按倍数增长到上限，reset() 后从头开始
+    void test_backoff_growth()
+    {
+        ReconnectOptions options;
+        options.initial_delay = std::chrono::milliseconds(100);
+        options.max_delay = std::chrono::milliseconds(1000);
+        options.multiplier = 2.0;
+        options.jitter = 0.0;
+        Backoff backoff(options);
+
+        std::vector<int64_t> delays;
+        for (int i = 0; i < 6; ++i)
+        {
+            delays.push_back(backoff.next_delay().count());
+        }
+        expect(delays == std::vector<int64_t>({100, 200, 400, 800, 1000, 1000}), "等待时间按倍数增长到上限");
+        expect(backoff.attempts() == 6, "记录重连次数");
+
+        backoff.reset();
+        expect(backoff.attempts() == 0 && backoff.next_delay().count() == 100, "reset() 恢复初始等待时间");
+    }
+
+    // 抖动后的等待时间落在 [d × (1 - jitter), d] 内，并且确实分散开
+    void test_backoff_jitter()
+    {
+        ReconnectOptions options;
+        options.initial_delay = std::chrono::milliseconds(1000);
+        options.max_delay = std::chrono::milliseconds(1000);
+        options.jitter = 0.5;
+
+        bool within = true;
+        int64_t low = options.max_delay.count();
+        int64_t high = 0;
+        for (int i = 0; i < 1000; ++i)
+        {
+            Backoff backoff(options);
+            int64_t delay = backoff.next_delay().count();
+            within = within && delay >= 500 && delay <= 1000;
+            low = std::min(low, delay);
+            high = std::max(high, delay);
+        }
+        expect(within, "抖动后的等待时间不超出范围");
+        expect(low < 600 && high > 900, "抖动覆盖整个范围");
+
+        // 超出 [0, 1] 的抖动按边界处理
+        options.jitter = 2.0;
+        Backoff backoff(options);
+        within = true;
+        for (int i = 0; i < 100; ++i)
+        {
+            int64_t delay = backoff.next_delay().count();
+            within = within && delay >= 0 && delay <= 1000;
+        }
+        expect(within, "抖动比例大于 1 时等待时间不为负");
+    }
+
+    // push() 在消息数或字节数达到上限时拒绝新消息
+    void test_queue_limits()
+    {
+        constexpr size_t FRAME = sizeof(PacketHeader) + 8;
+
+        ReplayQueue by_count(3, 1024);
+        for (uint32_t i = 1; i <= 3; ++i)
+        {
+            by_count.push(sequenced(i));
+        }
+        expect(!by_count.push(sequenced(4)), "超出消息数上限时拒绝");
+        expect(queued_sequences(by_count) == std::vector<uint32_t>({1, 2, 3}) && by_count.bytes() == 3 * FRAME,
+               "已缓存的消息保留");
+
+        ReplayQueue by_bytes(100, 2 * FRAME + 1);
+        expect(by_bytes.push(sequenced(1)) && by_bytes.push(sequenced(2)), "字节数上限内追加");
+        expect(!by_bytes.push(sequenced(3)), "超出字节数上限时拒绝");
+        expect(!by_bytes.push(std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>())),
+               "消息头计入字节数，剩余空间不足一个消息头时仍拒绝");
+        expect(by_bytes.size() == 2 && by_bytes.bytes() == 2 * FRAME, "拒绝的消息不计入");
+
+        by_bytes.clear();
+        expect(by_bytes.empty() && by_bytes.bytes() == 0, "clear() 清空计数");
+    }
+
+    // push_evicting() 丢弃最早的消息腾出空间，字节数随之更新
+    void test_queue_eviction()
+    {
+        constexpr size_t FRAME = sizeof(PacketHeader) + 8;
+
+        ReplayQueue by_count(3, 1024);
+        for (uint32_t i = 1; i <= 5; ++i)
+        {
+            by_count.push_evicting(sequenced(i));
+        }
+        expect(queued_sequences(by_count) == std::vector<uint32_t>({3, 4, 5}) && by_count.bytes() == 3 * FRAME,
+               "超出消息数上限时丢弃最早的消息");
+
+        ReplayQueue by_bytes(100, 3 * FRAME);
+        for (uint32_t i = 1; i <= 3; ++i)
+        {
+            by_bytes.push_evicting(sequenced(i));
+        }
+        by_bytes.push_evicting(sequenced(4, 8 + FRAME));
+        expect(queued_sequences(by_bytes) == std::vector<uint32_t>({3, 4}) && by_bytes.bytes() == 3 * FRAME,
+               "超出字节数上限时丢弃足够多的旧消息");
+
+        by_bytes.push_evicting(sequenced(5, 3 * FRAME));
+        expect(queued_sequences(by_bytes) == std::vector<uint32_t>({3, 4}), "单个超过上限的消息不追加，也不清空队列");
+
+        // 编码后的帧按入队顺序排列，带原有的序列号
+        std::vector<uint8_t> frames;
+        by_count.append_frames(frames);
+        bool ordered = frames.size() == 3 * FRAME;
+        for (uint32_t i = 0; ordered && i < 3; ++i)
+        {
+            PacketHeader header;
+            std::memcpy(&header, frames.data() + i * FRAME, sizeof(header));
+            ordered = header.sequence == 3 + i && header.length == 8 && header.flags == 0 &&
+                      frames[i * FRAME + sizeof(PacketHeader)] == 3 + i;
+        }
+        expect(ordered, "append_frames() 按顺序编码");
+    }
+
+    /**
+     * 服务器重启后客户端自动重连：断开前发出的带序列号消息先重发，
+     * 之后是断开期间缓存的消息，整体保持发送顺序。
+     */
+    void test_replay_order()
+    {
+        std::mutex mutex;
+        std::vector<uint32_t> received;
+        auto make_server = [&]()
+        {
+            auto server = std::make_unique<Server>();
+            server->set_packet_handler(PacketType::BINARY, [&](std::shared_ptr<Session>, std::shared_ptr<Packet> packet)
+                                       {
+                                           std::lock_guard<std::mutex> lock(mutex);
+                                           received.push_back(packet->sequence()); });
+            server->listen("127.0.0.1", PORT);
+            server->start();
+            return server;
+        };
+        auto received_count = [&]()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return received.size();
+        };
+
+        auto server = make_server();
+        Client client;
+        ReconnectOptions options;
+        options.initial_delay = std::chrono::milliseconds(50);
+        options.max_delay = std::chrono::milliseconds(200);
+        options.jitter = 0.0;
+        options.max_queued_packets = 3;
+        options.replay_sequenced = true;
+        client.set_reconnect(options);
+        client.start();
+        client.connect("127.0.0.1", PORT);
+        expect(wait_for([&client]()
+                        { return client.is_connected(); }),
+               "连接服务器");
+
+        // 只保留最近 3 个发出的带序列号消息
+        for (uint32_t i = 1; i <= 4; ++i)
+        {
+            client.send(sequenced(i));
+        }
+        expect(wait_for([&]()
+                        { return received_count() == 4; }),
+               "服务器收到断开前的消息");
+
+        server.reset();
+        expect(wait_for([&client]()
+                        { return !client.is_connected(); }),
+               "服务器停止后连接断开");
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            received.clear();
+        }
+        for (uint32_t i = 5; i <= 8; ++i)
+        {
+            client.send(sequenced(i));
+        }
+        expect(client.queued_count() == 3, "断开期间缓存的消息不超过上限");
+
+        server = make_server();
+        expect(wait_for([&]()
+                        { return received_count() == 6; }),
+               "重连后发出重发和缓存的消息");
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            expect(received == std::vector<uint32_t>({2, 3, 4, 5, 6, 7}), "先重发断开前的消息，再按顺序发出缓存的消息");
+        }
+
+        client.stop();
+        server.reset();
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::info);
+
+    test_backoff_growth();
+    test_backoff_jitter();
+    test_queue_limits();
+    test_queue_eviction();
+    test_replay_order();
+
+    return test_util::finish();
+}
@@ -0,0 +1,148 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include "libuv_net/resolver.hpp"
+#include "test_util.hpp"
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace libuv_net;
+using test_util::expect;
+using test_util::wait_for;
+
+namespace
+{
+    constexpr int PORT = 19160;
+
+    sockaddr_storage address(const char *ip)
+    {
+        sockaddr_storage addr{};
+        parse_ip_address(ip, 0, addr);
+        return addr;
+    }
+
+    // IPv6 和 IPv4 交替，同一协议族内保持原顺序
+    void test_interleave()
+    {
+        auto ordered = interleave_addresses({address("::1"), address("::2"), address("10.0.0.1"), address("10.0.0.2")});
+        expect(ordered.size() == 4 && ordered[0].ss_family == AF_INET6 && ordered[1].ss_family == AF_INET &&
+                   ordered[2].ss_family == AF_INET6 && ordered[3].ss_family == AF_INET,
+               "地址按协议族交替排列");
+    }
+
+    // 在独立的事件循环上检查查询合并、缓存时间、取消和解析器销毁后迟到的回调
+    void test_resolver()
+    {
+        uv_loop_t loop;
+        uv_loop_init(&loop);
+
+        int lookups = 0;
+        std::vector<Resolver::Callback> pending;
+        auto resolver = std::make_unique<Resolver>(&loop);
+        resolver->set_lookup([&](const std::string &, Resolver::Callback done)
+                             {
+                                 ++lookups;
+                                 pending.push_back(std::move(done)); });
+
+        // 同一主机名同时发起的解析合并为一次查询，各自得到自己的端口
+        std::vector<uint16_t> ports;
+        auto record = [&ports](int status, std::vector<sockaddr_storage> addresses)
+        {
+            if (status == 0 && addresses.size() == 1)
+            {
+                ports.push_back(ntohs(reinterpret_cast<sockaddr_in *>(&addresses[0])->sin_port));
+            }
+        };
+        resolver->resolve("stub.test", 1000, record);
+        resolver->resolve("stub.test", 2000, record);
+        expect(lookups == 1, "同时发起的解析合并为一次查询");
+        pending.back()(0, {address("127.0.0.1")});
+        pending.clear();
+        expect(ports == std::vector<uint16_t>{1000, 2000}, "等待的调用者各自得到填入端口的结果");
+
+        // TTL 内命中缓存，同步返回
+        resolver->resolve("stub.test", 3000, record);
+        expect(lookups == 1 && ports.size() == 3 && ports[2] == 3000, "TTL 内的解析命中缓存");
+
+        // 缓存时间为 0 时每次都查询
+        resolver->set_ttl(std::chrono::milliseconds(0));
+        resolver->clear_cache();
+        resolver->resolve("nocache.test", 1, record);
+        pending.back()(0, {address("127.0.0.1")});
+        resolver->resolve("nocache.test", 1, record);
+        expect(lookups == 3, "缓存时间为 0 时不缓存");
+        pending.back()(0, {address("127.0.0.1")});
+        pending.clear();
+
+        // 取消后迟到的结果被丢弃
+        size_t before = ports.size();
+        resolver->resolve("cancel.test", 1, record);
+        resolver->cancel();
+        pending.back()(0, {address("127.0.0.1")});
+        pending.clear();
+        expect(ports.size() == before, "取消后不再执行回调");
+
+        // 解析器销毁后查询才完成，回调被忽略而不访问已释放的解析器
+        resolver->resolve("late.test", 1, record);
+        resolver.reset();
+        pending.back()(0, {address("127.0.0.1")});
+        pending.clear();
+        expect(ports.size() == before, "解析器销毁后迟到的回调被忽略");
+
+        uv_run(&loop, UV_RUN_DEFAULT);
+        uv_loop_close(&loop);
+    }
+
+    // 查询返回一个无法连接的地址和 127.0.0.1，客户端应回退到后者，再次连接时命中缓存
+    void test_fallback()
+    {
+        Server server;
+        server.listen("127.0.0.1", PORT);
+        server.start();
+
+        std::atomic<int> lookups{0};
+        Client client;
+        client.resolver().set_lookup([&lookups](const std::string &, Resolver::Callback done)
+                                     {
+                                         ++lookups;
+                                         // 100::/64 是只丢弃的 IPv6 前缀，连接不会完成或立即失败
+                                         done(0, {address("100::1"), address("127.0.0.1")}); });
+        client.start();
+
+        auto begin = std::chrono::steady_clock::now();
+        expect(client.connect("stub.test", PORT), "发起连接");
+        bool connected = wait_for([&client]()
+                                  { return client.is_connected(); });
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+        expect(connected, "第一个地址不可用时回退到 127.0.0.1");
+        expect(elapsed < std::chrono::milliseconds(2000), "回退在并行尝试的间隔内完成，不等待连接超时");
+        spdlog::info("连接耗时 {} 毫秒", elapsed.count());
+
+        // 断开后在 TTL 内再次连接
+        client.disconnect();
+        bool reconnected = wait_for([&client]()
+                                    { return client.connect("stub.test", PORT); }) &&
+                           wait_for([&client]()
+                                    { return client.is_connected(); });
+        expect(reconnected, "再次连接成功");
+        expect(lookups == 1, "TTL 内的第二次连接命中缓存，不再查询");
+
+        client.stop();
+        server.stop();
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::info);
+
+    test_interleave();
+    test_resolver();
+    test_fallback();
+
+    return test_util::finish();
+}
@@ -0,0 +1,278 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include "libuv_net/shm_channel.hpp"
+#include "test_util.hpp"
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace libuv_net;
+using test_util::expect;
+using test_util::wait_for;
+
+namespace
+{
+    constexpr const char *SOCKET_PATH = "@libuv_net-shm-test";
+
+    // 独立内存上的环形缓冲区，容量为 2 的幂
+    struct LocalRing
+    {
+        explicit LocalRing(size_t capacity) : data(capacity), ring(&header, data.data(), capacity) {}
+
+        ShmRingHeader header{};
+        std::vector<uint8_t> data;
+        ShmRing ring;
+    };
+
+    // 模拟套接字上的通知：计数的信号量，多余的通知无害
+    class Doorbell
+    {
+    public:
+        void ring()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++count_;
+            cv_.notify_one();
+        }
+
+        // 超时说明通知丢失
+        bool wait(std::chrono::milliseconds timeout)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!cv_.wait_for(lock, timeout, [this]()
+                              { return count_ > 0; }))
+            {
+                return false;
+            }
+            --count_;
+            return true;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        int count_ = 0;
+    };
+
+    // 读写跨越缓冲区末尾，写满后不再写入
+    void test_ring_wrap()
+    {
+        LocalRing local(16);
+        ShmRing &ring = local.ring;
+        expect(ring.empty(), "新缓冲区为空");
+
+        const uint8_t first[12] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+        expect(ring.write(first, sizeof(first)) == 12, "写入 12 字节");
+        ring.consume(10);
+
+        const uint8_t second[10] = {13, 14, 15, 16, 17, 18, 19, 20, 21, 22};
+        expect(ring.write(second, sizeof(second)) == 10, "跨越末尾写入");
+        expect(ring.write(second, sizeof(second)) == 4, "只写入剩余的空间");
+        expect(ring.write(second, 1) == 0, "写满后不再写入");
+
+        std::vector<uint8_t> read;
+        while (!ring.empty())
+        {
+            auto [data, size] = ring.peek();
+            read.insert(read.end(), data, data + size);
+            ring.consume(size);
+        }
+        const std::vector<uint8_t> expected = {11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 13, 14, 15, 16};
+        expect(read == expected, "跨越末尾的数据按顺序读出");
+    }
+
+    /**
+     * 两个线程按会话的等待标志协议收发：缓冲区空或满时先设置标志再检查一次，
+     * 对方在状态变化后取走标志并通知。通知丢失时等待超时，测试失败。
+     */
+    void test_ring_wakeup()
+    {
+        constexpr uint64_t TOTAL = 4 * 1024 * 1024;
+        constexpr auto TIMEOUT = std::chrono::milliseconds(2000);
+        LocalRing local(256);
+        ShmRing &ring = local.ring;
+        Doorbell reader_bell;
+        Doorbell writer_bell;
+        std::atomic<bool> lost{false};
+        bool ordered = true;
+
+        std::thread writer([&]()
+                           {
+                               uint8_t chunk[97];
+                               uint64_t written = 0;
+                               bool waiting = false;
+                               while (written < TOTAL && !lost)
+                               {
+                                   size_t size = static_cast<size_t>(std::min<uint64_t>(sizeof(chunk), TOTAL - written));
+                                   for (size_t i = 0; i < size; ++i)
+                                   {
+                                       chunk[i] = static_cast<uint8_t>(written + i);
+                                   }
+                                   size_t count = ring.write(chunk, size);
+                                   written += count;
+                                   if (ring.take_reader_waiting())
+                                   {
+                                       reader_bell.ring();
+                                   }
+                                   if (count > 0)
+                                   {
+                                       waiting = false;
+                                       continue;
+                                   }
+                                   if (!waiting)
+                                   {
+                                       ring.set_writer_waiting(true);
+                                       waiting = true;
+                                       continue;
+                                   }
+                                   waiting = false;
+                                   if (!writer_bell.wait(TIMEOUT))
+                                   {
+                                       lost = true;
+                                   }
+                               } });
+
+        uint64_t read = 0;
+        while (read < TOTAL && !lost)
+        {
+            auto [data, size] = ring.peek();
+            if (size == 0)
+            {
+                ring.set_reader_waiting(true);
+                if (ring.empty())
+                {
+                    if (!reader_bell.wait(TIMEOUT))
+                    {
+                        lost = true;
+                    }
+                    continue;
+                }
+                ring.set_reader_waiting(false);
+                continue;
+            }
+            for (size_t i = 0; i < size && ordered; ++i)
+            {
+                ordered = data[i] == static_cast<uint8_t>(read + i);
+            }
+            read += size;
+            ring.consume(size);
+            if (ring.take_writer_waiting())
+            {
+                writer_bell.ring();
+            }
+        }
+        writer.join();
+
+        expect(!lost, "等待标志协议不丢失通知");
+        expect(read == TOTAL && ordered, "全部数据按顺序到达");
+    }
+
+    // 段名称随机且不重复，只有名称、所有者都与对端一致时才能打开
+    void test_channel_open()
+    {
+        auto channel = ShmChannel::create(4096);
+        auto other = ShmChannel::create(4096);
+        expect(channel && other, "创建共享内存段");
+        if (!channel || !other)
+        {
+            return;
+        }
+
+        std::string prefix = "/libuv_net-" + std::to_string(getpid()) + "-";
+        expect(channel->name().compare(0, prefix.size(), prefix) == 0 && channel->name().size() == prefix.size() + 32,
+               "名称为进程 ID 加 128 位随机数");
+        std::set<std::string> names;
+        for (int i = 0; i < 64; ++i)
+        {
+            auto segment = ShmChannel::create(4096);
+            if (segment)
+            {
+                names.insert(segment->name());
+            }
+        }
+        expect(names.size() == 64, "名称不重复");
+
+        uint32_t uid = static_cast<uint32_t>(getuid());
+        expect(!ShmChannel::open(channel->name(), channel->ring_size(), getpid() + 1, uid), "名称中的进程 ID 与对端不符时拒绝");
+        expect(!ShmChannel::open(channel->name(), channel->ring_size(), getpid(), uid + 1), "段的所有者与对端不符时拒绝");
+        expect(!ShmChannel::open("/dev/shm/../x", channel->ring_size(), getpid(), uid), "格式不符的名称被拒绝");
+        expect(!ShmChannel::open(channel->name(), channel->ring_size() * 2, getpid(), uid), "大小不符时拒绝");
+
+        auto peer = ShmChannel::open(channel->name(), channel->ring_size(), getpid(), uid);
+        expect(peer != nullptr, "名称和所有者与对端一致时打开");
+        if (peer)
+        {
+            const uint8_t byte = 42;
+            channel->tx().write(&byte, 1);
+            auto [data, size] = peer->rx().peek();
+            expect(size == 1 && data[0] == byte, "发起方写入的数据由接受方读出");
+        }
+
+        other->unlink();
+        expect(!ShmChannel::open(other->name(), other->ring_size(), getpid(), uid), "删除名称后无法打开");
+    }
+
+    // 回环连接上协商共享内存传输并收发消息
+    void test_loopback()
+    {
+        std::atomic<int> received{0};
+        std::atomic<bool> shared{true};
+        Server server;
+        server.enable_shared_memory(ShmOptions{true});
+        server.set_packet_handler(PacketType::BINARY, [&](std::shared_ptr<Session> session, std::shared_ptr<Packet> packet)
+                                  {
+                                      shared = shared && session->is_shared_memory();
+                                      session->send(packet); });
+        expect(server.listen_unix(SOCKET_PATH), "监听 Unix 域套接字");
+        server.start();
+
+        Client client;
+        client.set_shared_memory(ShmOptions{true});
+        client.set_packet_handler(PacketType::BINARY, [&](std::shared_ptr<Packet> packet)
+                                  {
+                                      if (packet->data().size() == 64 * 1024 && packet->data()[0] == 7)
+                                      {
+                                          ++received;
+                                      } });
+        client.start();
+        client.connect_unix(SOCKET_PATH);
+        expect(wait_for([&client]()
+                        { return client.is_connected(); }),
+               "连接服务器");
+        // 协商完成前的消息仍经套接字发送，等握手结束后再检查传输方式
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        constexpr int MESSAGES = 64;
+        for (int i = 0; i < MESSAGES; ++i)
+        {
+            client.send(std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(64 * 1024, 7)));
+        }
+        expect(wait_for([&received]()
+                        { return received == MESSAGES; }),
+               "超过环形缓冲区容量的消息全部往返");
+        expect(shared, "服务器经共享内存收到消息");
+
+        client.stop();
+        server.stop();
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::info);
+
+    test_ring_wrap();
+    test_ring_wakeup();
+    test_channel_open();
+    test_loopback();
+
+    return test_util::finish();
+}
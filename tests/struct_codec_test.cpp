@@ -0,0 +1,208 @@
+#include "libuv_net/server.hpp"
+#include "libuv_net/client.hpp"
+#include "libuv_net/struct_codec.hpp"
+#include "test_util.hpp"
+#include <spdlog/spdlog.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+using namespace libuv_net;
+using test_util::expect;
+using test_util::wait_for;
+
+namespace test
+{
+    enum class Side : uint16_t
+    {
+        BUY = 1,
+        SELL = 0x0201
+    };
+
+    struct Level
+    {
+        int32_t price;
+        uint16_t volume;
+    };
+
+    struct Quote
+    {
+        int64_t price;
+        uint32_t volume;
+        Side side;
+        bool active;
+        double ratio;
+        std::array<char, 4> symbol;
+        std::array<uint16_t, 2> counts;
+        Level best;
+    };
+
+    // LIBUV_NET_STRUCT 支持的最多字段数
+    struct Wide
+    {
+        uint8_t f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16;
+    };
+
+    bool operator==(const Level &a, const Level &b)
+    {
+        return a.price == b.price && a.volume == b.volume;
+    }
+
+    bool operator==(const Quote &a, const Quote &b)
+    {
+        return a.price == b.price && a.volume == b.volume && a.side == b.side && a.active == b.active &&
+               a.ratio == b.ratio && a.symbol == b.symbol && a.counts == b.counts && a.best == b.best;
+    }
+}
+
+LIBUV_NET_STRUCT(test::Level, price, volume)
+LIBUV_NET_STRUCT(test::Quote, price, volume, side, active, ratio, symbol, counts, best)
+LIBUV_NET_STRUCT(test::Wide, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16)
+
+namespace
+{
+    constexpr int PORT = 19161;
+
+    test::Quote sample()
+    {
+        return test::Quote{-0x0102030405060708LL, 0x0a0b0c0d, test::Side::SELL, true, 0.5,
+                           {'A', 'B', 'C', 'D'}, {0x1122, 0x3344}, {-2, 0x5566}};
+    }
+
+    // 编码长度为字段大小之和，不含对齐填充
+    static_assert(StructCodec<test::Level>::SIZE == 6, "Level 的编码长度");
+    static_assert(StructCodec<test::Quote>::SIZE == 8 + 4 + 2 + 1 + 8 + 4 + 4 + 6, "Quote 的编码长度");
+    static_assert(StructCodec<test::Wide>::SIZE == 16, "16 个字段都参与编码");
+    static_assert(std::tuple_size<decltype(StructFields<test::Wide>::members())>::value == 16, "宏展开出 16 个成员指针");
+
+    void test_round_trip()
+    {
+        auto quote = sample();
+        std::vector<uint8_t> out;
+        expect(Codec<test::Quote>::encode(quote, out) && out.size() == StructCodec<test::Quote>::SIZE,
+               "编码长度等于 SIZE");
+
+        test::Quote decoded{};
+        expect(Codec<test::Quote>::decode(out.data(), out.size(), decoded) && decoded == quote, "编码后解码得到原值");
+
+        // 直接编码到定长缓冲区
+        std::array<uint8_t, StructCodec<test::Quote>::SIZE> fixed{};
+        StructCodec<test::Quote>::write(quote, fixed);
+        expect(std::equal(fixed.begin(), fixed.end(), out.begin()), "写入定长缓冲区与写入 vector 的结果相同");
+
+        // 长度不符时解码失败，缓冲区不足时编码失败
+        expect(!Codec<test::Quote>::decode(out.data(), out.size() - 1, decoded), "消息体过短时解码失败");
+        out.push_back(0);
+        expect(!Codec<test::Quote>::decode(out.data(), out.size(), decoded), "消息体过长时解码失败");
+        expect(!Codec<test::Quote>::encode_to(quote, fixed.data(), fixed.size() - 1), "缓冲区不足时编码失败");
+
+        test::Wide wide{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+        std::vector<uint8_t> wide_out;
+        Codec<test::Wide>::encode(wide, wide_out);
+        bool ordered = wide_out.size() == 16;
+        for (size_t i = 0; ordered && i < wide_out.size(); ++i)
+        {
+            ordered = wide_out[i] == i + 1;
+        }
+        expect(ordered, "16 个字段按声明顺序编码");
+    }
+
+    // 线路格式与主机字节序无关：多字节字段按小端序、按声明顺序紧凑排列
+    void test_wire_layout()
+    {
+        std::vector<uint8_t> out;
+        Codec<test::Quote>::encode(sample(), out);
+        const std::vector<uint8_t> expected = {
+            0xf8, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, // price = -0x0102030405060708
+            0x0d, 0x0c, 0x0b, 0x0a,                         // volume
+            0x01, 0x02,                                     // side = 0x0201
+            0x01,                                           // active
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0x3f, // ratio = 0.5
+            'A', 'B', 'C', 'D',                             // symbol
+            0x22, 0x11, 0x44, 0x33,                         // counts
+            0xfe, 0xff, 0xff, 0xff, 0x66, 0x55,             // best
+        };
+        expect(out == expected, "多字节字段按小端序编码，字段之间没有填充");
+
+        // 非 0 的布尔字节解码为 true
+        out[14] = 0x7f;
+        test::Quote decoded{};
+        expect(Codec<test::Quote>::decode(out.data(), out.size(), decoded) && decoded.active, "非 0 的布尔字节解码为 true");
+    }
+
+    // 大端主机上使用的逐字节反转
+    void test_byte_swap()
+    {
+        uint32_t value = 0x01020304;
+        uint8_t swapped[sizeof(value)];
+        detail::store_bytes<true>(&value, swapped, sizeof(value));
+        uint8_t raw[sizeof(value)];
+        std::memcpy(raw, &value, sizeof(value));
+        expect(swapped[0] == raw[3] && swapped[1] == raw[2] && swapped[2] == raw[1] && swapped[3] == raw[0],
+               "反转写入颠倒字节顺序");
+
+        uint32_t restored = 0;
+        detail::load_bytes<true>(swapped, &restored, sizeof(restored));
+        expect(restored == value, "反转读取还原原值");
+
+        uint8_t copied[sizeof(value)];
+        detail::store_bytes<false>(&value, copied, sizeof(value));
+        expect(std::memcmp(copied, raw, sizeof(value)) == 0, "不反转时按主机字节序拷贝");
+    }
+
+    // 经类型化的 send<Type>() 和 on<Type>() 在回环连接上收发
+    void test_loopback()
+    {
+        std::mutex mutex;
+        std::vector<test::Quote> received;
+        Server server;
+        server.on<PacketType::BINARY>([&](Session &, const test::Quote &quote)
+                                      {
+                                          std::lock_guard<std::mutex> lock(mutex);
+                                          received.push_back(quote); });
+        server.listen("127.0.0.1", PORT);
+        server.start();
+
+        Client client;
+        client.start();
+        client.connect("127.0.0.1", PORT);
+        expect(wait_for([&client]()
+                        { return client.is_connected(); }),
+               "连接服务器");
+
+        auto quote = sample();
+        client.send<PacketType::BINARY>(quote);
+        // 长度不符的消息体在解码校验时被丢弃
+        client.send(std::make_shared<Packet>(PacketType::BINARY, std::vector<uint8_t>(3)));
+        quote.volume = 7;
+        client.send<PacketType::BINARY>(quote);
+
+        bool done = wait_for([&]()
+                             {
+                                 std::lock_guard<std::mutex> lock(mutex);
+                                 return received.size() >= 2; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            expect(done && received.size() == 2, "服务器收到两个结构体，丢弃长度不符的消息");
+            expect(done && received[0] == sample() && received[1] == quote, "收到的结构体与发送的相同");
+        }
+
+        client.stop();
+        server.stop();
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::info);
+
+    test_round_trip();
+    test_wire_layout();
+    test_byte_swap();
+    test_loopback();
+
+    return test_util::finish();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <thread>
+
+// 测试程序共用的检查和等待函数：检查失败时记录并继续，main() 以 test_util::finish() 的结果退出
+namespace test_util
+{
+    inline int &failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline void expect(bool condition, const char *what)
+    {
+        if (condition)
+        {
+            spdlog::info("通过: {}", what);
+        }
+        else
+        {
+            spdlog::error("失败: {}", what);
+            ++failures();
+        }
+    }
+
+    // 轮询等待条件成立，超时返回 false
+    template <typename F>
+    bool wait_for(F condition, std::chrono::milliseconds timeout = std::chrono::milliseconds(3000))
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!condition())
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return true;
+    }
+
+    // 汇总结果，返回进程退出码
+    inline int finish()
+    {
+        if (failures() > 0)
+        {
+            spdlog::error("{} 项检查失败", failures());
+            return 1;
+        }
+        spdlog::info("全部通过");
+        return 0;
+    }
+} // namespace test_util